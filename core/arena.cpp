@@ -0,0 +1,169 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace core
+{
+
+struct Arena::Chunk
+{
+    Chunk*       next;
+    std::size_t  size;
+
+    // the usable bytes follow the header
+    char* GetData()
+    {
+        return reinterpret_cast<char*>(this + 1);
+    }
+};
+
+Arena::Arena(std::size_t chunk_size)
+    : m_chunk_size(std::max<std::size_t>(chunk_size, 4096))
+    , m_chunks(nullptr)
+    , m_free_chunks(nullptr)
+    , m_current(nullptr)
+    , m_end(nullptr)
+    , m_used_size(0)
+    , m_capacity(0)
+{
+}
+
+Arena::~Arena()
+{
+    Release();
+}
+
+void Arena::Reset()
+{
+    while (m_chunks != nullptr)
+    {
+        auto chunk = m_chunks;
+        m_chunks = chunk->next;
+
+        chunk->next = m_free_chunks;
+        m_free_chunks = chunk;
+    }
+
+    m_current = nullptr;
+    m_end = nullptr;
+    m_used_size = 0;
+}
+
+void Arena::Release()
+{
+    Reset();
+
+    while (m_free_chunks != nullptr)
+    {
+        auto chunk = m_free_chunks;
+        m_free_chunks = chunk->next;
+        ::operator delete(chunk);
+    }
+
+    m_capacity = 0;
+}
+
+std::size_t Arena::GetUsedSize() const
+{
+    return m_used_size;
+}
+
+std::size_t Arena::GetCapacity() const
+{
+    return m_capacity;
+}
+
+void* Arena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    const auto Align = [alignment](char* pointer)
+    {
+        const auto address = reinterpret_cast<std::uintptr_t>(pointer);
+        return reinterpret_cast<char*>(
+            (address + alignment - 1) & ~(std::uintptr_t(alignment) - 1));
+    };
+
+    auto result = Align(m_current);
+
+    // aligning can step past the end of an exactly sized chunk
+    if (m_current == nullptr || result > m_end ||
+        bytes > static_cast<std::size_t>(m_end - result))
+    {
+        // the rest of the current chunk is given up
+        auto chunk = AcquireChunk(bytes + alignment);
+        m_current = chunk->GetData();
+        m_end = m_current + chunk->size;
+        result = Align(m_current);
+    }
+
+    m_current = result + bytes;
+    m_used_size += bytes;
+    return result;
+}
+
+void Arena::do_deallocate(void* pointer, std::size_t bytes,
+                          std::size_t alignment)
+{
+    // memory only comes back with Reset
+    static_cast<void>(pointer);
+    static_cast<void>(bytes);
+    static_cast<void>(alignment);
+}
+
+bool Arena::do_is_equal(
+    const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+Arena::Chunk* Arena::AcquireChunk(std::size_t size)
+{
+    Chunk* chunk = nullptr;
+
+    for (auto link = &m_free_chunks; *link != nullptr; link = &(*link)->next)
+    {
+        if ((*link)->size >= size)
+        {
+            chunk = *link;
+            *link = chunk->next;
+            break;
+        }
+    }
+
+    if (chunk == nullptr)
+    {
+        // dedicated chunks for large allocations end on an aligned size too
+        const auto aligned_size = (size + alignof(std::max_align_t) - 1) &
+                                  ~(alignof(std::max_align_t) - 1);
+        const auto chunk_size = std::max(aligned_size, m_chunk_size);
+        chunk = static_cast<Chunk*>(::operator new(sizeof(Chunk) + chunk_size));
+        chunk->size = chunk_size;
+        m_capacity += chunk_size;
+    }
+
+    chunk->next = m_chunks;
+    m_chunks = chunk;
+    return chunk;
+}
+
+}
@@ -0,0 +1,94 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef HOOHAHA_CORE_ARENA_H_
+#define HOOHAHA_CORE_ARENA_H_
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace core
+{
+
+constexpr std::size_t kArenaDefaultChunkSize = 256 * 1024;
+
+// Monotonic bump allocator. Memory is carved out of large chunks and never
+// given back one allocation at a time, deallocate does nothing. Reset makes
+// all chunks available for the next round of allocations in O(chunks), so a
+// working set that is loaded and dropped over and over (a streamed level)
+// stops touching the system allocator once the chunks are warm.
+//
+// Works with the std::pmr containers:
+//
+//     core::Arena arena;
+//     std::pmr::vector<int> values(&arena);
+//
+// An arena is not thread safe.
+class Arena final : public std::pmr::memory_resource
+{
+public:
+    explicit Arena(std::size_t chunk_size = kArenaDefaultChunkSize);
+    Arena(const Arena&) = delete;
+    Arena(Arena&&) = delete;
+    ~Arena() override;
+
+    // Everything allocated so far is dropped without running destructors,
+    // the chunks are kept for reuse
+    void Reset();
+    // Like Reset, but the chunks are returned to the system
+    void Release();
+
+    // bytes handed out since the last Reset
+    std::size_t GetUsedSize() const;
+    // bytes held in chunks, in use or kept for reuse
+    std::size_t GetCapacity() const;
+
+    Arena& operator=(const Arena&) = delete;
+    Arena& operator=(Arena&&) = delete;
+
+private:
+    struct Chunk;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* pointer, std::size_t bytes,
+                       std::size_t alignment) override;
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override;
+
+    // a chunk of at least size bytes, reused when possible
+    Chunk* AcquireChunk(std::size_t size);
+
+private:
+    const std::size_t  m_chunk_size;
+
+    // chunks in use, the current one first
+    Chunk*             m_chunks;
+    // chunks given up by Reset
+    Chunk*             m_free_chunks;
+
+    char*              m_current;
+    char*              m_end;
+
+    std::size_t        m_used_size;
+    std::size_t        m_capacity;
+};
+
+}
+
+#endif // HOOHAHA_CORE_ARENA_H_
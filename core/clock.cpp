@@ -0,0 +1,232 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "clock.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace core
+{
+
+namespace
+{
+
+// how long the tick rate is measured on first use
+const auto kCalibrationTime = std::chrono::milliseconds(1);
+// how often RecalibrateClock measures again
+const auto kRecalibrationInterval = std::chrono::seconds(1);
+
+template <class Clock>
+std::int64_t ReadNanoseconds()
+{
+    using namespace std::chrono;
+
+    return duration_cast<nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// Reads the clock between two tick reads, a preempted read is retried so
+// the pair was taken as close together as possible
+template <class Clock>
+void ReadClockPair(std::uint64_t& ticks, std::int64_t& nanoseconds)
+{
+    std::uint64_t best_spread = UINT64_MAX;
+
+    for (int attempt = 0; attempt < 8; attempt++)
+    {
+        const auto before = ReadClockTicksOrdered();
+        const auto time = ReadNanoseconds<Clock>();
+        const auto after = ReadClockTicksOrdered();
+
+        if (after - before < best_spread)
+        {
+            best_spread = after - before;
+            ticks = before + (after - before) / 2;
+            nanoseconds = time;
+        }
+    }
+}
+
+// The current calibration behind a sequence lock: a reader retries when
+// the sequence was odd or changed while it read. Only one thread at a time
+// writes it, under the mutex.
+class ClockState
+{
+public:
+    ClockState();
+
+    ClockCalibration Load() const;
+    bool Recalibrate();
+
+private:
+    void Store(const ClockCalibration& calibration);
+
+private:
+    std::atomic<std::uint32_t>  m_sequence;
+    std::atomic<std::uint64_t>  m_tick_base;
+    std::atomic<std::int64_t>   m_time_base;
+    std::atomic<double>         m_nanoseconds_per_tick;
+
+    std::mutex                  m_mutex;
+    // steady clock pair the tick rate is measured from
+    std::uint64_t               m_first_ticks;
+    std::int64_t                m_first_time;
+    std::chrono::steady_clock::time_point m_next_recalibration;
+};
+
+ClockState::ClockState()
+    : m_sequence(0)
+    , m_next_recalibration(std::chrono::steady_clock::now() +
+                           kRecalibrationInterval)
+{
+    ReadClockPair<std::chrono::steady_clock>(m_first_ticks, m_first_time);
+
+    ClockCalibration calibration;
+    calibration.nanoseconds_per_tick = 1.0;
+
+#if HOOHAHA_CLOCK_TSC
+    std::this_thread::sleep_for(kCalibrationTime);
+
+    std::uint64_t ticks;
+    std::int64_t time;
+    ReadClockPair<std::chrono::steady_clock>(ticks, time);
+
+    if (ticks > m_first_ticks && time > m_first_time)
+    {
+        calibration.nanoseconds_per_tick =
+            static_cast<double>(time - m_first_time) /
+            static_cast<double>(ticks - m_first_ticks);
+    }
+#endif
+
+    ReadClockPair<std::chrono::system_clock>(calibration.tick_base,
+                                             calibration.time_base);
+    Store(calibration);
+}
+
+ClockCalibration ClockState::Load() const
+{
+    ClockCalibration calibration;
+
+    for (;;)
+    {
+        const auto sequence = m_sequence.load(std::memory_order_acquire);
+
+        calibration.tick_base = m_tick_base.load(std::memory_order_relaxed);
+        calibration.time_base = m_time_base.load(std::memory_order_relaxed);
+        calibration.nanoseconds_per_tick =
+            m_nanoseconds_per_tick.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((sequence & 1) == 0 &&
+            sequence == m_sequence.load(std::memory_order_relaxed))
+        {
+            return calibration;
+        }
+    }
+}
+
+bool ClockState::Recalibrate()
+{
+    std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+
+    const auto now = std::chrono::steady_clock::now();
+    if (!lock.owns_lock() || now < m_next_recalibration)
+    {
+        return false;
+    }
+
+    m_next_recalibration = now + kRecalibrationInterval;
+
+    ClockCalibration calibration = Load();
+
+#if HOOHAHA_CLOCK_TSC
+    // the longer the window the smaller the error of the clock reads
+    std::uint64_t ticks;
+    std::int64_t time;
+    ReadClockPair<std::chrono::steady_clock>(ticks, time);
+
+    if (ticks > m_first_ticks && time > m_first_time)
+    {
+        calibration.nanoseconds_per_tick =
+            static_cast<double>(time - m_first_time) /
+            static_cast<double>(ticks - m_first_ticks);
+    }
+#endif
+
+    ReadClockPair<std::chrono::system_clock>(calibration.tick_base,
+                                             calibration.time_base);
+    Store(calibration);
+    return true;
+}
+
+void ClockState::Store(const ClockCalibration& calibration)
+{
+    const auto sequence = m_sequence.load(std::memory_order_relaxed);
+
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    m_tick_base.store(calibration.tick_base, std::memory_order_relaxed);
+    m_time_base.store(calibration.time_base, std::memory_order_relaxed);
+    m_nanoseconds_per_tick.store(calibration.nanoseconds_per_tick,
+                                 std::memory_order_relaxed);
+
+    m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+ClockState& GetClockState()
+{
+    static ClockState state;
+    return state;
+}
+
+} // namespace
+
+ClockCalibration GetClockCalibration()
+{
+    return GetClockState().Load();
+}
+
+bool RecalibrateClock()
+{
+    return GetClockState().Recalibrate();
+}
+
+std::int64_t ClockTicksToEpochNanoseconds(std::uint64_t ticks)
+{
+    const auto calibration = GetClockCalibration();
+
+    // ticks taken before the calibration are negative offsets
+    const auto offset =
+        static_cast<std::int64_t>(ticks - calibration.tick_base);
+    return calibration.time_base +
+           static_cast<std::int64_t>(static_cast<double>(offset) *
+                                     calibration.nanoseconds_per_tick);
+}
+
+std::chrono::system_clock::time_point ClockTicksToTime(std::uint64_t ticks)
+{
+    using namespace std::chrono;
+
+    return system_clock::time_point(duration_cast<system_clock::duration>(
+        nanoseconds(ClockTicksToEpochNanoseconds(ticks))));
+}
+
+}
@@ -0,0 +1,104 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOOHAHA_CORE_CLOCK_H_
+#define HOOHAHA_CORE_CLOCK_H_
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || \
+    defined(__i386__)
+#define HOOHAHA_CLOCK_TSC 1
+#else
+#define HOOHAHA_CLOCK_TSC 0
+#endif
+
+#if HOOHAHA_CLOCK_TSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace core
+{
+
+// Timestamps taken on hot paths are raw clock ticks, converted to time only
+// when they are formatted. On x86 a tick is a cycle of the CPU timestamp
+// counter, which runs at a constant rate and is synchronized between cores
+// on every CPU we support. Elsewhere ticks are steady clock nanoseconds.
+//
+// The tick rate and the wall time of a reference tick are measured over a
+// short window on first use. RecalibrateClock measures the rate again over
+// everything since then and moves the reference tick to the present, which
+// also follows adjustments of the system clock.
+struct ClockCalibration
+{
+    std::uint64_t  tick_base;
+    // nanoseconds since the epoch at tick_base
+    std::int64_t   time_base;
+    double         nanoseconds_per_tick;
+};
+
+// Plain rdtsc, a few cycles and no ordering against the surrounding code
+inline std::uint64_t ReadClockTicks()
+{
+#if HOOHAHA_CLOCK_TSC
+    return __rdtsc();
+#else
+    using namespace std::chrono;
+
+    return static_cast<std::uint64_t>(duration_cast<nanoseconds>(
+        steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// rdtscp, waits for the preceding instructions, e.g. at the end of a
+// measured interval
+inline std::uint64_t ReadClockTicksOrdered()
+{
+#if HOOHAHA_CLOCK_TSC
+    unsigned int processor;
+    return __rdtscp(&processor);
+#else
+    return ReadClockTicks();
+#endif
+}
+
+ClockCalibration GetClockCalibration();
+
+// Refines the calibration, at most once per second, returns whether it did.
+// The log writer calls it regularly.
+bool RecalibrateClock();
+
+// Length of an interval of ticks
+inline std::int64_t ClockTicksToNanoseconds(std::int64_t ticks)
+{
+    return static_cast<std::int64_t>(
+        static_cast<double>(ticks) * GetClockCalibration().nanoseconds_per_tick);
+}
+
+// Wall time of a tick, as nanoseconds since the epoch
+std::int64_t ClockTicksToEpochNanoseconds(std::uint64_t ticks);
+std::chrono::system_clock::time_point ClockTicksToTime(std::uint64_t ticks);
+
+}
+
+#endif // HOOHAHA_CORE_CLOCK_H_
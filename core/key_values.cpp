@@ -18,14 +18,37 @@
 
 #include "key_values.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "arena.h"
 #include "log.h"
+#include "metrics.h"
 
 namespace core
 {
 
+HOOHAHA_LOG_CATEGORY(kv);
+
 namespace
 {
 
+MetricCounter g_load_count("keyvalues_loads_total",
+                           "KeyValues documents parsed");
+MetricCounter g_load_error_count("keyvalues_load_errors_total",
+                                 "KeyValues documents that failed to parse");
+MetricCounter g_load_bytes("keyvalues_load_bytes_total",
+                           "Bytes of KeyValues source parsed");
+MetricHistogram g_load_duration("keyvalues_load_duration_microseconds",
+                                "Time to parse a KeyValues document",
+                                { 10, 100, 1000, 10000, 100000, 1000000 });
+
 inline void SkipSpaces(std::string_view::const_iterator& begin,
                        std::string_view::const_iterator end)
 {
@@ -35,6 +58,10 @@ inline void SkipSpaces(std::string_view::const_iterator& begin,
     }
 }
 
+// strtol and strtof need a terminated string, numbers are short enough for
+// a buffer on the stack
+const std::size_t kMaxNumberLength = 64;
+
 inline void SkipLine(std::string_view::const_iterator& begin,
                      std::string_view::const_iterator end)
 {
@@ -46,34 +73,121 @@ inline void SkipLine(std::string_view::const_iterator& begin,
 
 } // namespace
 
-bool KeyValues::Hash::operator()(const KeyValues& key_values) const
+struct KeyValues::Storage
+{
+    explicit Storage(Arena* document_arena = nullptr)
+        : arena(document_arena)
+        , string_arrays(document_arena != nullptr
+                            ? document_arena
+                            : std::pmr::get_default_resource())
+    {
+    }
+
+    // the arena of the document, null when it lives on the heap
+    Arena*                        arena = nullptr;
+    // owns the source unless it was copied into the arena
+    std::string                   buffer;
+    std::string_view              source;
+    // tokens that had to be copied, a deque never moves them
+    std::deque<std::string>       strings;
+    // guards the owning copies of the string arrays
+    std::mutex                    mutex;
+    // owning copies made by GetStringArrayPtr, in the arena of the document
+    std::pmr::deque<StringArray>  string_arrays;
+};
+
+std::size_t KeyValues::Hash::operator()(const KeyValues& key_values) const
+{
+    return key_values.m_hash;
+}
+
+std::size_t KeyValues::Hash::operator()(std::string_view key) const
 {
-    return std::hash<std::string>{}(key_values.GetKey());
+    return HashKey(key);
+}
+
+std::size_t KeyValues::Hash::operator()(const KeyProbe& probe) const
+{
+    return probe.hash;
+}
+
+bool KeyValues::KeyEqual::operator()(const KeyValues& lhs,
+                                     const KeyValues& rhs) const
+{
+    return lhs.m_key == rhs.m_key;
+}
+
+bool KeyValues::KeyEqual::operator()(const KeyValues& lhs,
+                                     std::string_view rhs) const
+{
+    return lhs.m_key == rhs;
+}
+
+bool KeyValues::KeyEqual::operator()(std::string_view lhs,
+                                     const KeyValues& rhs) const
+{
+    return lhs == rhs.m_key;
+}
+
+bool KeyValues::KeyEqual::operator()(const KeyValues& lhs,
+                                     const KeyProbe& rhs) const
+{
+    return lhs.m_hash == rhs.hash && lhs.m_key == rhs.key;
+}
+
+bool KeyValues::KeyEqual::operator()(const KeyProbe& lhs,
+                                     const KeyValues& rhs) const
+{
+    return lhs.hash == rhs.m_hash && lhs.key == rhs.m_key;
 }
 
 KeyValues::KeyValues()
     : m_key("(null)")
+    , m_hash(HashKey(m_key))
     , m_type(Type::kEmpty)
 {
 }
 
 KeyValues::KeyValues(std::string_view key)
-    : m_key(key)
-    , m_type(Type::kEmpty)
+    : m_type(Type::kEmpty)
 {
-    if (m_key.empty())
+    if (key.empty())
     {
-        HOOHAHA_LOG_WARN("KeyValues : key name must not be empty");
+        HOOHAHA_LOG_CAT(kv, kWarning, "KeyValues : key name must not be empty");
         m_key = "(null)";
+        m_hash = HashKey(m_key);
+        return;
     }
+
+    m_storage = std::make_unique<Storage>();
+    m_storage->buffer = key;
+    m_key = m_storage->buffer;
+    m_hash = HashKey(m_key);
+}
+
+KeyValues::KeyValues(std::string_view key, KeyView,
+                     std::pmr::memory_resource* resource)
+    : m_key(key)
+    , m_hash(HashKey(key))
+    , m_type(Type::kEmpty)
+    , m_set(resource)
+{
+}
+
+KeyValues::~KeyValues()
+{
+    ReleaseSet();
 }
 
 void KeyValues::Clear()
 {
-    m_key.clear();
+    // the nodes point into the storage, so they go first
+    ReleaseSet();
     m_value = {};
     m_type = Type::kEmpty;
-    m_set.clear();
+    m_key = {};
+    m_hash = HashKey(m_key);
+    m_storage.reset();
 }
 
 bool KeyValues::LoadFromString(std::string_view str)
@@ -83,41 +197,129 @@ bool KeyValues::LoadFromString(std::string_view str)
         return false;
     }
 
+    auto storage = std::make_unique<Storage>();
+    storage->buffer = str;
+    storage->source = storage->buffer;
+    return LoadDocument(std::move(storage));
+}
+
+bool KeyValues::LoadFromString(std::string_view str, Arena& arena)
+{
+    if (str.empty())
+    {
+        return false;
+    }
+
+    auto source = static_cast<char*>(arena.allocate(str.size(), 1));
+    std::memcpy(source, str.data(), str.size());
+
+    auto storage = std::make_unique<Storage>(&arena);
+    storage->source = std::string_view(source, str.size());
+    return LoadDocument(std::move(storage));
+}
+
+bool KeyValues::LoadFromBuffer(std::string&& buffer)
+{
+    if (buffer.empty())
+    {
+        return false;
+    }
+
+    auto storage = std::make_unique<Storage>();
+    storage->buffer = std::move(buffer);
+    storage->source = storage->buffer;
+    return LoadDocument(std::move(storage));
+}
+
+bool KeyValues::LoadDocument(std::unique_ptr<Storage> storage)
+{
     Clear();
+    m_storage = std::move(storage);
+
+    // the root set was created before it was known where the document goes
+    std::pmr::memory_resource* resource = m_storage->arena;
+    if (resource == nullptr)
+    {
+        resource = std::pmr::get_default_resource();
+    }
+
+    if (m_set.get_allocator().resource() != resource)
+    {
+        std::destroy_at(&m_set);
+        std::construct_at(&m_set, resource);
+    }
+
+    const std::string_view str = m_storage->source;
+
+    const auto start_time = std::chrono::steady_clock::now();
+    g_load_count.Increment();
+    g_load_bytes.Increment(str.size());
 
     auto begin = str.begin();
     auto end = str.end();
 
-    auto key = ReadToken(begin, end);
+    auto key = ReadToken(begin, end, *m_storage);
     if (key.empty())
     {
-        HOOHAHA_LOG_ERROR(
-            "Unable to load KeyValues, unvalid parameter passed",
-            key.c_str());
+        HOOHAHA_LOG_CAT(kv, kError, "Unable to load KeyValues, unvalid parameter passed");
+        g_load_error_count.Increment();
+        m_storage.reset();
         return false;
     }
 
     auto current = begin;
     if (!SeekControlCharacter(current, end, '{'))
     {
-        HOOHAHA_LOG_ERROR(
-            "Unable to load KeyValues %s, invalid or corrupted source data",
-            key.c_str());
+        HOOHAHA_LOG_CAT(kv, kError,
+            "Unable to load KeyValues {}, invalid or corrupted source data",
+            key);
+        g_load_error_count.Increment();
+        m_storage.reset();
         return false;
     }
 
-    if (!Load(begin, end))
+    if (!Load(begin, end, *m_storage))
     {
-        HOOHAHA_LOG_ERROR("Unable to load KeyValues %s", key.c_str());
+        HOOHAHA_LOG_CAT(kv, kError, "Unable to load KeyValues {}", key);
+        g_load_error_count.Increment();
+        ReleaseSet();
+        m_storage.reset();
         return false;
     }
 
     m_key = key;
+    m_hash = HashKey(m_key);
+
+    g_load_duration.Observe(static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_time).count()));
+
+    HOOHAHA_LOG_CAT(kv, kDebug, "KeyValues {} loaded, {} bytes", m_key,
+                    str.size());
 
     return true;
 }
 
+void KeyValues::ReleaseSet()
+{
+    if (m_storage != nullptr && m_storage->arena != nullptr)
+    {
+        // Nodes in an arena own nothing outside of it, so the tree is
+        // abandoned instead of destroyed node by node. The arena takes the
+        // memory back on Reset.
+        std::construct_at(&m_set);
+        return;
+    }
+
+    m_set.clear();
+}
+
 std::string KeyValues::GetKey() const
+{
+    return std::string(m_key);
+}
+
+std::string_view KeyValues::GetKeyView() const
 {
     return m_key;
 }
@@ -137,10 +339,10 @@ int KeyValues::GetInt(std::string_view key, int default_value) const
         }
         catch (const std::bad_variant_access&)
         {
-            HOOHAHA_LOG_ERROR(
-                "KeyValues '%s' : inconsistent or corrupted int value for key '%s'",
-                m_key.c_str(),
-                key.data());
+            HOOHAHA_LOG_CAT(kv, kError,
+                "KeyValues '{}' : inconsistent or corrupted int value for key '{}'",
+                m_key,
+                key);
             return default_value;
         }
     }
@@ -172,10 +374,10 @@ float KeyValues::GetFloat(std::string_view key, float default_value) const
         }
         catch (const std::bad_variant_access&)
         {
-            HOOHAHA_LOG_ERROR(
-                "KeyValues '%s' : inconsistent or corrupted float value for key '%s'",
-                m_key.c_str(),
-                key.data());
+            HOOHAHA_LOG_CAT(kv, kError,
+                "KeyValues '{}' : inconsistent or corrupted float value for key '{}'",
+                m_key,
+                key);
             return default_value;
         }
     }
@@ -193,25 +395,31 @@ float KeyValues::GetFloat(std::string_view key, float default_value) const
 }
 
 std::string KeyValues::GetString(std::string_view key, std::string_view default_value) const
+{
+    return std::string(GetStringView(key, default_value));
+}
+
+std::string_view KeyValues::GetStringView(std::string_view key,
+                                          std::string_view default_value) const
 {
     if (key.empty())
     {
-        return std::string(default_value);
+        return default_value;
     }
 
     if (m_type == Type::kString && key == "/")
     {
         try
         {
-            return std::get<std::string>(m_value);
+            return std::get<std::string_view>(m_value);
         }
         catch (const std::bad_variant_access&)
         {
-            HOOHAHA_LOG_ERROR(
-                "KeyValues '%s' : inconsistent or corrupted string value for key '%s'",
-                m_key.c_str(),
-                key.data());
-            return std::string(default_value);
+            HOOHAHA_LOG_CAT(kv, kError,
+                "KeyValues '{}' : inconsistent or corrupted string value for key '{}'",
+                m_key,
+                key);
+            return default_value;
         }
     }
 
@@ -220,11 +428,11 @@ std::string KeyValues::GetString(std::string_view key, std::string_view default_
         auto key_value_iterator = FindKeyValues(key);
         if (key_value_iterator != nullptr)
         {
-            return key_value_iterator->GetString("/", default_value);
+            return key_value_iterator->GetStringView("/", default_value);
         }
     }
 
-    return std::string(default_value);
+    return default_value;
 }
 
 KeyValues::StringArray KeyValues::GetStringArray(std::string_view key) const
@@ -238,14 +446,15 @@ KeyValues::StringArray KeyValues::GetStringArray(std::string_view key) const
     {
         try
         {
-            return std::get<StringArray>(m_value);
+            const auto& views = std::get<StringValues>(m_value).views;
+            return StringArray(views.begin(), views.end());
         }
         catch (const std::bad_variant_access&)
         {
-            HOOHAHA_LOG_ERROR(
-                "KeyValues '%s' : inconsistent or corrupted StringArray value for key '%s'",
-                m_key.c_str(),
-                key.data());
+            HOOHAHA_LOG_CAT(kv, kError,
+                "KeyValues '{}' : inconsistent or corrupted StringArray value for key '{}'",
+                m_key,
+                key);
             return {};
         }
     }
@@ -273,14 +482,15 @@ KeyValues::IntArray KeyValues::GetIntArray(std::string_view key) const
     {
         try
         {
-            return std::get<IntArray>(m_value);
+            const auto& values = std::get<IntValues>(m_value);
+            return IntArray(values.begin(), values.end());
         }
         catch (const std::bad_variant_access&)
         {
-            HOOHAHA_LOG_ERROR(
-                "KeyValues '%s' : inconsistent or corrupted IntArray value for key '%s'",
-                m_key.c_str(),
-                key.data());
+            HOOHAHA_LOG_CAT(kv, kError,
+                "KeyValues '{}' : inconsistent or corrupted IntArray value for key '{}'",
+                m_key,
+                key);
             return {};
         }
     }
@@ -308,14 +518,15 @@ KeyValues::FloatArray KeyValues::GetFloatArray(std::string_view key) const
     {
         try
         {
-            return std::get<FloatArray>(m_value);
+            const auto& values = std::get<FloatValues>(m_value);
+            return FloatArray(values.begin(), values.end());
         }
         catch (const std::bad_variant_access&)
         {
-            HOOHAHA_LOG_ERROR(
-                "KeyValues '%s' : inconsistent or corrupted FloatArray value for key '%s'",
-                m_key.c_str(),
-                key.data());
+            HOOHAHA_LOG_CAT(kv, kError,
+                "KeyValues '{}' : inconsistent or corrupted FloatArray value for key '{}'",
+                m_key,
+                key);
             return {};
         }
     }
@@ -344,14 +555,14 @@ int KeyValues::GetStringArraySize(std::string_view key) const
         try
         {
             return static_cast<int>(
-                std::get<StringArray>(m_value).size());
+                std::get<StringValues>(m_value).views.size());
         }
         catch (const std::bad_variant_access&)
         {
-            HOOHAHA_LOG_ERROR(
-                "KeyValues '%s' : inconsistent or corrupted StringArray value for key '%s'",
-                m_key.c_str(),
-                key.data());
+            HOOHAHA_LOG_CAT(kv, kError,
+                "KeyValues '{}' : inconsistent or corrupted StringArray value for key '{}'",
+                m_key,
+                key);
             return 0;
         }
     }
@@ -380,14 +591,14 @@ int KeyValues::GetIntArraySize(std::string_view key) const
         try
         {
             return static_cast<int>(
-                std::get<IntArray>(m_value).size());
+                std::get<IntValues>(m_value).size());
         }
         catch (const std::bad_variant_access&)
         {
-            HOOHAHA_LOG_ERROR(
-                "KeyValues '%s' : inconsistent or corrupted IntArray value for key '%s'",
-                m_key.c_str(),
-                key.data());
+            HOOHAHA_LOG_CAT(kv, kError,
+                "KeyValues '{}' : inconsistent or corrupted IntArray value for key '{}'",
+                m_key,
+                key);
             return 0;
         }
     }
@@ -416,14 +627,14 @@ int KeyValues::GetFloatArraySize(std::string_view key) const
         try
         {
             return static_cast<int>(
-                std::get<FloatArray>(m_value).size());
+                std::get<FloatValues>(m_value).size());
         }
         catch (const std::bad_variant_access&)
         {
-            HOOHAHA_LOG_ERROR(
-                "KeyValues '%s' : inconsistent or corrupted FloatArray value for key '%s'",
-                m_key.c_str(),
-                key.data());
+            HOOHAHA_LOG_CAT(kv, kError,
+                "KeyValues '{}' : inconsistent or corrupted FloatArray value for key '{}'",
+                m_key,
+                key);
             return 0;
         }
     }
@@ -451,14 +662,32 @@ const std::string* KeyValues::GetStringArrayPtr(std::string_view key) const
     {
         try
         {
-            return std::get<StringArray>(m_value).data();
+            auto& values = std::get<StringValues>(m_value);
+
+            // parsing left only the views, the owning copy is made here once
+            std::atomic_ref<const StringArray*> strings(values.strings);
+            if (auto copy = strings.load(std::memory_order_acquire))
+            {
+                return copy->data();
+            }
+
+            std::lock_guard lock(values.storage->mutex);
+            if (auto copy = strings.load(std::memory_order_relaxed))
+            {
+                return copy->data();
+            }
+
+            const auto& copy = values.storage->string_arrays.emplace_back(
+                values.views.begin(), values.views.end());
+            strings.store(&copy, std::memory_order_release);
+            return copy.data();
         }
         catch (const std::bad_variant_access&)
         {
-            HOOHAHA_LOG_ERROR(
-                "KeyValues '%s' : inconsistent or corrupted StringArray value for key '%s'",
-                m_key.c_str(),
-                key.data());
+            HOOHAHA_LOG_CAT(kv, kError,
+                "KeyValues '{}' : inconsistent or corrupted StringArray value for key '{}'",
+                m_key,
+                key);
             return nullptr;
         }
     }
@@ -475,6 +704,42 @@ const std::string* KeyValues::GetStringArrayPtr(std::string_view key) const
     return nullptr;
 }
 
+std::span<const std::string_view> KeyValues::GetStringArrayView(
+    std::string_view key) const
+{
+    if (key.empty())
+    {
+        return {};
+    }
+
+    if (m_type == Type::kStringArray && key == "/")
+    {
+        try
+        {
+            return std::get<StringValues>(m_value).views;
+        }
+        catch (const std::bad_variant_access&)
+        {
+            HOOHAHA_LOG_CAT(kv, kError,
+                "KeyValues '{}' : inconsistent or corrupted StringArray value for key '{}'",
+                m_key,
+                key);
+            return {};
+        }
+    }
+
+    if (m_type == Type::kSet)
+    {
+        auto key_value_iterator = FindKeyValues(key);
+        if (key_value_iterator != nullptr)
+        {
+            return key_value_iterator->GetStringArrayView("/");
+        }
+    }
+
+    return {};
+}
+
 const int* KeyValues::GetIntArrayPtr(std::string_view key) const
 {
     if (key.empty())
@@ -486,14 +751,14 @@ const int* KeyValues::GetIntArrayPtr(std::string_view key) const
     {
         try
         {
-            return std::get<IntArray>(m_value).data();
+            return std::get<IntValues>(m_value).data();
         }
         catch (const std::bad_variant_access&)
         {
-            HOOHAHA_LOG_ERROR(
-                "KeyValues '%s' : inconsistent or corrupted IntArray value for key '%s'",
-                m_key.c_str(),
-                key.data());
+            HOOHAHA_LOG_CAT(kv, kError,
+                "KeyValues '{}' : inconsistent or corrupted IntArray value for key '{}'",
+                m_key,
+                key);
             return nullptr;
         }
     }
@@ -521,14 +786,14 @@ const float* KeyValues::GetFloatArrayPtr(std::string_view key) const
     {
         try
         {
-            return std::get<FloatArray>(m_value).data();
+            return std::get<FloatValues>(m_value).data();
         }
         catch (const std::bad_variant_access&)
         {
-            HOOHAHA_LOG_ERROR(
-                "KeyValues '%s' : inconsistent or corrupted FloatArray value for key '%s'",
-                m_key.c_str(),
-                key.data());
+            HOOHAHA_LOG_CAT(kv, kError,
+                "KeyValues '{}' : inconsistent or corrupted FloatArray value for key '{}'",
+                m_key,
+                key);
             return nullptr;
         }
     }
@@ -548,44 +813,217 @@ const float* KeyValues::GetFloatArrayPtr(std::string_view key) const
 const KeyValues* KeyValues::FindKeyValues(
     std::string_view key) const
 {
-    std::size_t offset = 1;
-    std::string first_key, rest_key;
-
     if (key.size() < 2 || key[0] != '/')
     {
         return nullptr;
     }
 
-    std::size_t new_offset = key.find_first_of('/', offset);
-    if (new_offset != std::string_view::npos)
+    // one segment per level, a trailing '/' names the node itself
+    const KeyValues* key_values = this;
+    std::size_t offset = 1;
+
+    while (offset < key.size())
     {
-        first_key = key.substr(offset, new_offset - offset);
-        rest_key = key.substr(new_offset);
+        auto new_offset = key.find('/', offset);
+        if (new_offset == std::string_view::npos)
+        {
+            new_offset = key.size();
+        }
+
+        const auto segment = key.substr(offset, new_offset - offset);
+        if (segment.empty())
+        {
+            return nullptr;
+        }
+
+        const auto& set = key_values->m_set;
+        const auto key_values_iterator =
+            set.find(KeyProbe{ segment, HashKey(segment) });
+        if (key_values_iterator == set.end())
+        {
+            return nullptr;
+        }
+
+        key_values = &(*key_values_iterator);
+        offset = new_offset + 1;
     }
-    else
+
+    return key_values;
+}
+
+int KeyValues::GetInt(const Path& path, int default_value) const
+{
+    auto key_values = FindKeyValues(path);
+    if (key_values == nullptr)
+    {
+        return default_value;
+    }
+
+    return key_values->GetInt("/", default_value);
+}
+
+float KeyValues::GetFloat(const Path& path, float default_value) const
+{
+    auto key_values = FindKeyValues(path);
+    if (key_values == nullptr)
+    {
+        return default_value;
+    }
+
+    return key_values->GetFloat("/", default_value);
+}
+
+std::string KeyValues::GetString(const Path& path,
+                                 std::string_view default_value) const
+{
+    return std::string(GetStringView(path, default_value));
+}
+
+std::string_view KeyValues::GetStringView(const Path& path,
+                                          std::string_view default_value) const
+{
+    auto key_values = FindKeyValues(path);
+    if (key_values == nullptr)
+    {
+        return default_value;
+    }
+
+    return key_values->GetStringView("/", default_value);
+}
+
+KeyValues::StringArray KeyValues::GetStringArray(const Path& path) const
+{
+    auto key_values = FindKeyValues(path);
+    if (key_values == nullptr)
+    {
+        return {};
+    }
+
+    return key_values->GetStringArray("/");
+}
+
+KeyValues::IntArray KeyValues::GetIntArray(const Path& path) const
+{
+    auto key_values = FindKeyValues(path);
+    if (key_values == nullptr)
+    {
+        return {};
+    }
+
+    return key_values->GetIntArray("/");
+}
+
+KeyValues::FloatArray KeyValues::GetFloatArray(const Path& path) const
+{
+    auto key_values = FindKeyValues(path);
+    if (key_values == nullptr)
+    {
+        return {};
+    }
+
+    return key_values->GetFloatArray("/");
+}
+
+int KeyValues::GetStringArraySize(const Path& path) const
+{
+    auto key_values = FindKeyValues(path);
+    if (key_values == nullptr)
+    {
+        return 0;
+    }
+
+    return key_values->GetStringArraySize("/");
+}
+
+int KeyValues::GetIntArraySize(const Path& path) const
+{
+    auto key_values = FindKeyValues(path);
+    if (key_values == nullptr)
+    {
+        return 0;
+    }
+
+    return key_values->GetIntArraySize("/");
+}
+
+int KeyValues::GetFloatArraySize(const Path& path) const
+{
+    auto key_values = FindKeyValues(path);
+    if (key_values == nullptr)
     {
-        first_key = key.substr(offset);
+        return 0;
     }
 
-    auto key_values_iterator = m_set.find(KeyValues(first_key));
-    if (key_values_iterator == m_set.end())
+    return key_values->GetFloatArraySize("/");
+}
+
+const std::string* KeyValues::GetStringArrayPtr(const Path& path) const
+{
+    auto key_values = FindKeyValues(path);
+    if (key_values == nullptr)
     {
         return nullptr;
     }
 
-    if (rest_key.empty() || rest_key == "/")
+    return key_values->GetStringArrayPtr("/");
+}
+
+std::span<const std::string_view> KeyValues::GetStringArrayView(
+    const Path& path) const
+{
+    auto key_values = FindKeyValues(path);
+    if (key_values == nullptr)
     {
-        return &(*key_values_iterator);
+        return {};
     }
-    
-    auto new_key_values_iterator =
-        key_values_iterator->FindKeyValues(rest_key);
-    if (new_key_values_iterator == nullptr)
+
+    return key_values->GetStringArrayView("/");
+}
+
+const int* KeyValues::GetIntArrayPtr(const Path& path) const
+{
+    auto key_values = FindKeyValues(path);
+    if (key_values == nullptr)
     {
         return nullptr;
     }
 
-    return new_key_values_iterator;
+    return key_values->GetIntArrayPtr("/");
+}
+
+const float* KeyValues::GetFloatArrayPtr(const Path& path) const
+{
+    auto key_values = FindKeyValues(path);
+    if (key_values == nullptr)
+    {
+        return nullptr;
+    }
+
+    return key_values->GetFloatArrayPtr("/");
+}
+
+const KeyValues* KeyValues::FindKeyValues(const Path& path) const
+{
+    if (!path.IsValid())
+    {
+        return nullptr;
+    }
+
+    const KeyValues* key_values = this;
+
+    for (std::size_t i = 0; i < path.m_segment_count; i++)
+    {
+        const auto& set = key_values->m_set;
+        const auto key_values_iterator = set.find(path.m_segments[i]);
+        if (key_values_iterator == set.end())
+        {
+            return nullptr;
+        }
+
+        key_values = &(*key_values_iterator);
+    }
+
+    return key_values;
 }
 
 KeyValues::ConstIterator KeyValues::Begin() const
@@ -628,21 +1066,88 @@ bool KeyValues::operator != (const KeyValues& rhs) const
     return m_key != rhs.m_key;
 }
 
-std::string KeyValues::ReadToken(std::string_view::const_iterator& begin,
+std::string_view KeyValues::ReadToken(
+    std::string_view::const_iterator& begin,
+    std::string_view::const_iterator end, Storage& storage) const
+{
+    SkipSpaces(begin, end);
+
+    // A token is normally a plain range of the source and returned as a
+    // view. Escaped quotes, quotes in the middle of a token or comments
+    // inside it make CopyToken build it instead.
+    auto current = begin;
+    const bool is_quotted = current != end && *current == '\"';
+    if (is_quotted)
+    {
+        current++;
+    }
+
+    const auto token_begin = current;
+
+    while (current != end)
+    {
+        const char c = *current;
+
+        if (is_quotted)
+        {
+            if (c == '\"')
+            {
+                if (*(current - 1) == '\\')
+                {
+                    break;
+                }
+
+                begin = current + 1;
+                return std::string_view(&*token_begin, current - token_begin);
+            }
+        }
+        else
+        {
+            if (std::strchr(" \r\n{=},", c))
+            {
+                begin = current;
+                return std::string_view(&*token_begin, current - token_begin);
+            }
+
+            if (c == '\"' ||
+                (c == '/' && current + 1 != end && *(current + 1) == '/'))
+            {
+                break;
+            }
+        }
+
+        current++;
+    }
+
+    auto token = CopyToken(begin, end);
+    if (token.empty())
+    {
+        return {};
+    }
+
+    if (storage.arena != nullptr)
+    {
+        auto copy = static_cast<char*>(storage.arena->allocate(token.size(), 1));
+        std::memcpy(copy, token.data(), token.size());
+        return std::string_view(copy, token.size());
+    }
+
+    return storage.strings.emplace_back(std::move(token));
+}
+
+std::string KeyValues::CopyToken(std::string_view::const_iterator& begin,
                                  std::string_view::const_iterator end) const
 {
     std::string buffer;
     bool is_quotted = false;
 
-    SkipSpaces(begin, end);
-
     for (;;)
     {
         if (begin == end)
         {
-            HOOHAHA_LOG_ERROR(
-                "Unexpected buffer end while parsing KeyValues '%s'",
-                m_key.c_str());
+            HOOHAHA_LOG_CAT(kv, kError,
+                "Unexpected buffer end while parsing KeyValues '{}'",
+                m_key);
             return "";
         }
 
@@ -728,79 +1233,113 @@ bool KeyValues::SeekControlCharacter(std::string_view::const_iterator& begin,
 }
 
 bool KeyValues::Load(std::string_view::const_iterator& begin,
-                     std::string_view::const_iterator end) const
+                     std::string_view::const_iterator end,
+                     Storage& storage) const
 {
     if (begin == end)
     {
         return false;
     }
 
+    // children and arrays go where this node is
+    const auto resource = m_set.get_allocator().resource();
+
     if (SeekControlCharacter(begin, end, '{'))
     {
-        Set set;
         while (begin < end)
         {
-            auto key = ReadToken(begin, end);
+            auto key = ReadToken(begin, end, storage);
             if (key.empty())
             {
                 break;
             }
 
-            if (set.find(KeyValues(key)) != set.end())
+            // a failed document is released by its root
+            auto [nested, inserted] = m_set.emplace(key, KeyView{}, resource);
+            if (!inserted)
             {
-                HOOHAHA_LOG_ERROR(
-                    "An error occurred while parsing KeyValue '%s',"
+                HOOHAHA_LOG_CAT(kv, kError,
+                    "An error occurred while parsing KeyValue '{}',"
                     " key name must be unique",
-                    m_key.c_str());
+                    m_key);
                 return false;
             }
 
-            auto nested = set.emplace(key).first;
-            if (!nested->Load(begin, end))
+            if (!nested->Load(begin, end, storage))
             {
-                set.clear();
                 return false;
             }
         }
 
+        // the closing brace ends the block, otherwise the keys that follow
+        // a nested block would end its parent too
+        SeekControlCharacter(begin, end, '}');
+
         m_type = Type::kSet;
-        m_set = std::move(set);
     }
     else if (SeekControlCharacter(begin, end, '='))
     {
         Type prev_type = Type::kEmpty;
         Type next_type = Type::kEmpty;
-        
-        StringArray str_array;
-        IntArray int_array;
-        FloatArray flt_array;
+
+        // a single value is stored as it is, the arrays are only filled
+        // once a second value turns up
+        Variant first_value;
+        std::size_t count = 0;
+
+        std::pmr::vector<std::string_view> str_array(resource);
+        IntValues int_array(resource);
+        FloatValues flt_array(resource);
+
+        const auto append = [&](const Variant& value)
+        {
+            if (const auto int_value = std::get_if<int>(&value))
+            {
+                int_array.push_back(*int_value);
+            }
+            else if (const auto flt_value = std::get_if<float>(&value))
+            {
+                flt_array.push_back(*flt_value);
+            }
+            else
+            {
+                str_array.push_back(std::get<std::string_view>(value));
+            }
+        };
 
         do
         {
-            auto token = ReadToken(begin, end);
+            auto token = ReadToken(begin, end, storage);
 
             if (token.empty())
             {
                 return false;
             }
 
+            char number[kMaxNumberLength];
+            const auto number_length =
+                std::min(token.size(), kMaxNumberLength - 1);
+            std::memcpy(number, token.data(), number_length);
+            number[number_length] = '\0';
+
             char *int_ptr, *flt_ptr;
-            auto int_val = static_cast<int>(std::strtol(token.c_str(), &int_ptr, 10));
-            auto flt_val = std::strtof(token.c_str(), &flt_ptr);
+            auto int_val = static_cast<int>(std::strtol(number, &int_ptr, 10));
+            auto flt_val = std::strtof(number, &flt_ptr);
 
-            if (flt_ptr == int_ptr && flt_ptr != token.data())
+            Variant value;
+            if (flt_ptr == int_ptr && flt_ptr != number)
             {
-                int_array.push_back(int_val);
+                value = int_val;
                 next_type = Type::kInt;
             }
-            else if (int_ptr != token.data())
+            else if (int_ptr != number)
             {
-                flt_array.push_back(flt_val);
+                value = flt_val;
                 next_type = Type::kFloat;
             }
             else
             {
-                str_array.push_back(token);
+                value = token;
                 next_type = Type::kString;
             }
 
@@ -811,67 +1350,56 @@ bool KeyValues::Load(std::string_view::const_iterator& begin,
 
             if (prev_type != next_type)
             {
-                HOOHAHA_LOG_ERROR(
-                    "An error occurred while parsing KeyValue '%s',"
+                HOOHAHA_LOG_CAT(kv, kError,
+                    "An error occurred while parsing KeyValue '{}',"
                     " arrays of different types not supported",
-                    m_key.c_str());
+                    m_key);
                 return false;
             }
-        }
-        while (SeekControlCharacter(begin, end, ','));
 
-        const auto str_array_size = str_array.size();
-        const auto int_array_size = int_array.size();
-        const auto flt_array_size = flt_array.size();
-
-        if (str_array_size)
-        {
-            if (str_array_size > 1)
+            if (count == 0)
             {
-                m_value = str_array;
-                m_type = Type::kStringArray;
+                first_value = value;
             }
             else
             {
-                m_value = str_array.front();
-                m_type = Type::kString;
+                if (count == 1)
+                {
+                    append(first_value);
+                }
+                append(value);
             }
+            count++;
         }
+        while (SeekControlCharacter(begin, end, ','));
 
-        if (int_array_size)
+        if (count == 1)
         {
-            if (int_array_size > 1)
-            {
-                m_value = int_array;
-                m_type = Type::kIntArray;
-            }
-            else
-            {
-                m_value = int_array.front();
-                m_type = Type::kInt;
-            }
+            m_value = first_value;
+            m_type = next_type;
         }
-
-        if (flt_array_size)
+        else if (next_type == Type::kString)
         {
-            if (flt_array_size > 1)
-            {
-                m_value = flt_array;
-                m_type = Type::kFloatArray;
-            }
-            else
-            {
-                m_value = flt_array.front();
-                m_type = Type::kFloat;
-            }
+            m_value = StringValues{ std::move(str_array), nullptr, &storage };
+            m_type = Type::kStringArray;
+        }
+        else if (next_type == Type::kInt)
+        {
+            m_value = std::move(int_array);
+            m_type = Type::kIntArray;
+        }
+        else
+        {
+            m_value = std::move(flt_array);
+            m_type = Type::kFloatArray;
         }
     }
     else
     {
-        HOOHAHA_LOG_ERROR(
-            "An error occurred while parsing KeyValue '%s',"
+        HOOHAHA_LOG_CAT(kv, kError,
+            "An error occurred while parsing KeyValue '{}',"
             " unexpected symbol.",
-            m_key.c_str());
+            m_key);
         return false;
     }
 
@@ -19,7 +19,12 @@
 #ifndef HOOHAHA_CORE_KEY_VALUES_H_
 #define HOOHAHA_CORE_KEY_VALUES_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
 #include <unordered_set>
+#include <span>
 #include <string>
 #include <string_view>
 #include <variant>
@@ -28,12 +33,83 @@
 namespace core
 {
 
+class Arena;
+
+// Keys and string values are views into the source the document was loaded
+// from, which the root KeyValues keeps. Only tokens with escape sequences or
+// comments inside them are copied. Views returned by the accessors stay
+// valid until the document is cleared, reloaded or destroyed.
+//
+// A document loaded into an Arena keeps all of its nodes, hash tables,
+// arrays and the source in there. Clearing or destroying it does not walk
+// the tree, the memory comes back when the arena is Reset, which has to
+// happen after the document is cleared or destroyed.
 class KeyValues final
 {
+private:
+    // selects the constructor that keeps a view of the key, for nodes of a
+    // document that owns the source
+    struct KeyView {};
+
+    // a key to look up together with its hash
+    struct KeyProbe
+    {
+        std::string_view  key;
+        std::size_t       hash;
+    };
+
 public:
-    struct Hash { bool operator()(const KeyValues& key_values) const; };
+    // Lookups take a std::string_view or a KeyProbe directly, no
+    // KeyValues has to be built for them. Nodes keep the hash of their key.
+    struct Hash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(const KeyValues& key_values) const;
+        std::size_t operator()(std::string_view key) const;
+        std::size_t operator()(const KeyProbe& probe) const;
+    };
+
+    struct KeyEqual
+    {
+        using is_transparent = void;
+
+        bool operator()(const KeyValues& lhs, const KeyValues& rhs) const;
+        bool operator()(const KeyValues& lhs, std::string_view rhs) const;
+        bool operator()(std::string_view lhs, const KeyValues& rhs) const;
+        bool operator()(const KeyValues& lhs, const KeyProbe& rhs) const;
+        bool operator()(const KeyProbe& lhs, const KeyValues& rhs) const;
+    };
+
+    // A path split and hashed once, for paths that are read over and over.
+    // It can be built at compile time:
+    //
+    //     static constexpr KeyValues::Path kDamage("/weapons/rifle/damage");
+    //     auto damage = weapons.GetInt(kDamage, 0);
+    //
+    // The segments are views into the string the path was built from. "/"
+    // is the node itself. A malformed path, or one with more than
+    // kMaxSegments segments, finds nothing.
+    class Path
+    {
+    public:
+        static constexpr std::size_t kMaxSegments = 16;
 
-    using Set = std::unordered_set<KeyValues, Hash>;
+        constexpr explicit Path(std::string_view path);
+
+        constexpr bool IsValid() const;
+        constexpr std::size_t GetSegmentCount() const;
+
+    private:
+        friend class KeyValues;
+        friend class BinaryKeyValues;
+
+        KeyProbe     m_segments[kMaxSegments];
+        std::size_t  m_segment_count;
+        bool         m_valid;
+    };
+
+    using Set = std::pmr::unordered_set<KeyValues, Hash, KeyEqual>;
     using ConstIterator = Set::const_iterator;
 
     using StringArray = std::vector<std::string>;
@@ -42,19 +118,38 @@ public:
 
 public:
     KeyValues();
+    // copies the key
     KeyValues(std::string_view key);
+    // nodes allocate their children and arrays from resource
+    KeyValues(std::string_view key, KeyView,
+              std::pmr::memory_resource* resource =
+                  std::pmr::get_default_resource());
     KeyValues(const KeyValues&) = delete;
     KeyValues(KeyValues&&) = delete;
+    ~KeyValues();
+
+    // 64 bit FNV-1a, the hash of keys in the Set
+    static constexpr std::size_t HashKey(std::string_view key);
 
     void Clear();
 
+    // copies the source once, keys and values are views into the copy
     bool LoadFromString(std::string_view str);
+    // copies the source into the arena and builds the whole tree there
+    bool LoadFromString(std::string_view str, Arena& arena);
+    // takes over the source, nothing is copied
+    bool LoadFromBuffer(std::string&& buffer);
 
     std::string GetKey() const;
+    // view into the document
+    std::string_view GetKeyView() const;
 
     int GetInt(std::string_view key, int default_value) const;
     float GetFloat(std::string_view key, float default_value) const;
     std::string GetString(std::string_view key, std::string_view default_value) const;
+    // view into the document, or default_value
+    std::string_view GetStringView(std::string_view key,
+                                   std::string_view default_value) const;
 
     StringArray GetStringArray(std::string_view key) const;
     IntArray GetIntArray(std::string_view key) const;
@@ -68,8 +163,36 @@ public:
     const int* GetIntArrayPtr(std::string_view key) const;
     const float* GetFloatArrayPtr(std::string_view key) const;
 
+    // views into the document, empty when there is no such array
+    std::span<const std::string_view> GetStringArrayView(
+        std::string_view key) const;
+
     const KeyValues*  FindKeyValues(std::string_view branch) const;
 
+    // same as above with a prepared path
+    int GetInt(const Path& path, int default_value) const;
+    float GetFloat(const Path& path, float default_value) const;
+    std::string GetString(const Path& path, std::string_view default_value) const;
+    std::string_view GetStringView(const Path& path,
+                                   std::string_view default_value) const;
+
+    StringArray GetStringArray(const Path& path) const;
+    IntArray GetIntArray(const Path& path) const;
+    FloatArray GetFloatArray(const Path& path) const;
+
+    int GetStringArraySize(const Path& path) const;
+    int GetIntArraySize(const Path& path) const;
+    int GetFloatArraySize(const Path& path) const;
+
+    const std::string* GetStringArrayPtr(const Path& path) const;
+    const int* GetIntArrayPtr(const Path& path) const;
+    const float* GetFloatArrayPtr(const Path& path) const;
+
+    std::span<const std::string_view> GetStringArrayView(
+        const Path& path) const;
+
+    const KeyValues*  FindKeyValues(const Path& path) const;
+
     ConstIterator Begin() const;
     ConstIterator End() const;
 
@@ -86,7 +209,21 @@ public:
     bool operator != (const KeyValues& rhs) const;
 
 private:
-    std::string ReadToken(std::string_view::const_iterator& begin,
+    // compiles documents, see key_values_binary.h
+    friend class BinaryKeyValues;
+
+    struct Storage;
+
+    bool LoadDocument(std::unique_ptr<Storage> storage);
+    // drops the children, without destroying them when they are in an arena
+    void ReleaseSet();
+
+    std::string_view ReadToken(std::string_view::const_iterator& begin,
+                               std::string_view::const_iterator end,
+                               Storage& storage) const;
+    // the slow path of ReadToken for tokens that are not a plain range of
+    // the source
+    std::string CopyToken(std::string_view::const_iterator& begin,
                           std::string_view::const_iterator end) const;
 
     bool SeekControlCharacter(std::string_view::const_iterator& begin,
@@ -94,16 +231,30 @@ private:
                               char control_char) const;
 
     bool Load(std::string_view::const_iterator& begin,
-              std::string_view::const_iterator end) const;
+              std::string_view::const_iterator end,
+              Storage& storage) const;
 
 private:
+    // Arrays are kept in the memory of the document and copied out. String
+    // arrays are copied into the storage on the first GetStringArrayPtr.
+    struct StringValues
+    {
+        std::pmr::vector<std::string_view>  views;
+        // the owning copy, set once under the lock of the storage
+        const StringArray*                  strings = nullptr;
+        Storage*                            storage = nullptr;
+    };
+
+    using IntValues = std::pmr::vector<int>;
+    using FloatValues = std::pmr::vector<float>;
+
     using Variant = std::variant<
-        std::string,
+        std::string_view,
         int,
         float,
-        StringArray,
-        IntArray,
-        FloatArray>;
+        StringValues,
+        IntValues,
+        FloatValues>;
 
     enum class Type
     {
@@ -117,13 +268,76 @@ private:
         kFloatArray
     };
 
-    std::string m_key;
+    std::string_view m_key;
+    std::size_t      m_hash;
 
     mutable Type    m_type;
     mutable Variant m_value;
     mutable Set     m_set;
+
+    // the source and the copied tokens of a loaded document, or the key of
+    // a KeyValues constructed on its own
+    std::unique_ptr<Storage> m_storage;
 };
 
+constexpr std::size_t KeyValues::HashKey(std::string_view key)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+
+    for (const char c : key)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+
+    return static_cast<std::size_t>(hash);
+}
+
+constexpr KeyValues::Path::Path(std::string_view path)
+    : m_segments{}
+    , m_segment_count(0)
+    , m_valid(false)
+{
+    if (path.empty() || path[0] != '/')
+    {
+        return;
+    }
+
+    // same rules as FindKeyValues, a trailing '/' is allowed
+    std::size_t offset = 1;
+
+    while (offset < path.size())
+    {
+        auto new_offset = path.find('/', offset);
+        if (new_offset == std::string_view::npos)
+        {
+            new_offset = path.size();
+        }
+
+        const auto segment = path.substr(offset, new_offset - offset);
+        if (segment.empty() || m_segment_count == kMaxSegments)
+        {
+            m_segment_count = 0;
+            return;
+        }
+
+        m_segments[m_segment_count++] = KeyProbe{ segment, HashKey(segment) };
+        offset = new_offset + 1;
+    }
+
+    m_valid = true;
+}
+
+constexpr bool KeyValues::Path::IsValid() const
+{
+    return m_valid;
+}
+
+constexpr std::size_t KeyValues::Path::GetSegmentCount() const
+{
+    return m_segment_count;
+}
+
 }
 
 #endif // HOOHAHA_CORE_KEY_VALUES_H_
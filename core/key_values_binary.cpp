@@ -0,0 +1,961 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "key_values_binary.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "log.h"
+
+namespace core
+{
+
+HOOHAHA_LOG_DECLARE_CATEGORY(kv);
+
+namespace
+{
+
+// the node table starts on a cache line
+constexpr std::size_t kNodeTableAlignment = 64;
+// string array entries are a u32 offset and a u32 size
+constexpr std::size_t kStringEntrySize = 8;
+
+static_assert(sizeof(BinaryKeyValuesHeader) == 40);
+static_assert(sizeof(BinaryKeyValues) == 24);
+static_assert(std::is_trivially_copyable_v<BinaryKeyValues>);
+static_assert(std::is_trivially_default_constructible_v<BinaryKeyValues>);
+
+template <class T>
+inline void AppendValue(std::string& buffer, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <class T>
+inline void AppendValues(std::string& buffer, const T* values,
+                         std::size_t count)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    buffer.append(reinterpret_cast<const char*>(values), count * sizeof(T));
+}
+
+inline std::uint32_t ReadU32(const char* data)
+{
+    std::uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+bool BinaryKeyValues::Compile(const KeyValues& key_values, std::string& output)
+{
+    // Breadth first, so the children of every set end up next to each
+    // other. Offsets are relative to their section until the layout is
+    // known.
+    std::vector<const KeyValues*> sources{ &key_values };
+    std::vector<BinaryKeyValues> nodes;
+    std::vector<std::uint32_t> slots;
+    std::string arrays;
+    std::string strings;
+
+    std::unordered_map<std::string_view, std::uint32_t> string_offsets;
+    // position of every string array entry and the string it points to
+    std::vector<std::pair<std::size_t, std::uint32_t>> string_entries;
+
+    const auto AddString = [&](std::string_view str)
+    {
+        const auto [iterator, inserted] = string_offsets.try_emplace(
+            str, static_cast<std::uint32_t>(strings.size()));
+        if (inserted)
+        {
+            strings.append(str);
+        }
+
+        return iterator->second;
+    };
+
+    std::vector<const KeyValues*> children;
+
+    for (std::size_t i = 0; i < sources.size(); i++)
+    {
+        const auto& source = *sources[i];
+
+        if (source.m_key.size() > std::numeric_limits<std::uint16_t>::max())
+        {
+            HOOHAHA_LOG_CAT(kv, kError,
+                "Unable to compile KeyValues {}, key {}... is too long",
+                key_values.GetKeyView(), source.m_key.substr(0, 32));
+            return false;
+        }
+
+        BinaryKeyValues node{};
+        node.m_hash =
+            static_cast<std::uint32_t>(KeyValues::HashKey(source.m_key));
+        node.m_key = AddString(source.m_key);
+        node.m_key_size = static_cast<std::uint16_t>(source.m_key.size());
+
+        switch (source.m_type)
+        {
+        case KeyValues::Type::kSet:
+        {
+            children.clear();
+            for (const auto& child : source.m_set)
+            {
+                children.push_back(&child);
+            }
+
+            std::sort(children.begin(), children.end(),
+                      [](const KeyValues* lhs, const KeyValues* rhs)
+                      {
+                          return lhs->m_key < rhs->m_key;
+                      });
+
+            node.m_type = Type::kSet;
+            node.m_count = static_cast<std::uint32_t>(children.size());
+            node.m_value = static_cast<std::uint32_t>(sources.size());
+            node.m_slots = static_cast<std::uint32_t>(slots.size());
+
+            const auto slot_count = GetSlotCount(node.m_count);
+            const auto table = slots.size();
+            slots.resize(table + slot_count);
+
+            for (std::uint32_t child = 0; child < node.m_count; child++)
+            {
+                const auto hash = static_cast<std::uint32_t>(
+                    KeyValues::HashKey(children[child]->m_key));
+
+                auto index = hash & (slot_count - 1);
+                while (slots[table + index] != 0)
+                {
+                    index = (index + 1) & (slot_count - 1);
+                }
+
+                slots[table + index] = child + 1;
+            }
+
+            sources.insert(sources.end(), children.begin(), children.end());
+            break;
+        }
+
+        case KeyValues::Type::kString:
+        {
+            const auto value = std::get<std::string_view>(source.m_value);
+            node.m_type = Type::kString;
+            node.m_count = static_cast<std::uint32_t>(value.size());
+            node.m_value = AddString(value);
+            break;
+        }
+
+        case KeyValues::Type::kInt:
+            node.m_type = Type::kInt;
+            node.m_value =
+                std::bit_cast<std::uint32_t>(std::get<int>(source.m_value));
+            break;
+
+        case KeyValues::Type::kFloat:
+            node.m_type = Type::kFloat;
+            node.m_value =
+                std::bit_cast<std::uint32_t>(std::get<float>(source.m_value));
+            break;
+
+        case KeyValues::Type::kStringArray:
+        {
+            const auto& values =
+                std::get<KeyValues::StringValues>(source.m_value).views;
+            node.m_type = Type::kStringArray;
+            node.m_count = static_cast<std::uint32_t>(values.size());
+            node.m_value = static_cast<std::uint32_t>(arrays.size());
+
+            for (const auto value : values)
+            {
+                string_entries.emplace_back(arrays.size(), AddString(value));
+                AppendValue(arrays, std::uint32_t(0));
+                AppendValue(arrays, static_cast<std::uint32_t>(value.size()));
+            }
+            break;
+        }
+
+        case KeyValues::Type::kIntArray:
+        {
+            const auto& values = std::get<KeyValues::IntValues>(source.m_value);
+            node.m_type = Type::kIntArray;
+            node.m_count = static_cast<std::uint32_t>(values.size());
+            node.m_value = static_cast<std::uint32_t>(arrays.size());
+            AppendValues(arrays, values.data(), values.size());
+            break;
+        }
+
+        case KeyValues::Type::kFloatArray:
+        {
+            const auto& values =
+                std::get<KeyValues::FloatValues>(source.m_value);
+            node.m_type = Type::kFloatArray;
+            node.m_count = static_cast<std::uint32_t>(values.size());
+            node.m_value = static_cast<std::uint32_t>(arrays.size());
+            AppendValues(arrays, values.data(), values.size());
+            break;
+        }
+
+        default:
+            node.m_type = Type::kEmpty;
+            break;
+        }
+
+        nodes.push_back(node);
+    }
+
+    const auto node_offset = (sizeof(BinaryKeyValuesHeader) +
+                              kNodeTableAlignment - 1) &
+                             ~(kNodeTableAlignment - 1);
+    const auto slot_offset =
+        node_offset + nodes.size() * sizeof(BinaryKeyValues);
+    const auto array_offset =
+        slot_offset + slots.size() * sizeof(std::uint32_t);
+    const auto string_offset = array_offset + arrays.size();
+    const auto file_size = string_offset + strings.size();
+
+    if (file_size > std::numeric_limits<std::uint32_t>::max())
+    {
+        HOOHAHA_LOG_CAT(kv, kError,
+            "Unable to compile KeyValues {}, {} bytes do not fit 32 bit "
+            "offsets",
+            key_values.GetKeyView(), file_size);
+        return false;
+    }
+
+    // everything becomes relative to the node or entry that points to it
+    for (std::size_t i = 0; i < nodes.size(); i++)
+    {
+        auto& node = nodes[i];
+        const auto position = node_offset + i * sizeof(BinaryKeyValues);
+
+        node.m_key =
+            static_cast<std::uint32_t>(string_offset + node.m_key - position);
+
+        switch (node.m_type)
+        {
+        case Type::kSet:
+            if (node.m_count > 0)
+            {
+                node.m_value = static_cast<std::uint32_t>(
+                    node_offset + node.m_value * sizeof(BinaryKeyValues) -
+                    position);
+                node.m_slots = static_cast<std::uint32_t>(
+                    slot_offset + node.m_slots * sizeof(std::uint32_t) -
+                    position);
+            }
+            else
+            {
+                node.m_value = 0;
+                node.m_slots = 0;
+            }
+            break;
+
+        case Type::kString:
+            node.m_value = static_cast<std::uint32_t>(
+                string_offset + node.m_value - position);
+            break;
+
+        case Type::kStringArray:
+        case Type::kIntArray:
+        case Type::kFloatArray:
+            node.m_value = static_cast<std::uint32_t>(
+                array_offset + node.m_value - position);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    for (const auto& [entry, string] : string_entries)
+    {
+        const auto offset = static_cast<std::uint32_t>(
+            string_offset + string - (array_offset + entry));
+        std::memcpy(&arrays[entry], &offset, sizeof(offset));
+    }
+
+    BinaryKeyValuesHeader header{};
+    std::memcpy(header.magic, kKeyValuesBinaryMagic, sizeof(header.magic));
+    header.version = kKeyValuesBinaryVersion;
+    header.file_size = static_cast<std::uint32_t>(file_size);
+    header.node_count = static_cast<std::uint32_t>(nodes.size());
+    header.slot_count = static_cast<std::uint32_t>(slots.size());
+    header.node_offset = static_cast<std::uint32_t>(node_offset);
+    header.slot_offset = static_cast<std::uint32_t>(slot_offset);
+    header.array_offset = static_cast<std::uint32_t>(array_offset);
+    header.string_offset = static_cast<std::uint32_t>(string_offset);
+
+    output.reserve(output.size() + file_size);
+    AppendValue(output, header);
+    output.append(node_offset - sizeof(header), '\0');
+    AppendValues(output, nodes.data(), nodes.size());
+    AppendValues(output, slots.data(), slots.size());
+    output += arrays;
+    output += strings;
+
+    return true;
+}
+
+std::string BinaryKeyValues::GetKey() const
+{
+    return std::string(GetKeyView());
+}
+
+std::string_view BinaryKeyValues::GetKeyView() const
+{
+    return { GetPointer(m_key), m_key_size };
+}
+
+int BinaryKeyValues::GetInt(std::string_view key, int default_value) const
+{
+    auto key_values = FindValue(key, Type::kInt);
+    if (key_values == nullptr)
+    {
+        return default_value;
+    }
+
+    return std::bit_cast<int>(key_values->m_value);
+}
+
+float BinaryKeyValues::GetFloat(std::string_view key, float default_value) const
+{
+    auto key_values = FindValue(key, Type::kFloat);
+    if (key_values == nullptr)
+    {
+        return default_value;
+    }
+
+    return std::bit_cast<float>(key_values->m_value);
+}
+
+std::string BinaryKeyValues::GetString(std::string_view key,
+                                       std::string_view default_value) const
+{
+    return std::string(GetStringView(key, default_value));
+}
+
+std::string_view BinaryKeyValues::GetStringView(
+    std::string_view key, std::string_view default_value) const
+{
+    auto key_values = FindValue(key, Type::kString);
+    if (key_values == nullptr)
+    {
+        return default_value;
+    }
+
+    return key_values->GetStringValue();
+}
+
+BinaryKeyValues::StringArray BinaryKeyValues::GetStringArray(
+    std::string_view key) const
+{
+    auto key_values = FindValue(key, Type::kStringArray);
+    if (key_values == nullptr)
+    {
+        return {};
+    }
+
+    return key_values->GetStringArrayValue();
+}
+
+BinaryKeyValues::IntArray BinaryKeyValues::GetIntArray(
+    std::string_view key) const
+{
+    auto key_values = FindValue(key, Type::kIntArray);
+    if (key_values == nullptr)
+    {
+        return {};
+    }
+
+    const auto values = reinterpret_cast<const int*>(
+        key_values->GetPointer(key_values->m_value));
+    return IntArray(values, values + key_values->m_count);
+}
+
+BinaryKeyValues::FloatArray BinaryKeyValues::GetFloatArray(
+    std::string_view key) const
+{
+    auto key_values = FindValue(key, Type::kFloatArray);
+    if (key_values == nullptr)
+    {
+        return {};
+    }
+
+    const auto values = reinterpret_cast<const float*>(
+        key_values->GetPointer(key_values->m_value));
+    return FloatArray(values, values + key_values->m_count);
+}
+
+int BinaryKeyValues::GetStringArraySize(std::string_view key) const
+{
+    auto key_values = FindValue(key, Type::kStringArray);
+    return key_values != nullptr ? static_cast<int>(key_values->m_count) : 0;
+}
+
+int BinaryKeyValues::GetIntArraySize(std::string_view key) const
+{
+    auto key_values = FindValue(key, Type::kIntArray);
+    return key_values != nullptr ? static_cast<int>(key_values->m_count) : 0;
+}
+
+int BinaryKeyValues::GetFloatArraySize(std::string_view key) const
+{
+    auto key_values = FindValue(key, Type::kFloatArray);
+    return key_values != nullptr ? static_cast<int>(key_values->m_count) : 0;
+}
+
+const int* BinaryKeyValues::GetIntArrayPtr(std::string_view key) const
+{
+    auto key_values = FindValue(key, Type::kIntArray);
+    if (key_values == nullptr)
+    {
+        return nullptr;
+    }
+
+    return reinterpret_cast<const int*>(
+        key_values->GetPointer(key_values->m_value));
+}
+
+const float* BinaryKeyValues::GetFloatArrayPtr(std::string_view key) const
+{
+    auto key_values = FindValue(key, Type::kFloatArray);
+    if (key_values == nullptr)
+    {
+        return nullptr;
+    }
+
+    return reinterpret_cast<const float*>(
+        key_values->GetPointer(key_values->m_value));
+}
+
+const BinaryKeyValues* BinaryKeyValues::FindKeyValues(
+    std::string_view key) const
+{
+    if (key.size() < 2 || key[0] != '/')
+    {
+        return nullptr;
+    }
+
+    // same rules as KeyValues::FindKeyValues
+    const BinaryKeyValues* key_values = this;
+    std::size_t offset = 1;
+
+    while (offset < key.size())
+    {
+        auto new_offset = key.find('/', offset);
+        if (new_offset == std::string_view::npos)
+        {
+            new_offset = key.size();
+        }
+
+        const auto segment = key.substr(offset, new_offset - offset);
+        if (segment.empty())
+        {
+            return nullptr;
+        }
+
+        key_values =
+            key_values->FindChild(segment, KeyValues::HashKey(segment));
+        if (key_values == nullptr)
+        {
+            return nullptr;
+        }
+
+        offset = new_offset + 1;
+    }
+
+    return key_values;
+}
+
+int BinaryKeyValues::GetInt(const Path& path, int default_value) const
+{
+    auto key_values = FindValue(path, Type::kInt);
+    if (key_values == nullptr)
+    {
+        return default_value;
+    }
+
+    return std::bit_cast<int>(key_values->m_value);
+}
+
+float BinaryKeyValues::GetFloat(const Path& path, float default_value) const
+{
+    auto key_values = FindValue(path, Type::kFloat);
+    if (key_values == nullptr)
+    {
+        return default_value;
+    }
+
+    return std::bit_cast<float>(key_values->m_value);
+}
+
+std::string BinaryKeyValues::GetString(const Path& path,
+                                       std::string_view default_value) const
+{
+    return std::string(GetStringView(path, default_value));
+}
+
+std::string_view BinaryKeyValues::GetStringView(
+    const Path& path, std::string_view default_value) const
+{
+    auto key_values = FindValue(path, Type::kString);
+    if (key_values == nullptr)
+    {
+        return default_value;
+    }
+
+    return key_values->GetStringValue();
+}
+
+BinaryKeyValues::StringArray BinaryKeyValues::GetStringArray(
+    const Path& path) const
+{
+    auto key_values = FindValue(path, Type::kStringArray);
+    if (key_values == nullptr)
+    {
+        return {};
+    }
+
+    return key_values->GetStringArrayValue();
+}
+
+BinaryKeyValues::IntArray BinaryKeyValues::GetIntArray(const Path& path) const
+{
+    auto key_values = FindValue(path, Type::kIntArray);
+    if (key_values == nullptr)
+    {
+        return {};
+    }
+
+    return key_values->GetIntArray("/");
+}
+
+BinaryKeyValues::FloatArray BinaryKeyValues::GetFloatArray(
+    const Path& path) const
+{
+    auto key_values = FindValue(path, Type::kFloatArray);
+    if (key_values == nullptr)
+    {
+        return {};
+    }
+
+    return key_values->GetFloatArray("/");
+}
+
+int BinaryKeyValues::GetStringArraySize(const Path& path) const
+{
+    auto key_values = FindValue(path, Type::kStringArray);
+    return key_values != nullptr ? static_cast<int>(key_values->m_count) : 0;
+}
+
+int BinaryKeyValues::GetIntArraySize(const Path& path) const
+{
+    auto key_values = FindValue(path, Type::kIntArray);
+    return key_values != nullptr ? static_cast<int>(key_values->m_count) : 0;
+}
+
+int BinaryKeyValues::GetFloatArraySize(const Path& path) const
+{
+    auto key_values = FindValue(path, Type::kFloatArray);
+    return key_values != nullptr ? static_cast<int>(key_values->m_count) : 0;
+}
+
+const int* BinaryKeyValues::GetIntArrayPtr(const Path& path) const
+{
+    auto key_values = FindValue(path, Type::kIntArray);
+    if (key_values == nullptr)
+    {
+        return nullptr;
+    }
+
+    return key_values->GetIntArrayPtr("/");
+}
+
+const float* BinaryKeyValues::GetFloatArrayPtr(const Path& path) const
+{
+    auto key_values = FindValue(path, Type::kFloatArray);
+    if (key_values == nullptr)
+    {
+        return nullptr;
+    }
+
+    return key_values->GetFloatArrayPtr("/");
+}
+
+const BinaryKeyValues* BinaryKeyValues::FindKeyValues(const Path& path) const
+{
+    if (!path.IsValid())
+    {
+        return nullptr;
+    }
+
+    const BinaryKeyValues* key_values = this;
+
+    for (std::size_t i = 0;
+         i < path.m_segment_count && key_values != nullptr; i++)
+    {
+        const auto& segment = path.m_segments[i];
+        key_values = key_values->FindChild(segment.key, segment.hash);
+    }
+
+    return key_values;
+}
+
+BinaryKeyValues::ConstIterator BinaryKeyValues::Begin() const
+{
+    return GetChildren();
+}
+
+BinaryKeyValues::ConstIterator BinaryKeyValues::End() const
+{
+    return GetChildren() + (m_type == Type::kSet ? m_count : 0);
+}
+
+BinaryKeyValues::ConstIterator BinaryKeyValues::begin() const
+{
+    return Begin();
+}
+
+BinaryKeyValues::ConstIterator BinaryKeyValues::end() const
+{
+    return End();
+}
+
+std::uint32_t BinaryKeyValues::GetSlotCount(std::uint32_t child_count)
+{
+    return child_count > 0 ? std::bit_ceil(child_count * 2) : 0;
+}
+
+const char* BinaryKeyValues::GetPointer(std::uint32_t offset) const
+{
+    return reinterpret_cast<const char*>(this) + offset;
+}
+
+const BinaryKeyValues* BinaryKeyValues::GetChildren() const
+{
+    if (m_type != Type::kSet || m_count == 0)
+    {
+        return this;
+    }
+
+    return reinterpret_cast<const BinaryKeyValues*>(GetPointer(m_value));
+}
+
+const BinaryKeyValues* BinaryKeyValues::FindChild(std::string_view key,
+                                                  std::size_t hash) const
+{
+    if (m_type != Type::kSet || m_count == 0)
+    {
+        return nullptr;
+    }
+
+    const auto slots =
+        reinterpret_cast<const std::uint32_t*>(GetPointer(m_slots));
+    const auto children = GetChildren();
+    const auto mask = GetSlotCount(m_count) - 1;
+    const auto key_hash = static_cast<std::uint32_t>(hash);
+
+    // bounded by the table size, a full table is only possible in a
+    // corrupted file
+    auto index = key_hash & mask;
+    for (std::uint32_t probe = 0; probe <= mask; probe++)
+    {
+        const auto slot = slots[index];
+        if (slot == 0)
+        {
+            break;
+        }
+
+        const auto& child = children[slot - 1];
+        if (child.m_hash == key_hash && child.GetKeyView() == key)
+        {
+            return &child;
+        }
+
+        index = (index + 1) & mask;
+    }
+
+    return nullptr;
+}
+
+const BinaryKeyValues* BinaryKeyValues::FindValue(std::string_view key,
+                                                  Type type) const
+{
+    if (key == "/")
+    {
+        return m_type == type ? this : nullptr;
+    }
+
+    auto key_values = FindKeyValues(key);
+    if (key_values == nullptr || key_values->m_type != type)
+    {
+        return nullptr;
+    }
+
+    return key_values;
+}
+
+const BinaryKeyValues* BinaryKeyValues::FindValue(const Path& path,
+                                                  Type type) const
+{
+    auto key_values = FindKeyValues(path);
+    if (key_values == nullptr || key_values->m_type != type)
+    {
+        return nullptr;
+    }
+
+    return key_values;
+}
+
+std::string_view BinaryKeyValues::GetStringValue() const
+{
+    return { GetPointer(m_value), m_count };
+}
+
+BinaryKeyValues::StringArray BinaryKeyValues::GetStringArrayValue() const
+{
+    StringArray values;
+    values.reserve(m_count);
+
+    const auto entries = GetPointer(m_value);
+    for (std::uint32_t i = 0; i < m_count; i++)
+    {
+        const auto entry = entries + i * kStringEntrySize;
+        values.emplace_back(entry + ReadU32(entry), ReadU32(entry + 4));
+    }
+
+    return values;
+}
+
+MappedKeyValues::MappedKeyValues()
+    : m_header{}
+    , m_root(nullptr)
+{
+}
+
+MappedKeyValues::~MappedKeyValues()
+{
+    Close();
+}
+
+bool MappedKeyValues::Open(std::string_view path)
+{
+    Close();
+
+    if (!m_file.Open(std::string(path)))
+    {
+        HOOHAHA_LOG_CAT(kv, kError, "Unable to open compiled KeyValues {}",
+                        path);
+        return false;
+    }
+
+    const auto data = m_file.GetData();
+    if (data.size() >= sizeof(m_header))
+    {
+        std::memcpy(&m_header, data.data(), sizeof(m_header));
+    }
+
+    const auto& header = m_header;
+    const std::uint64_t node_end = std::uint64_t(header.node_offset) +
+                                   std::uint64_t(header.node_count) *
+                                       sizeof(BinaryKeyValues);
+    const std::uint64_t slot_end = std::uint64_t(header.slot_offset) +
+                                   std::uint64_t(header.slot_count) *
+                                       sizeof(std::uint32_t);
+
+    const bool valid =
+        data.size() >= sizeof(m_header) &&
+        std::memcmp(header.magic, kKeyValuesBinaryMagic,
+                    sizeof(header.magic)) == 0 &&
+        header.version == kKeyValuesBinaryVersion &&
+        header.file_size == data.size() &&
+        header.node_count > 0 &&
+        header.node_offset >= sizeof(m_header) &&
+        header.node_offset % alignof(BinaryKeyValues) == 0 &&
+        node_end == header.slot_offset &&
+        slot_end == header.array_offset &&
+        header.array_offset <= header.string_offset &&
+        header.string_offset <= header.file_size;
+
+    if (!valid)
+    {
+        HOOHAHA_LOG_CAT(kv, kError, "{} is not a compiled KeyValues file",
+                        path);
+        Close();
+        return false;
+    }
+
+    m_root = reinterpret_cast<const BinaryKeyValues*>(data.data() +
+                                                      header.node_offset);
+
+    HOOHAHA_LOG_CAT(kv, kDebug, "KeyValues {} mapped, {} nodes, {} bytes",
+                    m_root->GetKeyView(), header.node_count, header.file_size);
+
+    return true;
+}
+
+void MappedKeyValues::Close()
+{
+    m_file.Close();
+    m_header = {};
+    m_root = nullptr;
+}
+
+bool MappedKeyValues::Verify() const
+{
+    if (m_root == nullptr)
+    {
+        return false;
+    }
+
+    using Type = BinaryKeyValues::Type;
+
+    const auto& header = m_header;
+    const auto data = m_file.GetData();
+
+    // whether [begin, begin + size) lies within [section_begin, section_end)
+    const auto InRange = [](std::uint64_t begin, std::uint64_t size,
+                            std::uint64_t section_begin,
+                            std::uint64_t section_end)
+    {
+        return begin >= section_begin && begin <= section_end &&
+               size <= section_end - begin;
+    };
+
+    const auto IsString = [&](std::uint64_t begin, std::uint64_t size)
+    {
+        return InRange(begin, size, header.string_offset, header.file_size);
+    };
+
+    for (std::uint32_t i = 0; i < header.node_count; i++)
+    {
+        const auto& node = m_root[i];
+        const std::uint64_t position =
+            header.node_offset + std::uint64_t(i) * sizeof(BinaryKeyValues);
+        const std::uint64_t value = position + node.m_value;
+
+        bool valid = IsString(position + node.m_key, node.m_key_size);
+        if (valid)
+        {
+            valid = static_cast<std::uint32_t>(
+                        KeyValues::HashKey(node.GetKeyView())) == node.m_hash;
+        }
+
+        switch (node.m_type)
+        {
+        case Type::kEmpty:
+        case Type::kInt:
+        case Type::kFloat:
+            break;
+
+        case Type::kSet:
+        {
+            if (!valid || node.m_count == 0)
+            {
+                break;
+            }
+
+            // children always come after their parent, so there are no
+            // cycles
+            const auto first = value - header.node_offset;
+            const auto slot_count = BinaryKeyValues::GetSlotCount(node.m_count);
+            const std::uint64_t slots = position + node.m_slots;
+
+            valid = value > position &&
+                    first % sizeof(BinaryKeyValues) == 0 &&
+                    first / sizeof(BinaryKeyValues) + node.m_count <=
+                        header.node_count &&
+                    slots % sizeof(std::uint32_t) == 0 &&
+                    InRange(slots,
+                            std::uint64_t(slot_count) * sizeof(std::uint32_t),
+                            header.slot_offset, header.array_offset);
+
+            bool has_empty_slot = false;
+            for (std::uint32_t slot = 0; valid && slot < slot_count; slot++)
+            {
+                const auto child = ReadU32(data.data() + slots +
+                                           slot * sizeof(std::uint32_t));
+                valid = child <= node.m_count;
+                has_empty_slot |= child == 0;
+            }
+
+            valid = valid && has_empty_slot;
+            break;
+        }
+
+        case Type::kString:
+            valid = valid && IsString(value, node.m_count);
+            break;
+
+        case Type::kIntArray:
+        case Type::kFloatArray:
+            valid = valid && value % sizeof(std::uint32_t) == 0 &&
+                    InRange(value,
+                            std::uint64_t(node.m_count) * sizeof(std::uint32_t),
+                            header.array_offset, header.string_offset);
+            break;
+
+        case Type::kStringArray:
+        {
+            valid = valid && value % sizeof(std::uint32_t) == 0 &&
+                    InRange(value,
+                            std::uint64_t(node.m_count) * kStringEntrySize,
+                            header.array_offset, header.string_offset);
+
+            for (std::uint32_t element = 0; valid && element < node.m_count;
+                 element++)
+            {
+                const auto entry = value + element * kStringEntrySize;
+                valid = IsString(entry + ReadU32(data.data() + entry),
+                                 ReadU32(data.data() + entry + 4));
+            }
+            break;
+        }
+
+        default:
+            valid = false;
+            break;
+        }
+
+        if (!valid)
+        {
+            HOOHAHA_LOG_CAT(kv, kError,
+                "Compiled KeyValues is corrupted at node {}", i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+const BinaryKeyValues* MappedKeyValues::GetRoot() const
+{
+    return m_root;
+}
+
+}
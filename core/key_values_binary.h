@@ -0,0 +1,264 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef HOOHAHA_CORE_KEY_VALUES_BINARY_H_
+#define HOOHAHA_CORE_KEY_VALUES_BINARY_H_
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "key_values.h"
+#include "mapped_file.h"
+
+namespace core
+{
+
+// Compiled KeyValues layout, all values are stored in native byte order:
+//
+//   header  : "HHKVBIN", u32 version, u32 file size, u32 node count,
+//             u32 slot count, u32 node table offset, u32 slot table offset,
+//             u32 array offset, u32 string pool offset
+//   nodes   : one BinaryKeyValues per node, the root first. The children of
+//             a set are next to each other, sorted by key.
+//   slots   : one open addressing table of u32 per set, a slot holds the
+//             child index + 1 or zero when empty. A table has the power of
+//             two at or above twice the children slots.
+//   arrays  : int and float values, string arrays as (u32 offset, u32 size)
+//             pairs pointing into the string pool
+//   strings : keys and string values, not terminated, duplicates merged
+//
+// Keys are limited to 65535 bytes. Offsets inside nodes and string array
+// entries are relative to the node or the entry they are stored in, so the
+// file is used right where it is mapped. Files are written by
+// BinaryKeyValues::Compile, see the kv_compiler tool.
+
+constexpr char kKeyValuesBinaryMagic[8] = { 'H', 'H', 'K', 'V',
+                                            'B', 'I', 'N', '\0' };
+constexpr std::uint32_t kKeyValuesBinaryVersion = 1;
+
+struct BinaryKeyValuesHeader
+{
+    char           magic[8];
+    std::uint32_t  version;
+    std::uint32_t  file_size;
+    std::uint32_t  node_count;
+    std::uint32_t  slot_count;
+    std::uint32_t  node_offset;
+    std::uint32_t  slot_offset;
+    std::uint32_t  array_offset;
+    std::uint32_t  string_offset;
+};
+
+// A node of a compiled document. Nodes are not constructed, they are read
+// in place from the mapped file (see MappedKeyValues). The accessors behave
+// like the ones of KeyValues, see KeyValuesReader. GetStringArrayPtr and
+// GetStringArrayView are missing, string arrays are stored as offsets into
+// the string pool.
+class BinaryKeyValues final
+{
+public:
+    using ConstIterator = const BinaryKeyValues*;
+    using Path = KeyValues::Path;
+
+    using StringArray = KeyValues::StringArray;
+    using IntArray = KeyValues::IntArray;
+    using FloatArray = KeyValues::FloatArray;
+
+public:
+    // Appends the binary form of a parsed document to output. Fails when
+    // the document does not fit the 32 bit offsets.
+    static bool Compile(const KeyValues& key_values, std::string& output);
+
+    std::string GetKey() const;
+    std::string_view GetKeyView() const;
+
+    int GetInt(std::string_view key, int default_value) const;
+    float GetFloat(std::string_view key, float default_value) const;
+    std::string GetString(std::string_view key,
+                          std::string_view default_value) const;
+    std::string_view GetStringView(std::string_view key,
+                                   std::string_view default_value) const;
+
+    StringArray GetStringArray(std::string_view key) const;
+    IntArray GetIntArray(std::string_view key) const;
+    FloatArray GetFloatArray(std::string_view key) const;
+
+    int GetStringArraySize(std::string_view key) const;
+    int GetIntArraySize(std::string_view key) const;
+    int GetFloatArraySize(std::string_view key) const;
+
+    const int* GetIntArrayPtr(std::string_view key) const;
+    const float* GetFloatArrayPtr(std::string_view key) const;
+
+    const BinaryKeyValues*  FindKeyValues(std::string_view branch) const;
+
+    int GetInt(const Path& path, int default_value) const;
+    float GetFloat(const Path& path, float default_value) const;
+    std::string GetString(const Path& path,
+                          std::string_view default_value) const;
+    std::string_view GetStringView(const Path& path,
+                                   std::string_view default_value) const;
+
+    StringArray GetStringArray(const Path& path) const;
+    IntArray GetIntArray(const Path& path) const;
+    FloatArray GetFloatArray(const Path& path) const;
+
+    int GetStringArraySize(const Path& path) const;
+    int GetIntArraySize(const Path& path) const;
+    int GetFloatArraySize(const Path& path) const;
+
+    const int* GetIntArrayPtr(const Path& path) const;
+    const float* GetFloatArrayPtr(const Path& path) const;
+
+    const BinaryKeyValues*  FindKeyValues(const Path& path) const;
+
+    ConstIterator Begin() const;
+    ConstIterator End() const;
+
+    // for range based loops
+    ConstIterator begin() const;
+    ConstIterator end() const;
+
+private:
+    friend class MappedKeyValues;
+
+    enum class Type : std::uint8_t
+    {
+        kEmpty,
+        kSet,
+        kString,
+        kInt,
+        kFloat,
+        kStringArray,
+        kIntArray,
+        kFloatArray
+    };
+
+    static std::uint32_t GetSlotCount(std::uint32_t child_count);
+
+    const char* GetPointer(std::uint32_t offset) const;
+    const BinaryKeyValues* GetChildren() const;
+
+    const BinaryKeyValues* FindChild(std::string_view key,
+                                     std::size_t hash) const;
+
+    // the node that holds the value of the given type, or null
+    const BinaryKeyValues* FindValue(std::string_view key, Type type) const;
+    const BinaryKeyValues* FindValue(const Path& path, Type type) const;
+
+    std::string_view GetStringValue() const;
+    StringArray GetStringArrayValue() const;
+
+private:
+    // low 32 bits of KeyValues::HashKey
+    std::uint32_t  m_hash;
+    // offset and size of the key in the string pool
+    std::uint32_t  m_key;
+    std::uint16_t  m_key_size;
+    Type           m_type;
+    std::uint8_t   m_reserved;
+    // children of a set, elements of an array or bytes of a string
+    std::uint32_t  m_count;
+    // the int or float bits, or the offset of the string, array or first
+    // child
+    std::uint32_t  m_value;
+    // offset of the slot table of a set
+    std::uint32_t  m_slots;
+};
+
+// The read interface KeyValues and BinaryKeyValues share. Code that reads a
+// document takes either one through a template constrained by it, like
+// Log::ConfigureCategories does. Code that uses GetStringArrayPtr or
+// GetStringArrayView stays limited to KeyValues.
+template <class T>
+concept KeyValuesReader = requires(const T& key_values, std::string_view key,
+                                   const KeyValues::Path& path)
+{
+    { key_values.GetKey() } -> std::same_as<std::string>;
+    { key_values.GetKeyView() } -> std::same_as<std::string_view>;
+
+    { key_values.GetInt(key, 0) } -> std::same_as<int>;
+    { key_values.GetFloat(key, 0.0f) } -> std::same_as<float>;
+    { key_values.GetString(key, key) } -> std::same_as<std::string>;
+    { key_values.GetStringView(key, key) } -> std::same_as<std::string_view>;
+    { key_values.GetStringArray(key) } -> std::same_as<KeyValues::StringArray>;
+    { key_values.GetIntArray(key) } -> std::same_as<KeyValues::IntArray>;
+    { key_values.GetFloatArray(key) } -> std::same_as<KeyValues::FloatArray>;
+    { key_values.GetStringArraySize(key) } -> std::same_as<int>;
+    { key_values.GetIntArraySize(key) } -> std::same_as<int>;
+    { key_values.GetFloatArraySize(key) } -> std::same_as<int>;
+    { key_values.GetIntArrayPtr(key) } -> std::same_as<const int*>;
+    { key_values.GetFloatArrayPtr(key) } -> std::same_as<const float*>;
+    { key_values.FindKeyValues(key) } -> std::same_as<const T*>;
+
+    { key_values.GetInt(path, 0) } -> std::same_as<int>;
+    { key_values.GetFloat(path, 0.0f) } -> std::same_as<float>;
+    { key_values.GetString(path, key) } -> std::same_as<std::string>;
+    { key_values.GetStringView(path, key) } -> std::same_as<std::string_view>;
+    { key_values.GetStringArray(path) } -> std::same_as<KeyValues::StringArray>;
+    { key_values.GetIntArray(path) } -> std::same_as<KeyValues::IntArray>;
+    { key_values.GetFloatArray(path) } -> std::same_as<KeyValues::FloatArray>;
+    { key_values.GetStringArraySize(path) } -> std::same_as<int>;
+    { key_values.GetIntArraySize(path) } -> std::same_as<int>;
+    { key_values.GetFloatArraySize(path) } -> std::same_as<int>;
+    { key_values.GetIntArrayPtr(path) } -> std::same_as<const int*>;
+    { key_values.GetFloatArrayPtr(path) } -> std::same_as<const float*>;
+    { key_values.FindKeyValues(path) } -> std::same_as<const T*>;
+
+    { *key_values.begin() } -> std::same_as<const T&>;
+    { key_values.end() } -> std::same_as<decltype(key_values.begin())>;
+};
+
+static_assert(KeyValuesReader<KeyValues>);
+static_assert(KeyValuesReader<BinaryKeyValues>);
+
+// A compiled document mapped from a file. Open only checks the header, the
+// nodes are used as they are; Verify checks every node for files that do
+// not come from a trusted build.
+class MappedKeyValues final
+{
+public:
+    MappedKeyValues();
+    MappedKeyValues(const MappedKeyValues&) = delete;
+    MappedKeyValues(MappedKeyValues&&) = delete;
+    ~MappedKeyValues();
+
+    bool Open(std::string_view path);
+    void Close();
+
+    bool Verify() const;
+
+    // null when nothing is open
+    const BinaryKeyValues* GetRoot() const;
+
+    MappedKeyValues& operator=(const MappedKeyValues&) = delete;
+    MappedKeyValues& operator=(MappedKeyValues&&) = delete;
+
+private:
+    MappedFile              m_file;
+    BinaryKeyValuesHeader   m_header;
+    const BinaryKeyValues*  m_root;
+};
+
+}
+
+#endif // HOOHAHA_CORE_KEY_VALUES_BINARY_H_
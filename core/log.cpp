@@ -18,13 +18,28 @@
 
 #include "log.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cctype>
 #include <chrono>
 #include <cstdarg>
-#include <ctime>
+#include <cstring>
 #include <format>
-#include <sstream>
+#include <iterator>
 #include <thread>
+#include <vector>
+
+#include "clock.h"
+#include "key_values.h"
+#include "key_values_binary.h"
+#include "log_compression.h"
+#include "log_queue.h"
+#include "log_shared_ring.h"
+#include "log_sink.h"
+#include "log_writer.h"
+#include "metrics.h"
+#include "thread_registry.h"
+#include "timestamp.h"
 
 namespace core
 {
@@ -34,35 +49,146 @@ Log log;
 namespace
 {
 
-std::string TimeToString(std::chrono::system_clock::time_point time)
+const std::size_t kInitialMessageBufferSize = 1024;
+const std::size_t kWriterBatchRecords = 1024;
+const auto kWriterIdleTimeout = std::chrono::milliseconds(10);
+// how often the counts of quiet rate limited call sites are checked
+const auto kSuppressedReportInterval = std::chrono::milliseconds(100);
+
+// Messages and complete records are formatted into these per-thread buffers
+// before they go to the file or to the async queue. They keep their capacity
+// between calls, so steady state logging does not allocate. std::format
+// style text messages go straight into the record buffer.
+thread_local std::string t_message_buffer;
+thread_local std::string t_record_buffer;
+
+// true on the async writer thread, which writes its own records directly
+thread_local bool t_log_writer_thread = false;
+
+// the binary log session the calling thread last wrote its name into, and
+// that name
+thread_local std::uint32_t t_binary_thread_session = 0;
+thread_local std::string t_binary_thread_name;
+
+std::size_t NextProducerStripe()
+{
+    static std::atomic<std::size_t> next_stripe(0);
+    return next_stripe.fetch_add(1, std::memory_order_relaxed);
+}
+
+// the stripe of Log::m_async_producers the calling thread counts itself in,
+// handed out round robin
+thread_local const std::size_t t_producer_stripe = NextProducerStripe();
+
+std::string_view FormatMessageV(const char* format, va_list args)
 {
-    using namespace std::chrono;
+    auto& buffer = t_message_buffer;
+    if (buffer.size() < kInitialMessageBufferSize)
+    {
+        buffer.resize(kInitialMessageBufferSize);
+    }
+
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int length = std::vsnprintf(&buffer[0], buffer.size(), format, args_copy);
+    va_end(args_copy);
 
-    const int bufsize = 32;
+    if (length < 0)
+    {
+        return {};
+    }
 
-    char replybuf[bufsize];
-    char buf_datetime[21];
-    char buf_millisec[4];
-    char buf_timezone[6];
+    if (static_cast<std::size_t>(length) >= buffer.size())
+    {
+        buffer.resize(length + 1);
+        std::vsnprintf(&buffer[0], buffer.size(), format, args);
+    }
+
+    return std::string_view(buffer.data(), length);
+}
+
+// Binary records carry raw clock ticks, the decoder converts them with the
+// calibration stored in the header
+inline std::int64_t NowTicks()
+{
+    return static_cast<std::int64_t>(ReadClockTicks());
+}
+
+inline std::chrono::system_clock::time_point Now()
+{
+    return ClockTicksToTime(ReadClockTicks());
+}
+
+inline std::int64_t SteadyNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Every live LogCategory, so the log can update their levels and find them
+// by name. Categories are usually globals, the registry is created by the
+// first one that is constructed.
+struct LogCategoryRegistry
+{
+    std::mutex                 mutex;
+    std::vector<LogCategory*>  categories;
+    // the log level, followed by categories without a level of their own
+    LogLevel                   log_level = LogLevel::kInfo;
+    // most verbose level the sinks or the flight recorder want
+    LogLevel                   extra_level = LogLevel::kFatal;
+};
+
+LogCategoryRegistry& GetCategoryRegistry()
+{
+    static LogCategoryRegistry registry;
+    return registry;
+}
 
-    auto duration = time.time_since_epoch();
-    auto sec = duration_cast<seconds>(duration);
-    auto millisec = duration_cast<milliseconds>(duration - sec);
-    std::time_t tv_sec = sec.count();
-    struct tm now;
+// Rate limiters that have suppressed something, so their counts can be
+// reported when their call site goes quiet. Limiters are function statics
+// and never leave the list.
+struct LogRateLimiterRegistry
+{
+    std::mutex                    mutex;
+    std::vector<LogRateLimiter*>  limiters;
+    std::atomic<bool>             has_limiters{ false };
+};
 
-    localtime_s(&now, &tv_sec);
+LogRateLimiterRegistry& GetRateLimiterRegistry()
+{
+    static LogRateLimiterRegistry registry;
+    return registry;
+}
 
-    std::snprintf(buf_millisec, sizeof(buf_millisec), "%03d", static_cast<int>(millisec.count()));
+// Messages that reached the file or a sink, indexed by level
+MetricCounter g_message_counts[] = {
+    { "log_messages_total", "Log messages written", "level=\"fatal\"" },
+    { "log_messages_total", "Log messages written", "level=\"error\"" },
+    { "log_messages_total", "Log messages written", "level=\"warning\"" },
+    { "log_messages_total", "Log messages written", "level=\"info\"" },
+    { "log_messages_total", "Log messages written", "level=\"debug\"" },
+    { "log_messages_total", "Log messages written", "level=\"trace\"" }
+};
 
-    std::strftime(buf_datetime, sizeof(buf_datetime), "%FT%T.", &now);
-    std::strftime(buf_timezone, sizeof(buf_timezone), "%z", &now);
-    std::snprintf(replybuf, bufsize, "%s%s%s", buf_datetime, buf_millisec, buf_timezone);
+inline void CountMessage(LogLevel level)
+{
+    const auto index = static_cast<std::size_t>(level);
+    if (index < std::size(g_message_counts))
+    {
+        g_message_counts[index].Increment();
+    }
+}
 
-    return replybuf;
+inline void PatchBinaryEntrySize(std::string& entry)
+{
+    const auto size =
+        static_cast<std::uint32_t>(entry.size() - kLogBinaryEntryHeaderSize);
+    std::memcpy(&entry[sizeof(LogBinaryEntry)], &size, sizeof(size));
 }
 
-inline std::string LogLevelToString(LogLevel level)
+} // namespace
+
+std::string_view LogLevelToString(LogLevel level)
 {
     switch (level)
     {
@@ -84,28 +210,158 @@ inline std::string LogLevelToString(LogLevel level)
     }
 }
 
-inline std::string ThreadIdToString(std::thread::id id)
+void RegisterLogRateLimiter(LogRateLimiter& limiter)
 {
-    std::ostringstream stream;
-    stream << id;
-    return stream.str();
+    auto& registry = GetRateLimiterRegistry();
+    std::unique_lock<std::mutex> lock(registry.mutex);
+
+    registry.limiters.push_back(&limiter);
+    registry.has_limiters.store(true, std::memory_order_release);
 }
 
-} // namespace
+bool LogLevelFromString(std::string_view str, LogLevel& level)
+{
+    const auto equals = [str](std::string_view name)
+    {
+        return std::equal(str.begin(), str.end(), name.begin(), name.end(),
+            [](char left, char right)
+            {
+                return std::tolower(static_cast<unsigned char>(left)) ==
+                       std::tolower(static_cast<unsigned char>(right));
+            });
+    };
+
+    for (const auto candidate : { LogLevel::kFatal, LogLevel::kError,
+                                  LogLevel::kWarning, LogLevel::kInfo,
+                                  LogLevel::kDebug, LogLevel::kTrace })
+    {
+        auto name = LogLevelToString(candidate);
+        name = name.substr(0, name.find(' '));
+
+        if (equals(name))
+        {
+            level = candidate;
+            return true;
+        }
+    }
+
+    if (equals("warning"))
+    {
+        level = LogLevel::kWarning;
+        return true;
+    }
+
+    return false;
+}
+
+LogCategory::LogCategory(std::string_view name)
+    : m_name(name)
+    , m_inherit_level(true)
+    , m_level(LogLevel::kInfo)
+    , m_enabled_level(LogLevel::kInfo)
+{
+    auto& registry = GetCategoryRegistry();
+    std::unique_lock<std::mutex> lock(registry.mutex);
+
+    registry.categories.push_back(this);
+    UpdateLevels(registry.log_level, registry.extra_level);
+}
+
+LogCategory::LogCategory(std::string_view name, LogLevel level)
+    : m_name(name)
+    , m_inherit_level(false)
+    , m_level(level)
+    , m_enabled_level(level)
+{
+    auto& registry = GetCategoryRegistry();
+    std::unique_lock<std::mutex> lock(registry.mutex);
+
+    registry.categories.push_back(this);
+    UpdateLevels(registry.log_level, registry.extra_level);
+}
+
+LogCategory::~LogCategory()
+{
+    auto& registry = GetCategoryRegistry();
+    std::unique_lock<std::mutex> lock(registry.mutex);
+
+    std::erase(registry.categories, this);
+}
+
+std::string_view LogCategory::GetName() const
+{
+    return m_name;
+}
+
+LogLevel LogCategory::GetLevel() const
+{
+    return m_level.load(std::memory_order_relaxed);
+}
+
+void LogCategory::SetLevel(LogLevel level)
+{
+    auto& registry = GetCategoryRegistry();
+    std::unique_lock<std::mutex> lock(registry.mutex);
+
+    m_inherit_level = false;
+    m_level.store(level, std::memory_order_relaxed);
+    UpdateLevels(registry.log_level, registry.extra_level);
+}
+
+void LogCategory::ResetLevel()
+{
+    auto& registry = GetCategoryRegistry();
+    std::unique_lock<std::mutex> lock(registry.mutex);
+
+    m_inherit_level = true;
+    UpdateLevels(registry.log_level, registry.extra_level);
+}
+
+void LogCategory::UpdateLevels(LogLevel log_level, LogLevel extra_level)
+{
+    if (m_inherit_level)
+    {
+        m_level.store(log_level, std::memory_order_relaxed);
+    }
+
+    m_enabled_level.store(
+        std::max(m_level.load(std::memory_order_relaxed), extra_level),
+        std::memory_order_relaxed);
+}
 
 Log::Log()
     : m_log_level(LogLevel::kInfo)
-    , m_log_file(nullptr)
+    , m_file_level(LogLevel::kInfo)
+    , m_sink_level(LogLevel::kFatal)
+    , m_format(LogFormat::kText)
+    , m_overflow_policy(LogOverflowPolicy::kBlock)
+    , m_timestamp_precision(TimestampPrecision::kMilliseconds)
+    , m_async(false)
+    , m_dropped_records(0)
+    , m_writer_idle(false)
+    , m_writer_stop(false)
+    , m_next_suppressed_report(0)
+    , m_sinks(std::make_shared<const SinkList>())
+    , m_flight_recorder_enabled(false)
+    , m_binary_session(0)
+    , m_last_binary_session(0)
+    , m_last_callsite_id(0)
 {
 }
 
 Log::~Log()
 {
     // Oops! Something went wrong and we ditn't close the log file properly...
-    assert(!m_log_file);
+    assert(!m_log_writer);
 }
 
 void Log::Initialize(std::string_view path, LogLevel level)
+{
+    Initialize(path, level, LogSettings{});
+}
+
+void Log::Initialize(std::string_view path, LogLevel level,
+                     const LogSettings& settings)
 {
     if (path.empty())
     {
@@ -118,10 +374,15 @@ void Log::Initialize(std::string_view path, LogLevel level)
 
     if (IsInitialized())
     {
-        if (path == m_log_path)
+        if (path == m_log_path && settings.mode == m_settings.mode &&
+            settings.format == m_settings.format)
         {
             // change the log level and continue
-            m_log_level = level;
+            m_file_level.store(level, std::memory_order_relaxed);
+            UpdateLogLevel();
+            m_settings.overflow_policy = settings.overflow_policy;
+            m_overflow_policy.store(settings.overflow_policy,
+                                    std::memory_order_relaxed);
             return;
         }
 
@@ -129,21 +390,136 @@ void Log::Initialize(std::string_view path, LogLevel level)
         Shutdown();
     }
 
-    auto file = std::fopen(path.data(), "wb");
-    if (file == nullptr)
+    std::unique_ptr<LogWriter> writer;
+    switch (settings.file_type)
+    {
+    case LogFileType::kMapped:
+        writer = std::make_unique<MappedLogWriter>(settings.mapped);
+        break;
+    case LogFileType::kVectored:
+        writer = std::make_unique<VectoredLogWriter>(settings.vectored);
+        break;
+    case LogFileType::kSharedRing:
+        writer = std::make_unique<SharedRingLogWriter>(settings.shared_ring);
+        break;
+    default:
+        writer = std::make_unique<StdioLogWriter>();
+        break;
+    }
+
+    if (settings.compression.enabled)
+    {
+        writer = std::make_unique<CompressedLogWriter>(settings.compression,
+                                                       std::move(writer));
+    }
+
+    if (!writer->Open(path))
     {
         std::printf("Unable to open log file, error code is %d", errno);
-        assert(file);
+        assert(!"unable to open log file");
         return;
     }
 
-    const std::string time = TimeToString(std::chrono::system_clock::now());
-    std::fprintf(file, "---------------- log started at %s ----------------", time.c_str());
-    std::fputs("\r\n", file);
+    std::string header;
+    if (settings.format == LogFormat::kBinary)
+    {
+        header.assign(kLogBinaryMagic, sizeof(kLogBinaryMagic));
+        AppendLogBinaryValue(header, kLogBinaryVersion);
+        AppendLogBinaryValue(header,
+            static_cast<std::uint8_t>(settings.timestamp_precision));
+        const auto calibration = GetClockCalibration();
+        AppendLogBinaryValue(header,
+                             ClockTicksToEpochNanoseconds(ReadClockTicks()));
+        AppendLogBinaryValue(header, calibration.tick_base);
+        AppendLogBinaryValue(header, calibration.time_base);
+        AppendLogBinaryValue(header, calibration.nanoseconds_per_tick);
+    }
+    else if (settings.format == LogFormat::kText)
+    {
+        const auto time = FormatTimestamp(Now(), settings.timestamp_precision);
+        header = std::format("---------------- log started at {} ----------------\r\n",
+                             time);
+    }
+
+    if (!header.empty())
+    {
+        writer->Write(header);
+        writer->Flush();
+    }
+
+    if (settings.format == LogFormat::kBinary)
+    {
+        // a writer that rolls over to a new file repeats it there
+        writer->AddPreamble(header);
+    }
 
-    m_log_file = file;
+    m_log_writer = std::move(writer);
     m_log_path = path;
-    m_log_level = level;
+    m_file_level.store(level, std::memory_order_relaxed);
+    m_settings = settings;
+    m_format.store(settings.format, std::memory_order_relaxed);
+    m_overflow_policy.store(settings.overflow_policy,
+                            std::memory_order_relaxed);
+    m_timestamp_precision.store(settings.timestamp_precision,
+                                std::memory_order_relaxed);
+    m_dropped_records.store(0, std::memory_order_relaxed);
+
+    if (settings.format == LogFormat::kBinary)
+    {
+        // call sites registered for a previous binary log are registered
+        // again, so every file carries all of its descriptors
+        if (++m_last_binary_session == 0)
+        {
+            ++m_last_binary_session;
+        }
+
+        m_last_callsite_id = 0;
+        m_binary_session.store(m_last_binary_session,
+                               std::memory_order_release);
+    }
+
+    const auto& flight_recorder = settings.flight_recorder;
+    if (flight_recorder.enabled && settings.format == LogFormat::kText)
+    {
+        if (!m_flight_recorder)
+        {
+            m_flight_recorder =
+                std::make_unique<LogFlightRecorder>(flight_recorder.ring_size);
+        }
+        else
+        {
+            m_flight_recorder->SetRingSize(flight_recorder.ring_size);
+        }
+
+        if (flight_recorder.crash_handler)
+        {
+            // the crash dump is appended to the file behind the writer's
+            // back, only a plain text file can take that
+            const bool plain_file =
+                settings.file_type == LogFileType::kStdio &&
+                !settings.compression.enabled;
+            m_flight_recorder->PrepareCrashDump(
+                plain_file ? path : std::string_view{});
+            InstallLogCrashHandler(&Log::DumpFlightRecorderOnCrash);
+        }
+
+        m_flight_recorder_enabled.store(true, std::memory_order_release);
+    }
+
+    UpdateLogLevel();
+
+    if (settings.mode == LogMode::kAsync)
+    {
+        // no producer can be using the queue of a previous log, Shutdown
+        // waited for all of them
+        m_log_queue = std::make_unique<LogQueue>(settings.queue_capacity);
+
+        m_writer_stop.store(false, std::memory_order_relaxed);
+        m_writer_idle.store(false, std::memory_order_relaxed);
+        m_writer_thread = std::thread(&Log::WriterThreadMain, this);
+
+        m_async.store(true, std::memory_order_release);
+    }
 }
 
 void Log::Shutdown()
@@ -152,58 +528,296 @@ void Log::Shutdown()
 
     if (IsInitialized())
     {
-        const std::string time = TimeToString(std::chrono::system_clock::now());
-        std::fprintf(m_log_file, "---------------- log closed at %s ----------------", time.c_str());
-        std::fputs("\r\n", m_log_file);
+        ReportSuppressed(true);
+
+        m_binary_session.store(0, std::memory_order_release);
+        m_flight_recorder_enabled.store(false, std::memory_order_release);
+
+        if (m_async.load(std::memory_order_acquire))
+        {
+            // Stop accepting new records. Producers that are already past
+            // the check finish their push first, a blocked one needs the
+            // writer thread to make room.
+            m_async.store(false);
+            while (std::any_of(m_async_producers.begin(),
+                               m_async_producers.end(),
+                               [](const ProducerCount& producers)
+                               {
+                                   return producers.count.load() != 0;
+                               }))
+            {
+                WakeWriterThread();
+                std::this_thread::yield();
+            }
 
-        std::fclose(m_log_file);
+            {
+                std::unique_lock<std::mutex> writer_lock(m_writer_mutex);
+                m_writer_stop.store(true, std::memory_order_release);
+            }
+
+            m_writer_condition.notify_one();
+            m_writer_thread.join();
+
+            // the writer drains the queue before it exits, this only picks
+            // up what it could not see in its last pass
+            const auto sinks = m_sinks.load(std::memory_order_acquire);
+            std::vector<LogQueue::OverflowRecord> overflow;
+
+            while (const LogRecord* record = m_log_queue->Peek())
+            {
+                DispatchRecord(*sinks, record->level, record->to_file,
+                               record->Text());
+                m_log_queue->Pop();
+            }
+
+            if (m_log_queue->TakeOverflow(overflow))
+            {
+                for (const auto& [level, to_file, text] : overflow)
+                {
+                    DispatchRecord(*sinks, level, to_file, text);
+                }
+            }
+        }
+
+        std::string footer;
+        if (m_settings.format == LogFormat::kBinary)
+        {
+            AppendLogBinaryValue(footer, LogBinaryEntry::kClose);
+            AppendLogBinaryValue(footer, std::uint32_t{ 0 });
+            AppendLogBinaryValue(footer, NowTicks());
+            PatchBinaryEntrySize(footer);
+        }
+        else if (m_settings.format == LogFormat::kText)
+        {
+            const auto time =
+                FormatTimestamp(Now(), m_settings.timestamp_precision);
+            footer = std::format("---------------- log closed at {} ----------------\r\n",
+                                 time);
+        }
+
+        if (!footer.empty())
+        {
+            m_log_writer->Write(footer);
+        }
+        FlushRecords(*m_sinks.load(std::memory_order_acquire));
+
+        m_log_writer->Close();
+        m_log_writer.reset();
+
+        if (m_flight_recorder)
+        {
+            m_flight_recorder->CloseCrashDump();
+        }
 
-        m_log_file = nullptr;
         m_log_path = {};
-        m_log_level = LogLevel::kInfo;
+        m_file_level.store(LogLevel::kInfo, std::memory_order_relaxed);
+        m_settings = {};
+
+        UpdateLogLevel();
     }
 }
 
 bool Log::IsInitialized() const
 {
     std::unique_lock<std::recursive_mutex> lock(m_log_mutex);
-    return m_log_file != nullptr;
+    return m_log_writer != nullptr;
 }
 
-void Log::LogMessage(LogLevel level, const char* format, ...)
+std::uint64_t Log::GetDroppedRecordCount() const
 {
-    va_list args;
-    std::vector<char> buffer;
+    return m_dropped_records.load(std::memory_order_relaxed);
+}
+
+void Log::DumpFlightRecorder()
+{
+    DumpFlightRecorder("requested");
+}
 
-    if (level > m_log_level)
+void Log::DumpFlightRecorder(std::string_view reason)
+{
+    if (!m_flight_recorder_enabled.load(std::memory_order_acquire))
     {
         return;
     }
 
-    if (!format || !format[0])
+    auto dump = std::format("---------------- flight recorder dump ({}) ----------------\r\n",
+                            reason);
+    m_flight_recorder->Collect(dump);
+    dump += "---------------- end of flight recorder dump ----------------\r\n";
+
+    WriteRecord(LogLevel::kFatal, true, dump, LogOverflowPolicy::kBlock);
+}
+
+void Log::DumpFlightRecorderOnCrash()
+{
+    if (!log.m_flight_recorder_enabled.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    // This runs in a signal handler, where the crashed thread may own any
+    // lock, the log mutex and the heap's included. The recorder copies the
+    // rings into the buffer it allocated up front and writes them to its own
+    // handle of the log file, the writer is not touched.
+    log.m_flight_recorder->WriteCrashDump(
+        "---------------- flight recorder dump (crash) ----------------\r\n",
+        "---------------- end of flight recorder dump ----------------\r\n");
+}
+
+void Log::AddSink(std::shared_ptr<LogSink> sink)
+{
+    if (!sink)
     {
         assert(!"invalid parameter passed");
         return;
     }
 
-    const auto log_level_str = LogLevelToString(level);
-    const auto date_time_str = TimeToString(std::chrono::system_clock::now());
-    const auto thread_id_str = ThreadIdToString(std::this_thread::get_id());
+    {
+        std::unique_lock<std::mutex> lock(m_sinks_mutex);
 
-    std::unique_lock<std::recursive_mutex> lock(m_log_mutex);
+        auto sinks = std::make_shared<SinkList>(
+            *m_sinks.load(std::memory_order_acquire));
+        sinks->push_back(std::move(sink));
+        m_sinks.store(std::move(sinks), std::memory_order_release);
+    }
 
-    if (!IsInitialized())
+    UpdateLogLevel();
+}
+
+void Log::RemoveSink(const std::shared_ptr<LogSink>& sink)
+{
     {
-        return;
+        std::unique_lock<std::mutex> lock(m_sinks_mutex);
+
+        auto sinks = std::make_shared<SinkList>(
+            *m_sinks.load(std::memory_order_acquire));
+        std::erase(*sinks, sink);
+        m_sinks.store(std::move(sinks), std::memory_order_release);
     }
 
-    std::fprintf(m_log_file, "[%s][%s][%s] ",
-        date_time_str.c_str(), log_level_str.c_str(), thread_id_str.c_str());
+    // the writer may still be holding the old list, so the sink can get a
+    // few more records after this returns
+    UpdateLogLevel();
+}
+
+void Log::UpdateLogLevel()
+{
+    std::unique_lock<std::mutex> lock(m_sinks_mutex);
 
+    auto sink_level = LogLevel::kFatal;
+
+    if (m_binary_session.load(std::memory_order_acquire) == 0)
+    {
+        for (const auto& sink : *m_sinks.load(std::memory_order_acquire))
+        {
+            sink_level = std::max(sink_level, sink->GetLevel());
+        }
+    }
+
+    const auto extra_level =
+        m_flight_recorder_enabled.load(std::memory_order_acquire)
+            ? LogLevel::kTrace
+            : sink_level;
+    const auto file_level = m_file_level.load(std::memory_order_relaxed);
+
+    m_sink_level.store(sink_level, std::memory_order_relaxed);
+    m_log_level.store(std::max(file_level, extra_level),
+                      std::memory_order_relaxed);
+
+    auto& registry = GetCategoryRegistry();
+    std::unique_lock<std::mutex> registry_lock(registry.mutex);
+
+    registry.log_level = file_level;
+    registry.extra_level = extra_level;
+
+    for (auto category : registry.categories)
+    {
+        category->UpdateLevels(file_level, extra_level);
+    }
+}
+
+bool Log::SetCategoryLevel(std::string_view name, LogLevel level)
+{
+    auto& registry = GetCategoryRegistry();
+    std::unique_lock<std::mutex> lock(registry.mutex);
+
+    bool found = false;
+
+    // the same category may be defined in several modules
+    for (auto category : registry.categories)
+    {
+        if (category->GetName() == name)
+        {
+            category->m_inherit_level = false;
+            category->m_level.store(level, std::memory_order_relaxed);
+            category->UpdateLevels(registry.log_level, registry.extra_level);
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+template <class Config>
+void Log::ApplyCategoryConfig(const Config& config)
+{
+    static_assert(KeyValuesReader<Config>);
+
+    for (const auto& entry : config)
+    {
+        const auto name = entry.GetKeyView();
+        const auto value = entry.GetString("/", "");
+
+        LogLevel level = LogLevel::kInfo;
+        const bool inherit = value == "default";
+
+        if (!inherit && !LogLevelFromString(value, level))
+        {
+            HOOHAHA_LOG_WARN("Invalid level '{}' for log category '{}'",
+                             value, name);
+            continue;
+        }
+
+        auto& registry = GetCategoryRegistry();
+        std::unique_lock<std::mutex> lock(registry.mutex);
+
+        bool found = false;
+
+        for (auto category : registry.categories)
+        {
+            if (category->GetName() == name)
+            {
+                category->m_inherit_level = inherit;
+                category->m_level.store(level, std::memory_order_relaxed);
+                category->UpdateLevels(registry.log_level,
+                                       registry.extra_level);
+                found = true;
+            }
+        }
+
+        if (!found)
+        {
+            lock.unlock();
+            HOOHAHA_LOG_WARN("Unknown log category '{}'", name);
+        }
+    }
+}
+
+void Log::ConfigureCategories(const KeyValues& config)
+{
+    ApplyCategoryConfig(config);
+}
+
+void Log::ConfigureCategories(const BinaryKeyValues& config)
+{
+    ApplyCategoryConfig(config);
+}
+
+void Log::LogMessage(LogLevel level, const char* format, ...)
+{
+    va_list args;
     va_start(args, format);
-    std::vfprintf(m_log_file, format, args);
-    std::fputs("\r\n", m_log_file);
-    std::fflush(m_log_file);
+    LogMessageV(nullptr, 0, level, format, args);
     va_end(args);
 }
 
@@ -211,9 +825,15 @@ void Log::LogMessage(const char* source, int line,
                      LogLevel level, const char* format, ...)
 {
     va_list args;
-    std::vector<char> buffer;
+    va_start(args, format);
+    LogMessageV(source, line, level, format, args);
+    va_end(args);
+}
 
-    if (level > m_log_level)
+void Log::LogMessageV(const char* source, int line, LogLevel level,
+                      const char* format, va_list args)
+{
+    if (!IsEnabled(level))
     {
         return;
     }
@@ -224,27 +844,631 @@ void Log::LogMessage(const char* source, int line,
         return;
     }
 
-    va_start(args, format);
-    int length = _vscprintf(format, args);
+    WriteMessage(nullptr, level, source, line, FormatMessageV(format, args));
+}
+
+void Log::WriteFields(LogLevel level, std::string_view message,
+                      std::initializer_list<LogField> fields)
+{
+    WriteFields(nullptr, 0, level, message, fields);
+}
+
+void Log::WriteFields(const char* source, int line, LogLevel level,
+                      std::string_view message,
+                      std::initializer_list<LogField> fields)
+{
+    if (!IsEnabled(level))
+    {
+        return;
+    }
+
+    WriteMessage(nullptr, level, source, line, message,
+                 std::span<const LogField>(fields.begin(), fields.size()));
+}
+
+void Log::ReportSuppressed(bool all)
+{
+    auto& registry = GetRateLimiterRegistry();
+    const auto now = SteadyNanoseconds();
+
+    std::vector<std::pair<LogRateLimiter*, std::uint64_t>> reports;
+    {
+        std::unique_lock<std::mutex> lock(registry.mutex);
+
+        for (auto limiter : registry.limiters)
+        {
+            // limiters without an interval are only reported on Shutdown
+            const auto next_time =
+                limiter->next_time.load(std::memory_order_relaxed);
+            if (!all && (next_time == 0 || now < next_time))
+            {
+                continue;
+            }
+
+            if (const auto count = limiter->TakeSuppressed())
+            {
+                reports.emplace_back(limiter, count);
+            }
+        }
+    }
+
+    // written without the registry lock, the records may take the log mutex
+    for (const auto& [limiter, count] : reports)
+    {
+        WriteSuppressed(limiter->callsite, count);
+    }
+}
+
+void Log::ReportSuppressedIfDue()
+{
+    if (!GetRateLimiterRegistry().has_limiters.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    const auto now = SteadyNanoseconds();
+
+    // only the thread that moves the check forward does it
+    auto next = m_next_suppressed_report.load(std::memory_order_relaxed);
+    if (now < next ||
+        !m_next_suppressed_report.compare_exchange_strong(
+            next,
+            now + std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      kSuppressedReportInterval).count(),
+            std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    ReportSuppressed(false);
+}
+
+void Log::RecalibrateClockIfDue()
+{
+    if (!RecalibrateClock() ||
+        m_format.load(std::memory_order_relaxed) != LogFormat::kBinary)
+    {
+        return;
+    }
+
+    // binary entries are converted with the calibration written last
+    const auto calibration = GetClockCalibration();
+
+    std::string entry;
+    AppendLogBinaryValue(entry, LogBinaryEntry::kCalibration);
+    AppendLogBinaryValue(entry, std::uint32_t{ 0 });
+    AppendLogBinaryValue(entry, calibration.tick_base);
+    AppendLogBinaryValue(entry, calibration.time_base);
+    AppendLogBinaryValue(entry, calibration.nanoseconds_per_tick);
+    PatchBinaryEntrySize(entry);
+
+    WriteRecord(LogLevel::kInfo, true, entry, LogOverflowPolicy::kBlock);
+}
+
+void Log::WriteSuppressed(LogCallsite& callsite, std::uint64_t count)
+{
+    const bool enabled = callsite.category
+                             ? callsite.category->IsEnabled(callsite.level)
+                             : IsEnabled(callsite.level);
+    if (count == 0 || !enabled)
+    {
+        return;
+    }
+
+    // not t_message_buffer, a sync write may get here while a message in
+    // it waits for its thread name to be written
+    const auto message =
+        std::format("suppressed {} similar messages", count);
+
+    WriteMessage(callsite.category, callsite.level, callsite.source,
+                 callsite.line, message);
+}
+
+void Log::WriteFormatted(const LogCategory* category, LogLevel level,
+                         const char* source, int line,
+                         std::string_view format, std::format_args args,
+                         std::span<const LogField> fields)
+{
+    // binary and JSON records encode the message, so it is formatted on
+    // its own first
+    const bool text = m_binary_session.load(std::memory_order_acquire) == 0 &&
+                      m_format.load(std::memory_order_relaxed) ==
+                          LogFormat::kText;
+
+    auto& buffer = text ? t_record_buffer : t_message_buffer;
+    buffer.clear();
+
+    if (text)
+    {
+        BeginTextRecord(buffer, level);
+    }
+
+    const auto message_begin = buffer.size();
+
+    try
+    {
+        std::vformat_to(std::back_inserter(buffer), format, args);
+    }
+    catch (const std::exception& exception)
+    {
+        // the format string is checked at compile time, so this can only be
+        // a bad dynamic width/precision or an allocation failure
+        buffer.resize(message_begin);
+        buffer += exception.what();
+    }
+
+    if (!text)
+    {
+        WriteMessage(category, level, source, line, buffer, fields);
+        return;
+    }
+
+    EndTextRecord(buffer, source, line, fields);
+    CommitRecord(category, level, buffer);
+}
+
+void Log::WriteMessage(const LogCategory* category, LogLevel level,
+                       const char* source, int line, std::string_view message,
+                       std::span<const LogField> fields)
+{
+    auto& record = t_record_buffer;
+
+    if (const auto session = m_binary_session.load(std::memory_order_acquire))
+    {
+        // before the record buffer is filled, writing the name may reuse it
+        RegisterThreadName(session);
+
+        record.clear();
+        AppendLogBinaryValue(record, fields.empty()
+                                         ? LogBinaryEntry::kMessage
+                                         : LogBinaryEntry::kStructured);
+        AppendLogBinaryValue(record, std::uint32_t{ 0 });
+        AppendLogBinaryValue(record, static_cast<std::uint8_t>(level));
+        AppendLogBinaryValue(record, NowTicks());
+        AppendLogBinaryValue(record,
+                             static_cast<std::uint64_t>(CurrentThreadId()));
+        AppendLogBinaryValue(record, static_cast<std::int32_t>(line));
+        AppendLogBinaryString(record, source ? source : "");
+        AppendLogBinaryString(record, message);
+        if (!fields.empty())
+        {
+            EncodeLogFields(record, fields);
+        }
+        CommitBinaryRecord(level, record);
+        return;
+    }
+
+    record.clear();
+
+    if (m_format.load(std::memory_order_relaxed) == LogFormat::kJson)
+    {
+        FormatJsonRecord(record, level, source, line, message, fields);
+    }
+    else
+    {
+        BeginTextRecord(record, level);
+        record += message;
+        EndTextRecord(record, source, line, fields);
+    }
+
+    CommitRecord(category, level, record);
+}
+
+void Log::BeginTextRecord(std::string& record, LogLevel level) const
+{
+    const auto log_level_str = LogLevelToString(level);
+    const auto date_time_str = FormatTimestamp(
+        Now(), m_timestamp_precision.load(std::memory_order_relaxed));
+    const auto thread_tag_str = CurrentThreadTag();
+
+    std::format_to(std::back_inserter(record), "[{}][{}][{}] ", date_time_str,
+                   log_level_str, thread_tag_str);
+}
+
+void Log::EndTextRecord(std::string& record, const char* source, int line,
+                        std::span<const LogField> fields) const
+{
+    AppendLogFieldsText(record, fields);
 
     if (source && source[0])
     {
-        const int source_length = static_cast<int>(std::strlen(source));
-        const int line_length = 16;
-        length += source_length + line_length;
-        buffer.resize(length);
+        std::format_to(std::back_inserter(record), " : {}({})", source,
+                       line);
     }
 
-    int bytes_written = std::vsnprintf(&buffer[0], length, format, args);
-    va_end(args);
+    record += "\r\n";
+}
+
+void Log::CommitRecord(const LogCategory* category, LogLevel level,
+                       std::string_view record)
+{
+    if (m_flight_recorder_enabled.load(std::memory_order_acquire))
+    {
+        m_flight_recorder->Record(record);
+    }
+
+    // the file filters by the category level instead of its own one
+    const auto file_level = category
+                                ? category->GetLevel()
+                                : m_file_level.load(std::memory_order_relaxed);
+    const bool to_file = level <= file_level;
+
+    // only the flight recorder wants records the file and the sinks don't
+    if (to_file || level <= m_sink_level.load(std::memory_order_relaxed))
+    {
+        WriteRecord(level, to_file, record);
+        CountMessage(level);
+    }
+
+    if (level == LogLevel::kFatal)
+    {
+        DumpFlightRecorder("fatal error");
+    }
+}
+
+void Log::FormatJsonRecord(std::string& record, LogLevel level,
+                           const char* source, int line,
+                           std::string_view message,
+                           std::span<const LogField> fields) const
+{
+    auto level_str = LogLevelToString(level);
+    while (!level_str.empty() && level_str.back() == ' ')
+    {
+        level_str.remove_suffix(1);
+    }
+
+    record += "{\"time\":\"";
+    record += FormatTimestamp(
+        Now(), m_timestamp_precision.load(std::memory_order_relaxed));
+    record += "\",\"level\":\"";
+    record += level_str;
+    record += "\",\"thread\":";
+    std::format_to(std::back_inserter(record), "{}", CurrentThreadId());
+
+    const auto thread_name = CurrentThreadName();
+    if (!thread_name.empty())
+    {
+        record += ",\"thread_name\":";
+        AppendLogJsonString(record, thread_name);
+    }
+
+    record += ",\"message\":";
+    AppendLogJsonString(record, message);
 
     if (source && source[0])
     {
-        format = " : %s(%d)";
-        std::snprintf(&buffer[bytes_written], length - bytes_written, format, source, line);
+        record += ",\"source\":";
+        AppendLogJsonString(record, source);
+        std::format_to(std::back_inserter(record), ",\"line\":{}", line);
+    }
+
+    if (!fields.empty())
+    {
+        record += ",\"fields\":{";
+        AppendLogFieldsJson(record, fields);
+        record += '}';
+    }
+
+    record += "}\r\n";
+}
+
+std::string& Log::BeginBinaryRecord(LogCallsite& callsite,
+                                    std::string_view format,
+                                    std::size_t argument_count)
+{
+    const auto session = m_binary_session.load(std::memory_order_acquire);
+
+    auto id = callsite.id.load(std::memory_order_acquire);
+    if ((id >> 32) != session)
+    {
+        RegisterCallsite(callsite, format, session);
+        id = callsite.id.load(std::memory_order_acquire);
     }
 
-    LogMessage(level, &buffer[0]);
+    RegisterThreadName(session);
+
+    auto& record = t_record_buffer;
+    record.clear();
+
+    AppendLogBinaryValue(record, LogBinaryEntry::kRecord);
+    AppendLogBinaryValue(record, std::uint32_t{ 0 });
+    AppendLogBinaryValue(record, static_cast<std::uint32_t>(id));
+    AppendLogBinaryValue(record, NowTicks());
+    AppendLogBinaryValue(record,
+                         static_cast<std::uint64_t>(CurrentThreadId()));
+    AppendLogBinaryValue(record, static_cast<std::uint8_t>(argument_count));
+
+    return record;
+}
+
+void Log::CommitBinaryRecord(LogLevel level, std::string& record)
+{
+    if (m_binary_session.load(std::memory_order_acquire) == 0)
+    {
+        // the log was closed or switched to text while we were encoding
+        return;
+    }
+
+    // a binary record gets this far only when the file wants it
+    PatchBinaryEntrySize(record);
+    WriteRecord(level, true, record);
+    CountMessage(level);
+}
+
+void Log::RegisterCallsite(LogCallsite& callsite, std::string_view format,
+                           std::uint32_t session)
+{
+    std::unique_lock<std::recursive_mutex> lock(m_log_mutex);
+
+    if (session == 0 ||
+        session != m_binary_session.load(std::memory_order_relaxed) ||
+        (callsite.id.load(std::memory_order_relaxed) >> 32) == session)
+    {
+        // the log has been reopened or another thread was first
+        return;
+    }
+
+    const std::uint32_t id = ++m_last_callsite_id;
+
+    std::string descriptor;
+    AppendLogBinaryValue(descriptor, LogBinaryEntry::kDescriptor);
+    AppendLogBinaryValue(descriptor, std::uint32_t{ 0 });
+    AppendLogBinaryValue(descriptor, id);
+    AppendLogBinaryValue(descriptor, static_cast<std::uint8_t>(callsite.level));
+    AppendLogBinaryValue(descriptor, static_cast<std::int32_t>(callsite.line));
+    AppendLogBinaryString(descriptor, format);
+    AppendLogBinaryString(descriptor, callsite.source ? callsite.source : "");
+    PatchBinaryEntrySize(descriptor);
+
+    // a lost descriptor would make every record of the call site unreadable,
+    // so it is never dropped
+    WriteRecord(callsite.level, true, descriptor, LogOverflowPolicy::kBlock);
+
+    callsite.id.store((static_cast<std::uint64_t>(session) << 32) | id,
+                      std::memory_order_release);
+}
+
+void Log::RegisterThreadName(std::uint32_t session)
+{
+    const auto name = CurrentThreadName();
+
+    // unnamed threads are printed by their number alone
+    if (name == t_binary_thread_name &&
+        (session == t_binary_thread_session || name.empty()))
+    {
+        t_binary_thread_session = session;
+        return;
+    }
+
+    t_binary_thread_session = session;
+    t_binary_thread_name = name;
+
+    std::string entry;
+    AppendLogBinaryValue(entry, LogBinaryEntry::kThreadName);
+    AppendLogBinaryValue(entry, std::uint32_t{ 0 });
+    AppendLogBinaryValue(entry,
+                         static_cast<std::uint64_t>(CurrentThreadId()));
+    AppendLogBinaryString(entry, name);
+    PatchBinaryEntrySize(entry);
+
+    // like a descriptor it is never dropped
+    WriteRecord(LogLevel::kInfo, true, entry, LogOverflowPolicy::kBlock);
+}
+
+void Log::WriteRecord(LogLevel level, bool to_file, std::string_view text)
+{
+    WriteRecord(level, to_file, text,
+                m_overflow_policy.load(std::memory_order_relaxed));
+}
+
+void Log::WriteRecord(LogLevel level, bool to_file, std::string_view text,
+                      LogOverflowPolicy overflow_policy)
+{
+    if (t_log_writer_thread)
+    {
+        // the writer thread would wait on its own queue
+        const auto sinks = m_sinks.load(std::memory_order_acquire);
+        DispatchRecord(*sinks, level, to_file, text);
+        FlushRecords(*sinks);
+        return;
+    }
+
+    // Pairs with Shutdown clearing m_async and then waiting for the counts
+    // to drop, both sides are sequentially consistent so either Shutdown
+    // sees this producer or the producer sees the log going synchronous.
+    // The count of the stripe is rarely shared with another thread.
+    auto& producers =
+        m_async_producers[t_producer_stripe % kProducerStripes].count;
+    producers.fetch_add(1);
+
+    if (m_async.load())
+    {
+        if (!m_log_queue->TryPush(level, to_file, text))
+        {
+            switch (overflow_policy)
+            {
+            case LogOverflowPolicy::kBlock:
+                // Shutdown keeps the writer thread running until we are done
+                while (!m_log_queue->TryPush(level, to_file, text))
+                {
+                    WakeWriterThread();
+                    std::this_thread::yield();
+                }
+                break;
+            case LogOverflowPolicy::kDrop:
+                m_dropped_records.fetch_add(1, std::memory_order_relaxed);
+                producers.fetch_sub(1, std::memory_order_release);
+                return;
+            case LogOverflowPolicy::kGrow:
+                m_log_queue->PushOverflow(level, to_file, text);
+                break;
+            }
+        }
+
+        WakeWriterThread();
+        producers.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+
+    producers.fetch_sub(1, std::memory_order_release);
+
+    std::unique_lock<std::recursive_mutex> lock(m_log_mutex);
+
+    if (m_async.load(std::memory_order_acquire))
+    {
+        // an async log was opened while we were waiting for the mutex, its
+        // writer thread owns the file now
+        lock.unlock();
+        WriteRecord(level, to_file, text, overflow_policy);
+        return;
+    }
+
+    if (!IsInitialized())
+    {
+        return;
+    }
+
+    const auto sinks = m_sinks.load(std::memory_order_acquire);
+
+    DispatchRecord(*sinks, level, to_file, text);
+    FlushRecords(*sinks);
+
+    // the async writer thread does this on its own
+    lock.unlock();
+    ReportSuppressedIfDue();
+    RecalibrateClockIfDue();
+}
+
+void Log::DispatchRecord(const SinkList& sinks, LogLevel level,
+                         bool to_file, std::string_view text)
+{
+    if (to_file)
+    {
+        m_log_writer->Write(text);
+
+        // every file of a binary log needs the descriptors and thread names
+        // of its records
+        if (m_settings.format == LogFormat::kBinary && !text.empty() &&
+            (static_cast<LogBinaryEntry>(text[0]) ==
+                 LogBinaryEntry::kDescriptor ||
+             static_cast<LogBinaryEntry>(text[0]) ==
+                 LogBinaryEntry::kThreadName))
+        {
+            m_log_writer->AddPreamble(text);
+        }
+
+        // errors reach the file before the batch is over
+        if (level <= LogLevel::kError)
+        {
+            m_log_writer->Flush();
+        }
+    }
+
+    if (m_settings.format == LogFormat::kBinary)
+    {
+        return;
+    }
+
+    for (const auto& sink : sinks)
+    {
+        if (sink->Accepts(level))
+        {
+            sink->Write(level, text);
+        }
+    }
+}
+
+void Log::FlushRecords(const SinkList& sinks)
+{
+    m_log_writer->EndBatch();
+
+    for (const auto& sink : sinks)
+    {
+        sink->Flush();
+    }
+}
+
+void Log::WakeWriterThread()
+{
+    // Producers only pay for the notification when the writer is actually
+    // sleeping. A wakeup that races with the writer going idle is picked up
+    // by the writer's timed wait.
+    if (m_writer_idle.load(std::memory_order_relaxed) &&
+        m_writer_idle.exchange(false, std::memory_order_acq_rel))
+    {
+        m_writer_condition.notify_one();
+    }
+}
+
+void Log::WriterThreadMain()
+{
+    SetCurrentThreadName("log writer");
+    t_log_writer_thread = true;
+
+    std::vector<LogQueue::OverflowRecord> overflow;
+
+    for (;;)
+    {
+        const bool stop = m_writer_stop.load(std::memory_order_acquire);
+        const auto sinks = m_sinks.load(std::memory_order_acquire);
+        std::size_t pending = 0;
+
+        // async producers leave the quiet rate limited call sites and the
+        // clock to us
+        ReportSuppressedIfDue();
+        RecalibrateClockIfDue();
+
+        // records go to the writer one by one, so a writer that rolls files
+        // never splits one, and are flushed once per batch
+        while (const LogRecord* record = m_log_queue->Peek())
+        {
+            DispatchRecord(*sinks, record->level, record->to_file,
+                           record->Text());
+            m_log_queue->Pop();
+
+            if (++pending == kWriterBatchRecords)
+            {
+                FlushRecords(*sinks);
+                pending = 0;
+            }
+        }
+
+        if (m_log_queue->TakeOverflow(overflow))
+        {
+            for (const auto& [level, to_file, text] : overflow)
+            {
+                DispatchRecord(*sinks, level, to_file, text);
+            }
+
+            pending += overflow.size();
+            overflow.clear();
+        }
+
+        if (pending > 0)
+        {
+            FlushRecords(*sinks);
+            continue;
+        }
+
+        if (stop)
+        {
+            break;
+        }
+
+        // lets a batching writer check its time threshold while idle
+        m_log_writer->EndBatch();
+
+        std::unique_lock<std::mutex> lock(m_writer_mutex);
+        m_writer_idle.store(true, std::memory_order_release);
+
+        if (m_log_queue->IsEmpty() &&
+            !m_writer_stop.load(std::memory_order_acquire))
+        {
+            m_writer_condition.wait_for(lock, kWriterIdleTimeout);
+        }
+
+        m_writer_idle.store(false, std::memory_order_release);
+    }
 }
 
 }
@@ -19,23 +19,240 @@
 #ifndef HOOHAHA_CORE_LOG_H_
 #define HOOHAHA_CORE_LOG_H_
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
 #include <cstdio>
+#include <format>
+#include <initializer_list>
+#include <memory>
 #include <mutex>
+#include <span>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "log_binary.h"
+#include "log_compression.h"
+#include "log_fields.h"
+#include "log_flight_recorder.h"
+#include "log_shared_ring.h"
+#include "log_writer.h"
+#include "timestamp.h"
+
+// LogLevel values usable in preprocessor conditions
+#define HOOHAHA_LOG_LEVEL_FATAL     0
+#define HOOHAHA_LOG_LEVEL_ERROR     1
+#define HOOHAHA_LOG_LEVEL_WARNING   2
+#define HOOHAHA_LOG_LEVEL_INFO      3
+#define HOOHAHA_LOG_LEVEL_DEBUG     4
+#define HOOHAHA_LOG_LEVEL_TRACE     5
 
 namespace core
 {
 
 enum class LogLevel
 {
-    kFatal,
-    kError,
-    kWarning,
-    kInfo,
-    kDebug,
-    kTrace
+    kFatal = HOOHAHA_LOG_LEVEL_FATAL,
+    kError = HOOHAHA_LOG_LEVEL_ERROR,
+    kWarning = HOOHAHA_LOG_LEVEL_WARNING,
+    kInfo = HOOHAHA_LOG_LEVEL_INFO,
+    kDebug = HOOHAHA_LOG_LEVEL_DEBUG,
+    kTrace = HOOHAHA_LOG_LEVEL_TRACE
+};
+
+enum class LogMode
+{
+    // every message is written and flushed by the calling thread
+    kSync,
+    // messages are queued and written in batches by a background thread
+    kAsync
+};
+
+// What an async producer does when the record queue is full
+enum class LogOverflowPolicy
+{
+    // wait for the writer thread to free a slot
+    kBlock,
+    // discard the record and count it, see Log::GetDroppedRecordCount
+    kDrop,
+    // keep the record in an unbounded overflow list, the records after it
+    // follow it there until the writer thread has caught up
+    kGrow
+};
+
+enum class LogFormat
+{
+    // human readable lines, formatted by the logging thread
+    kText,
+    // raw call site ids and argument values, see log_binary.h and the
+    // log_decoder tool
+    kBinary,
+    // one JSON object per line with time, level, thread, message, source,
+    // line and the fields of structured records, no header or footer line
+    kJson
 };
 
+enum class LogFileType
+{
+    // fopen/fwrite, flushed after every record or batch
+    kStdio,
+    // preallocated, memory mapped, rolling segments, see MappedLogWriter
+    kMapped,
+    // staged and written with writev on a size or time threshold, see
+    // VectoredLogWriter
+    kVectored,
+    // shared memory ring drained by a collector process, the path is the
+    // name of the ring, see SharedRingLogWriter
+    kSharedRing
+};
+
+struct LogSettings
+{
+    LogMode                   mode = LogMode::kSync;
+    LogFormat                 format = LogFormat::kText;
+    LogOverflowPolicy         overflow_policy = LogOverflowPolicy::kBlock;
+    std::size_t               queue_capacity = 4096;
+    TimestampPrecision        timestamp_precision = TimestampPrecision::kMilliseconds;
+    LogFileType               file_type = LogFileType::kStdio;
+    MappedLogSettings         mapped;
+    VectoredLogSettings       vectored;
+    SharedRingLogSettings     shared_ring;
+    // frames the file, text or binary, see CompressedLogWriter
+    LogCompressionSettings    compression;
+    // text format only
+    LogFlightRecorderSettings flight_recorder;
+};
+
+class LogCategory;
+
+// Everything about a HOOHAHA_LOG_* call site that never changes. Every call
+// site owns a static instance. In binary mode it is registered on first use
+// and the log only references it by id afterwards.
+struct LogCallsite
+{
+    constexpr LogCallsite(LogLevel callsite_level, const char* callsite_source,
+                          int callsite_line,
+                          const LogCategory* callsite_category = nullptr)
+        : level(callsite_level)
+        , source(callsite_source)
+        , line(callsite_line)
+        , category(callsite_category)
+        , id(0)
+    {
+    }
+
+    const LogLevel              level;
+    const char* const           source;
+    const int                   line;
+    // null for messages filtered by the log level
+    const LogCategory* const    category;
+
+    // binary log session in the upper half, descriptor id in the lower half
+    std::atomic<std::uint64_t>  id;
+};
+
+struct LogRateLimiter;
+
+// Adds a limiter to the ones whose suppressed messages the log reports on
+// its own, see LogRateLimiter::TakeSuppressed
+void RegisterLogRateLimiter(LogRateLimiter& limiter);
+
+// Static state of a HOOHAHA_LOG_EVERY_N, HOOHAHA_LOG_FIRST_N or
+// HOOHAHA_LOG_EVERY_MS call site. Deciding whether a message goes out is a
+// couple of relaxed atomic operations, nothing is formatted for the messages
+// that are suppressed.
+struct LogRateLimiter
+{
+    constexpr explicit LogRateLimiter(LogCallsite& limiter_callsite)
+        : callsite(limiter_callsite)
+        , count(0)
+        , next_time(0)
+        , suppressed(0)
+        , registered(false)
+    {
+    }
+
+    // true for every n-th call
+    inline bool EveryN(std::uint64_t n);
+    // true for the first n calls only, the rest are not counted
+    inline bool FirstN(std::uint64_t n);
+    // true at most once per interval
+    inline bool EveryInterval(std::chrono::milliseconds interval);
+
+    // How many calls were suppressed since the last message that went out.
+    // The message that goes out takes the count, the log takes the counts
+    // of call sites that went quiet once their interval is over, and all of
+    // them on Shutdown.
+    inline std::uint64_t TakeSuppressed();
+
+    LogCallsite&                callsite;
+    std::atomic<std::uint64_t>  count;
+    // steady clock nanoseconds before which messages are suppressed, zero
+    // for limiters without an interval
+    std::atomic<std::int64_t>   next_time;
+    std::atomic<std::uint64_t>  suppressed;
+    std::atomic<bool>           registered;
+
+private:
+    inline void Suppress();
+};
+
+// Named group of messages with a level of its own, e.g. everything logged
+// by KeyValues. Define one per subsystem with HOOHAHA_LOG_CATEGORY and log
+// into it with HOOHAHA_LOG_CAT. The category level is used instead of the log
+// level for its messages. A category defined without a level follows the log
+// level until one is set.
+class LogCategory final
+{
+public:
+    explicit LogCategory(std::string_view name);
+    LogCategory(std::string_view name, LogLevel level);
+    LogCategory(const LogCategory&) = delete;
+    LogCategory(LogCategory&&) = delete;
+    ~LogCategory();
+
+    std::string_view GetName() const;
+
+    LogLevel GetLevel() const;
+    void SetLevel(LogLevel level);
+    // follow the log level again
+    void ResetLevel();
+
+    // A single relaxed load. Also true for levels that only the sinks or the
+    // flight recorder want, see Log::IsEnabled.
+    inline bool IsEnabled(LogLevel level) const;
+
+    LogCategory& operator=(const LogCategory&) = delete;
+    LogCategory& operator=(LogCategory&&) = delete;
+
+private:
+    friend class Log;
+
+    void UpdateLevels(LogLevel log_level, LogLevel extra_level);
+
+private:
+    const std::string      m_name;
+    // true while the category follows the log level, guarded by the
+    // category registry mutex
+    bool                   m_inherit_level;
+    std::atomic<LogLevel>  m_level;
+    std::atomic<LogLevel>  m_enabled_level;
+};
+
+std::string_view LogLevelToString(LogLevel level);
+// Accepts the names printed by LogLevelToString in any case, and "warning"
+bool LogLevelFromString(std::string_view str, LogLevel& level);
+
+class BinaryKeyValues;
+class KeyValues;
+class LogQueue;
+class LogSink;
+
 class Log final
 {
 public:
@@ -45,56 +262,546 @@ public:
     ~Log();
 
     void Initialize(std::string_view path, LogLevel level);
+    void Initialize(std::string_view path, LogLevel level,
+                    const LogSettings& settings);
     void Shutdown();
 
     bool IsInitialized() const;
 
+    // Cheap enough to be called before any argument of a message is
+    // evaluated, see HOOHAHA_LOG
+    inline bool IsEnabled(LogLevel level) const;
+
+    std::uint64_t GetDroppedRecordCount() const;
+
+    // Writes the records kept by the flight recorder, see
+    // LogSettings::flight_recorder. Done automatically for kFatal messages
+    // and on crashes.
+    void DumpFlightRecorder();
+
+    // Sends every record accepted by the sink's level to it as well. Sinks
+    // can be added and removed at any time, producers never wait for it. In
+    // async mode a sink gets the records the writer thread handles while
+    // the sink is attached.
+    // Messages more verbose than the log level are enabled when a sink
+    // accepts them, but the log file still filters by the log level.
+    void AddSink(std::shared_ptr<LogSink> sink);
+    void RemoveSink(const std::shared_ptr<LogSink>& sink);
+
+    // Returns false when no category with this name exists
+    bool SetCategoryLevel(std::string_view name, LogLevel level);
+    // Sets the levels of the categories listed in a block like
+    //
+    //     log_categories
+    //     {
+    //         kv = debug
+    //         render = default
+    //     }
+    //
+    // where "default" makes a category follow the log level again. The block
+    // may come from a text document or a compiled one.
+    void ConfigureCategories(const KeyValues& config);
+    void ConfigureCategories(const BinaryKeyValues& config);
+
     Log& operator=(Log&&) = delete;
     Log& operator=(const Log&) = delete;
 
+    // printf style messages
     void LogMessage(LogLevel level, const char* format, ...);
     void LogMessage(const char* source, int line,
                     LogLevel level, const char* format, ...);
 
+    // std::format style messages, the format string is checked against the
+    // arguments at compile time
+    template <LogLevel level, class... Args>
+    void Write(std::format_string<Args...> format, Args&&... args);
+    template <LogLevel level, class... Args>
+    void WriteAt(const char* source, int line,
+                 std::format_string<Args...> format, Args&&... args);
+    template <class... Args>
+    void Write(LogCallsite& callsite,
+               std::format_string<Args...> format, Args&&... args);
+
+    // Structured records, a message with typed fields, see LogField and
+    // HOOHAHA_LOG_FIELDS. Text logs get the fields as " name=value" pairs
+    // after the message, JSON logs as a "fields" object and binary logs as
+    // typed values. Fields are encoded straight into the per-thread record
+    // buffer, nothing is allocated once it has grown to fit.
+    void WriteFields(LogLevel level, std::string_view message,
+                     std::initializer_list<LogField> fields);
+    void WriteFields(const char* source, int line, LogLevel level,
+                     std::string_view message,
+                     std::initializer_list<LogField> fields);
+
+    // A message of a rate limited call site, with the number of messages
+    // suppressed before it as a "suppressed" field
+    template <class... Args>
+    void WriteLimited(LogRateLimiter& limiter,
+                      std::format_string<Args...> format, Args&&... args);
+
+private:
+    using SinkList = std::vector<std::shared_ptr<LogSink>>;
+
+    // producers between checking m_async and leaving the queue, counted per
+    // stripe so that threads do not share a cache line
+    static constexpr std::size_t kProducerStripes = 16;
+
+    struct alignas(64) ProducerCount
+    {
+        std::atomic<std::size_t> count{ 0 };
+    };
+
+    void LogMessageV(const char* source, int line, LogLevel level,
+                     const char* format, va_list args);
+
+    // both ConfigureCategories, for any KeyValuesReader
+    template <class Config>
+    void ApplyCategoryConfig(const Config& config);
+
+    template <class... Args>
+    void WriteCallsite(LogCallsite& callsite, std::span<const LogField> fields,
+                       std::format_string<Args...> format, Args&&... args);
+
+    void WriteFormatted(const LogCategory* category, LogLevel level,
+                        const char* source, int line,
+                        std::string_view format, std::format_args args,
+                        std::span<const LogField> fields = {});
+    void WriteMessage(const LogCategory* category, LogLevel level,
+                      const char* source, int line, std::string_view message,
+                      std::span<const LogField> fields = {});
+    void FormatJsonRecord(std::string& record, LogLevel level,
+                          const char* source, int line,
+                          std::string_view message,
+                          std::span<const LogField> fields) const;
+    // a text record is the prefix, the message and the suffix, so a message
+    // can be formatted right into the record between them
+    void BeginTextRecord(std::string& record, LogLevel level) const;
+    void EndTextRecord(std::string& record, const char* source, int line,
+                       std::span<const LogField> fields) const;
+    void CommitRecord(const LogCategory* category, LogLevel level,
+                      std::string_view record);
+
+    std::string& BeginBinaryRecord(LogCallsite& callsite,
+                                   std::string_view format,
+                                   std::size_t argument_count);
+    void CommitBinaryRecord(LogLevel level, std::string& record);
+    void RegisterCallsite(LogCallsite& callsite, std::string_view format,
+                          std::uint32_t session);
+    // writes a kThreadName entry when the calling thread is new to the
+    // binary log or has been renamed
+    void RegisterThreadName(std::uint32_t session);
+
+    void DumpFlightRecorder(std::string_view reason);
+    static void DumpFlightRecorderOnCrash();
+
+    // "suppressed N similar messages" for the rate limited call sites that
+    // went quiet, or for all of them
+    void ReportSuppressed(bool all);
+    void ReportSuppressedIfDue();
+    void WriteSuppressed(LogCallsite& callsite, std::uint64_t count);
+    // refines the clock calibration now and then, binary logs get the new
+    // one as a kCalibration entry
+    void RecalibrateClockIfDue();
+
+    void UpdateLogLevel();
+    void DispatchRecord(const SinkList& sinks, LogLevel level, bool to_file,
+                        std::string_view text);
+    void FlushRecords(const SinkList& sinks);
+
+    void WriteRecord(LogLevel level, bool to_file, std::string_view text);
+    void WriteRecord(LogLevel level, bool to_file, std::string_view text,
+                     LogOverflowPolicy overflow_policy);
+    void WakeWriterThread();
+    void WriterThreadMain();
+
 private:
     std::string                   m_log_path;
-    LogLevel                      m_log_level;
-    FILE*                         m_log_file;
+    // level checked by IsEnabled, the file level raised to what the sinks
+    // and the flight recorder want
+    std::atomic<LogLevel>         m_log_level;
+    std::atomic<LogLevel>         m_file_level;
+    // most verbose level of the sinks
+    std::atomic<LogLevel>         m_sink_level;
+    std::unique_ptr<LogWriter>    m_log_writer;
     mutable std::recursive_mutex  m_log_mutex;
+
+    LogSettings                   m_settings;
+    // the settings producers read without the log mutex
+    std::atomic<LogFormat>        m_format;
+    std::atomic<LogOverflowPolicy> m_overflow_policy;
+    std::atomic<TimestampPrecision> m_timestamp_precision;
+
+    std::atomic<bool>             m_async;
+    // Shutdown waits for all of them before it stops the writer thread
+    std::array<ProducerCount, kProducerStripes> m_async_producers;
+    std::atomic<std::uint64_t>    m_dropped_records;
+    std::unique_ptr<LogQueue>     m_log_queue;
+
+    std::thread                   m_writer_thread;
+    std::mutex                    m_writer_mutex;
+    std::condition_variable       m_writer_condition;
+    std::atomic<bool>             m_writer_idle;
+    std::atomic<bool>             m_writer_stop;
+
+    // steady clock nanoseconds of the next ReportSuppressedIfDue check
+    std::atomic<std::int64_t>     m_next_suppressed_report;
+
+    // replaced as a whole on every change, so a record being dispatched
+    // keeps the list it started with
+    std::atomic<std::shared_ptr<const SinkList>> m_sinks;
+    std::mutex                    m_sinks_mutex;
+
+    // created on first use and kept, threads may be recording into it
+    std::unique_ptr<LogFlightRecorder> m_flight_recorder;
+    std::atomic<bool>             m_flight_recorder_enabled;
+
+    // non zero while a binary log is open
+    std::atomic<std::uint32_t>    m_binary_session;
+    std::uint32_t                 m_last_binary_session;
+    std::uint32_t                 m_last_callsite_id;
 };
 
 extern Log log;
 
+inline bool LogCategory::IsEnabled(LogLevel level) const
+{
+    return level <= m_enabled_level.load(std::memory_order_relaxed);
 }
 
+inline bool LogRateLimiter::EveryN(std::uint64_t n)
+{
+    n = n > 0 ? n : 1;
+
+    const auto index = count.fetch_add(1, std::memory_order_relaxed);
+    if (index % n != 0)
+    {
+        Suppress();
+        return false;
+    }
+
+    return true;
+}
+
+inline bool LogRateLimiter::FirstN(std::uint64_t n)
+{
+    // stop counting once past the limit, so the counter can never wrap
+    // around and let messages through again
+    return count.load(std::memory_order_relaxed) < n &&
+           count.fetch_add(1, std::memory_order_relaxed) < n;
+}
+
+inline bool LogRateLimiter::EveryInterval(std::chrono::milliseconds interval)
+{
+    using namespace std::chrono;
+
+    const auto now = duration_cast<nanoseconds>(
+        steady_clock::now().time_since_epoch()).count();
+
+    // only the thread that moves the window forward writes the message
+    auto next = next_time.load(std::memory_order_relaxed);
+    if (now < next ||
+        !next_time.compare_exchange_strong(
+            next, now + duration_cast<nanoseconds>(interval).count(),
+            std::memory_order_relaxed))
+    {
+        Suppress();
+        return false;
+    }
+
+    return true;
+}
+
+inline std::uint64_t LogRateLimiter::TakeSuppressed()
+{
+    return suppressed.load(std::memory_order_relaxed) != 0
+               ? suppressed.exchange(0, std::memory_order_relaxed)
+               : 0;
+}
+
+inline void LogRateLimiter::Suppress()
+{
+    suppressed.fetch_add(1, std::memory_order_relaxed);
+
+    if (!registered.load(std::memory_order_relaxed) &&
+        !registered.exchange(true, std::memory_order_relaxed))
+    {
+        RegisterLogRateLimiter(*this);
+    }
+}
+
+inline bool Log::IsEnabled(LogLevel level) const
+{
+    return level <= m_log_level.load(std::memory_order_relaxed);
+}
+
+template <LogLevel level, class... Args>
+inline void Log::Write(std::format_string<Args...> format, Args&&... args)
+{
+    if (IsEnabled(level))
+    {
+        WriteFormatted(nullptr, level, nullptr, 0, format.get(),
+                       std::make_format_args(args...));
+    }
+}
+
+template <LogLevel level, class... Args>
+inline void Log::WriteAt(const char* source, int line,
+                         std::format_string<Args...> format, Args&&... args)
+{
+    if (IsEnabled(level))
+    {
+        WriteFormatted(nullptr, level, source, line, format.get(),
+                       std::make_format_args(args...));
+    }
+}
+
+template <class... Args>
+inline void Log::Write(LogCallsite& callsite,
+                       std::format_string<Args...> format, Args&&... args)
+{
+    WriteCallsite(callsite, {}, format, std::forward<Args>(args)...);
+}
+
+template <class... Args>
+inline void Log::WriteLimited(LogRateLimiter& limiter,
+                              std::format_string<Args...> format,
+                              Args&&... args)
+{
+    const auto suppressed = limiter.TakeSuppressed();
+    if (suppressed == 0)
+    {
+        WriteCallsite(limiter.callsite, {}, format,
+                      std::forward<Args>(args)...);
+        return;
+    }
+
+    const LogField fields[] = { { "suppressed", suppressed } };
+    WriteCallsite(limiter.callsite, fields, format,
+                  std::forward<Args>(args)...);
+}
+
+template <class... Args>
+inline void Log::WriteCallsite(LogCallsite& callsite,
+                               std::span<const LogField> fields,
+                               std::format_string<Args...> format,
+                               Args&&... args)
+{
+    const bool enabled = callsite.category
+                             ? callsite.category->IsEnabled(callsite.level)
+                             : IsEnabled(callsite.level);
+    if (!enabled)
+    {
+        return;
+    }
+
+    if (m_binary_session.load(std::memory_order_acquire) != 0)
+    {
+        auto& record =
+            BeginBinaryRecord(callsite, format.get(), sizeof...(Args));
+        (EncodeLogArgument(record, args), ...);
+        if (!fields.empty())
+        {
+            EncodeLogFields(record, fields);
+        }
+        CommitBinaryRecord(callsite.level, record);
+        return;
+    }
+
+    WriteFormatted(callsite.category, callsite.level, callsite.source,
+                   callsite.line, format.get(), std::make_format_args(args...),
+                   fields);
+}
+
+}
+
+// Messages above this level are compiled out completely, their arguments are
+// never evaluated. Define it project wide to one of HOOHAHA_LOG_LEVEL_* values.
+#ifndef HOOHAHA_LOG_COMPILE_LEVEL
+#define HOOHAHA_LOG_COMPILE_LEVEL HOOHAHA_LOG_LEVEL_TRACE
+#endif
+
+// Release builds do not put source file names into the log
 #ifdef NDEBUG
+#define HOOHAHA_LOG_SOURCE nullptr
+#else
+#define HOOHAHA_LOG_SOURCE __FILE__
+#endif // _NDEBUG
+
+#define HOOHAHA_LOG(level, ...)                                                    \
+    do                                                                             \
+    {                                                                              \
+        if (core::log.IsEnabled(level))                                            \
+        {                                                                          \
+            static core::LogCallsite hoohaha_log_callsite(                         \
+                level, HOOHAHA_LOG_SOURCE, __LINE__);                              \
+            core::log.Write(hoohaha_log_callsite, __VA_ARGS__);                    \
+        }                                                                          \
+    }                                                                              \
+    while (false)                                                                  \
+
+// Rate limited messages for call sites that can fire in a tight loop. Only
+// the messages that go out are formatted. HOOHAHA_LOG_EVERY_N and
+// HOOHAHA_LOG_EVERY_MS add the number of messages suppressed before them as a
+// "suppressed" field, see LogRateLimiter::TakeSuppressed. Levels above
+// HOOHAHA_LOG_COMPILE_LEVEL are compiled out.
+#define HOOHAHA_LOG_LIMITED(level, condition, ...)                                 \
+    do                                                                             \
+    {                                                                              \
+        if ((level) <=                                                             \
+                static_cast<core::LogLevel>(HOOHAHA_LOG_COMPILE_LEVEL) &&          \
+            core::log.IsEnabled(level))                                            \
+        {                                                                          \
+            static core::LogCallsite hoohaha_log_callsite(                         \
+                level, HOOHAHA_LOG_SOURCE, __LINE__);                              \
+            static core::LogRateLimiter hoohaha_log_limiter(                       \
+                hoohaha_log_callsite);                                             \
+            if (condition)                                                         \
+            {                                                                      \
+                core::log.WriteLimited(hoohaha_log_limiter, __VA_ARGS__);          \
+            }                                                                      \
+        }                                                                          \
+    }                                                                              \
+    while (false)                                                                  \
+
+#define HOOHAHA_LOG_EVERY_N(level, n, ...)                                         \
+    HOOHAHA_LOG_LIMITED(level,                                                     \
+        hoohaha_log_limiter.EveryN(n), __VA_ARGS__)                                \
+
+#define HOOHAHA_LOG_FIRST_N(level, n, ...)                                         \
+    HOOHAHA_LOG_LIMITED(level,                                                     \
+        hoohaha_log_limiter.FirstN(n), __VA_ARGS__)                                \
+
+#define HOOHAHA_LOG_EVERY_MS(level, interval_ms, ...)                              \
+    HOOHAHA_LOG_LIMITED(level,                                                     \
+        hoohaha_log_limiter.EveryInterval(                                         \
+            std::chrono::milliseconds(interval_ms)), __VA_ARGS__)                  \
+
+// Defines a log category at namespace scope in one .cpp file. The category
+// follows the log level until a level is set for it.
+#define HOOHAHA_LOG_CATEGORY(category)                                             \
+    core::LogCategory hoohaha_log_category_##category(#category)                   \
+
+// Defines a log category with its own initial level, e.g.
+// HOOHAHA_LOG_CATEGORY_LEVEL(kv, kWarning)
+#define HOOHAHA_LOG_CATEGORY_LEVEL(category, level)                                \
+    core::LogCategory hoohaha_log_category_##category(                             \
+        #category, core::LogLevel::level)                                          \
 
-#define HOOHAHA_LOG(level, format, ...)                                            \
-    { core::log.LogMessage(level, format, __VA_ARGS__); }                          \
+// Makes a category defined in another file usable in this one
+#define HOOHAHA_LOG_DECLARE_CATEGORY(category)                                     \
+    extern core::LogCategory hoohaha_log_category_##category                       \
+
+// HOOHAHA_LOG_CAT(kv, kDebug, "loading {}", path) is filtered by the level of
+// the kv category only. Levels above HOOHAHA_LOG_COMPILE_LEVEL are compiled
+// out like they are for the HOOHAHA_LOG_<LEVEL> macros.
+#define HOOHAHA_LOG_CAT(category, level, ...)                                      \
+    do                                                                             \
+    {                                                                              \
+        if (core::LogLevel::level <=                                               \
+                static_cast<core::LogLevel>(HOOHAHA_LOG_COMPILE_LEVEL) &&          \
+            hoohaha_log_category_##category.IsEnabled(core::LogLevel::level))      \
+        {                                                                          \
+            static core::LogCallsite hoohaha_log_callsite(                         \
+                core::LogLevel::level, HOOHAHA_LOG_SOURCE, __LINE__,               \
+                &hoohaha_log_category_##category);                                 \
+            core::log.Write(hoohaha_log_callsite, __VA_ARGS__);                    \
+        }                                                                          \
+    }                                                                              \
+    while (false)                                                                  \
+
+// HOOHAHA_LOG_FIELDS(kInfo, "player spawned", { "id", id },
+// { "position", position }) writes a structured record, see
+// Log::WriteFields. Levels above HOOHAHA_LOG_COMPILE_LEVEL are compiled out.
+#define HOOHAHA_LOG_FIELDS(level, message, ...)                                    \
+    do                                                                             \
+    {                                                                              \
+        if (core::LogLevel::level <=                                               \
+                static_cast<core::LogLevel>(HOOHAHA_LOG_COMPILE_LEVEL) &&          \
+            core::log.IsEnabled(core::LogLevel::level))                            \
+        {                                                                          \
+            core::log.WriteFields(HOOHAHA_LOG_SOURCE, __LINE__,                    \
+                                  core::LogLevel::level, message,                  \
+                                  { __VA_ARGS__ });                                \
+        }                                                                          \
+    }                                                                              \
+    while (false)                                                                  \
+
+#define HOOHAHA_LOG_DISABLED(...)                                                  \
+    do                                                                             \
+    {                                                                              \
+    }                                                                              \
+    while (false)                                                                  \
+
+#if HOOHAHA_LOG_COMPILE_LEVEL >= HOOHAHA_LOG_LEVEL_FATAL
+
+#define HOOHAHA_LOG_FATAL(...)                                                     \
+    HOOHAHA_LOG(core::LogLevel::kFatal, __VA_ARGS__)                               \
 
 #else
 
-#define HOOHAHA_LOG(level, format, ...)                                            \
-    { core::log.LogMessage(__FILE__, __LINE__, level, format, __VA_ARGS__); }      \
+#define HOOHAHA_LOG_FATAL(...)                                                     \
+    HOOHAHA_LOG_DISABLED(__VA_ARGS__)                                              \
 
-#endif // _NDEBUG
+#endif
+
+#if HOOHAHA_LOG_COMPILE_LEVEL >= HOOHAHA_LOG_LEVEL_ERROR
+
+#define HOOHAHA_LOG_ERROR(...)                                                     \
+    HOOHAHA_LOG(core::LogLevel::kError, __VA_ARGS__)                               \
+
+#else
 
-#define HOOHAHA_LOG_FATAL(format, ...)                                             \
-    HOOHAHA_LOG(core::LogLevel::kFatal, format, __VA_ARGS__)                       \
+#define HOOHAHA_LOG_ERROR(...)                                                     \
+    HOOHAHA_LOG_DISABLED(__VA_ARGS__)                                              \
 
-#define HOOHAHA_LOG_ERROR(format, ...)                                             \
-    HOOHAHA_LOG(core::LogLevel::kError, format, __VA_ARGS__)                       \
+#endif
 
-#define HOOHAHA_LOG_WARN(format, ...)                                              \
-    HOOHAHA_LOG(core::LogLevel::kWarning, format, __VA_ARGS__)                     \
+#if HOOHAHA_LOG_COMPILE_LEVEL >= HOOHAHA_LOG_LEVEL_WARNING
 
-#define HOOHAHA_LOG_INFO(format, ...)                                              \
-    HOOHAHA_LOG(core::LogLevel::kInfo, format, __VA_ARGS__)                        \
+#define HOOHAHA_LOG_WARN(...)                                                      \
+    HOOHAHA_LOG(core::LogLevel::kWarning, __VA_ARGS__)                             \
+
+#else
+
+#define HOOHAHA_LOG_WARN(...)                                                      \
+    HOOHAHA_LOG_DISABLED(__VA_ARGS__)                                              \
+
+#endif
+
+#if HOOHAHA_LOG_COMPILE_LEVEL >= HOOHAHA_LOG_LEVEL_INFO
+
+#define HOOHAHA_LOG_INFO(...)                                                      \
+    HOOHAHA_LOG(core::LogLevel::kInfo, __VA_ARGS__)                                \
+
+#else
+
+#define HOOHAHA_LOG_INFO(...)                                                      \
+    HOOHAHA_LOG_DISABLED(__VA_ARGS__)                                              \
+
+#endif
+
+#if HOOHAHA_LOG_COMPILE_LEVEL >= HOOHAHA_LOG_LEVEL_DEBUG
+
+#define HOOHAHA_LOG_DEBUG(...)                                                     \
+    HOOHAHA_LOG(core::LogLevel::kDebug, __VA_ARGS__)                               \
+
+#else
+
+#define HOOHAHA_LOG_DEBUG(...)                                                     \
+    HOOHAHA_LOG_DISABLED(__VA_ARGS__)                                              \
+
+#endif
+
+#if HOOHAHA_LOG_COMPILE_LEVEL >= HOOHAHA_LOG_LEVEL_TRACE
+
+#define HOOHAHA_LOG_TRACE(...)                                                     \
+    HOOHAHA_LOG(core::LogLevel::kTrace, __VA_ARGS__)                               \
+
+#else
 
-#define HOOHAHA_LOG_DEBUG(format, ...)                                             \
-    HOOHAHA_LOG(core::LogLevel::kDebug, format, __VA_ARGS__)                       \
+#define HOOHAHA_LOG_TRACE(...)                                                     \
+    HOOHAHA_LOG_DISABLED(__VA_ARGS__)                                              \
 
-#define HOOHAHA_LOG_TRACE(format, ...)                                             \
-    HOOHAHA_LOG(core::LogLevel::kTrace, format, __VA_ARGS__)                       \
+#endif
 
 #endif // HOOHAHA_CORE_LOG_H_
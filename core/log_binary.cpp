@@ -0,0 +1,628 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "log_binary.h"
+
+#include <chrono>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+#include "log.h"
+#include "log_fields.h"
+#include "mathlib.h"
+#include "timestamp.h"
+
+namespace core
+{
+
+namespace
+{
+
+struct Descriptor
+{
+    LogLevel          level;
+    int               line;
+    std::string_view  format;
+    std::string_view  source;
+};
+
+struct Argument
+{
+    LogArgumentType   type;
+    std::int64_t      int_value;
+    std::uint64_t     uint_value;
+    double            double_value;
+    float             float_value;
+    float             vector_value[3];
+    std::string_view  string_value;
+};
+
+class Reader final
+{
+public:
+    Reader(const char* begin, const char* end)
+        : m_current(begin)
+        , m_end(end)
+    {
+    }
+
+    template <class T>
+    bool Read(T& value)
+    {
+        if (static_cast<std::size_t>(m_end - m_current) < sizeof(T))
+        {
+            return false;
+        }
+
+        std::memcpy(&value, m_current, sizeof(T));
+        m_current += sizeof(T);
+        return true;
+    }
+
+    bool ReadString(std::string_view& value)
+    {
+        std::uint32_t size;
+        if (!Read(size) || static_cast<std::size_t>(m_end - m_current) < size)
+        {
+            return false;
+        }
+
+        value = std::string_view(m_current, size);
+        m_current += size;
+        return true;
+    }
+
+    bool AtEnd() const
+    {
+        return m_current == m_end;
+    }
+
+    const char* Current() const
+    {
+        return m_current;
+    }
+
+private:
+    const char*  m_current;
+    const char*  m_end;
+};
+
+std::string_view FormatTime(std::int64_t nanoseconds, std::uint8_t precision)
+{
+    using namespace std::chrono;
+
+    const system_clock::time_point time(
+        duration_cast<system_clock::duration>(
+            std::chrono::nanoseconds(nanoseconds)));
+
+    return FormatTimestamp(time, static_cast<TimestampPrecision>(precision));
+}
+
+bool ReadArgument(Reader& reader, Argument& argument)
+{
+    if (!reader.Read(argument.type))
+    {
+        return false;
+    }
+
+    switch (argument.type)
+    {
+    case LogArgumentType::kBool:
+    {
+        std::uint8_t value;
+        if (!reader.Read(value))
+        {
+            return false;
+        }
+        argument.uint_value = value;
+        return true;
+    }
+    case LogArgumentType::kChar:
+    {
+        char value;
+        if (!reader.Read(value))
+        {
+            return false;
+        }
+        argument.int_value = value;
+        return true;
+    }
+    case LogArgumentType::kInt64:
+        return reader.Read(argument.int_value);
+    case LogArgumentType::kUInt64:
+    case LogArgumentType::kPointer:
+        return reader.Read(argument.uint_value);
+    case LogArgumentType::kFloat:
+        return reader.Read(argument.float_value);
+    case LogArgumentType::kDouble:
+        return reader.Read(argument.double_value);
+    case LogArgumentType::kString:
+        return reader.ReadString(argument.string_value);
+    case LogArgumentType::kVector3:
+        return reader.Read(argument.vector_value);
+    default:
+        return false;
+    }
+}
+
+LogField ToLogField(std::string_view name, const Argument& argument)
+{
+    switch (argument.type)
+    {
+    case LogArgumentType::kBool:
+        return { name, argument.uint_value != 0 };
+    case LogArgumentType::kChar:
+    case LogArgumentType::kInt64:
+        return { name, argument.int_value };
+    case LogArgumentType::kFloat:
+        return { name, argument.float_value };
+    case LogArgumentType::kDouble:
+        return { name, argument.double_value };
+    case LogArgumentType::kString:
+        return { name, argument.string_value };
+    case LogArgumentType::kVector3:
+        return { name, Vector3d(argument.vector_value) };
+    default:
+        return { name, argument.uint_value };
+    }
+}
+
+// u8 count, count * (u32 + name, argument), see EncodeLogFields
+bool ReadFields(Reader& reader, std::vector<LogField>& fields)
+{
+    std::uint8_t count;
+    if (!reader.Read(count))
+    {
+        return false;
+    }
+
+    for (std::uint8_t i = 0; i < count; i++)
+    {
+        std::string_view name;
+        Argument argument;
+        if (!reader.ReadString(name) || !ReadArgument(reader, argument))
+        {
+            return false;
+        }
+        fields.push_back(ToLogField(name, argument));
+    }
+
+    return true;
+}
+
+void FormatArgument(std::string& output, std::string_view spec,
+                    const Argument& argument)
+{
+    std::string format = "{:";
+    format += spec;
+    format += '}';
+
+    auto out = std::back_inserter(output);
+
+    try
+    {
+        switch (argument.type)
+        {
+        case LogArgumentType::kBool:
+        {
+            const bool value = argument.uint_value != 0;
+            std::vformat_to(out, format, std::make_format_args(value));
+            break;
+        }
+        case LogArgumentType::kChar:
+        {
+            const char value = static_cast<char>(argument.int_value);
+            std::vformat_to(out, format, std::make_format_args(value));
+            break;
+        }
+        case LogArgumentType::kInt64:
+            std::vformat_to(out, format,
+                            std::make_format_args(argument.int_value));
+            break;
+        case LogArgumentType::kUInt64:
+            std::vformat_to(out, format,
+                            std::make_format_args(argument.uint_value));
+            break;
+        case LogArgumentType::kFloat:
+            std::vformat_to(out, format,
+                            std::make_format_args(argument.float_value));
+            break;
+        case LogArgumentType::kDouble:
+            std::vformat_to(out, format,
+                            std::make_format_args(argument.double_value));
+            break;
+        case LogArgumentType::kPointer:
+        {
+            const void* value =
+                reinterpret_cast<const void*>(argument.uint_value);
+            std::vformat_to(out, format, std::make_format_args(value));
+            break;
+        }
+        case LogArgumentType::kString:
+            std::vformat_to(out, format,
+                            std::make_format_args(argument.string_value));
+            break;
+        case LogArgumentType::kVector3:
+            std::format_to(out, "({}, {}, {})", argument.vector_value[0],
+                           argument.vector_value[1], argument.vector_value[2]);
+            break;
+        }
+    }
+    catch (const std::exception&)
+    {
+        output += "{?}";
+    }
+}
+
+// Re-runs the replacement fields of a std::format string one by one against
+// the decoded arguments. Nested replacement fields (dynamic width or
+// precision) are not supported.
+void FormatMessage(std::string& output, std::string_view format,
+                   const std::vector<Argument>& arguments)
+{
+    std::size_t next_argument = 0;
+
+    for (std::size_t i = 0; i < format.size(); ++i)
+    {
+        const char c = format[i];
+
+        if ((c == '{' || c == '}') &&
+            i + 1 < format.size() && format[i + 1] == c)
+        {
+            output += c;
+            ++i;
+            continue;
+        }
+
+        if (c != '{')
+        {
+            output += c;
+            continue;
+        }
+
+        const auto close = format.find('}', i);
+        if (close == std::string_view::npos)
+        {
+            output += format.substr(i);
+            return;
+        }
+
+        auto field = format.substr(i + 1, close - i - 1);
+        auto spec = std::string_view{};
+
+        const auto colon = field.find(':');
+        if (colon != std::string_view::npos)
+        {
+            spec = field.substr(colon + 1);
+            field = field.substr(0, colon);
+        }
+
+        std::size_t index = next_argument++;
+        if (!field.empty())
+        {
+            index = static_cast<std::size_t>(
+                std::strtoul(std::string(field).c_str(), nullptr, 10));
+        }
+
+        if (index < arguments.size())
+        {
+            FormatArgument(output, spec, arguments[index]);
+        }
+        else
+        {
+            output += "{?}";
+        }
+
+        i = close;
+    }
+}
+
+void FinishLine(std::string& line, std::string_view source, int line_number)
+{
+    if (!source.empty())
+    {
+        std::format_to(std::back_inserter(line), " : {}({})",
+                       source, line_number);
+    }
+
+    line += "\r\n";
+}
+
+} // namespace
+
+LogBinaryDecoder::LogBinaryDecoder()
+    : m_timestamp_precision(0)
+    , m_tick_base(0)
+    , m_time_base(0)
+    , m_nanoseconds_per_tick(1.0)
+{
+}
+
+std::string_view LogBinaryDecoder::FormatTicks(std::int64_t ticks) const
+{
+    const auto offset = static_cast<std::int64_t>(
+        static_cast<std::uint64_t>(ticks) - m_tick_base);
+    const auto nanoseconds = m_time_base + static_cast<std::int64_t>(
+        static_cast<double>(offset) * m_nanoseconds_per_tick);
+
+    return FormatTime(nanoseconds, m_timestamp_precision);
+}
+
+std::string_view LogBinaryDecoder::FormatThread(std::uint64_t thread)
+{
+    m_thread_tag.clear();
+
+    const auto name = m_thread_names.find(thread);
+    if (name == m_thread_names.end() || name->second.empty())
+    {
+        std::format_to(std::back_inserter(m_thread_tag), "{:04}", thread);
+    }
+    else
+    {
+        std::format_to(std::back_inserter(m_thread_tag), "{:04} {}", thread,
+                       name->second);
+    }
+
+    return m_thread_tag;
+}
+
+bool LogBinaryDecoder::Decode(std::string_view data,
+                              const LineCallback& callback)
+{
+    Reader header(data.data(), data.data() + data.size());
+
+    char magic[sizeof(kLogBinaryMagic)];
+    std::uint32_t version;
+    std::int64_t start_time;
+
+    if (!header.Read(magic) ||
+        std::memcmp(magic, kLogBinaryMagic, sizeof(magic)) != 0 ||
+        !header.Read(version) || version < 1 || version > kLogBinaryVersion ||
+        !header.Read(m_timestamp_precision) || !header.Read(start_time))
+    {
+        return false;
+    }
+
+    // version 1 times are nanoseconds already
+    m_tick_base = 0;
+    m_time_base = 0;
+    m_nanoseconds_per_tick = 1.0;
+
+    if (version >= 2 &&
+        (!header.Read(m_tick_base) || !header.Read(m_time_base) ||
+         !header.Read(m_nanoseconds_per_tick)))
+    {
+        return false;
+    }
+
+    m_thread_names.clear();
+
+    const char* const entries_begin = header.Current();
+    const char* const entries_end = data.data() + data.size();
+
+    // Descriptors are collected up front: with the kGrow overflow policy a
+    // record may be written before the descriptor it refers to.
+    std::unordered_map<std::uint32_t, Descriptor> descriptors;
+
+    Reader scan(entries_begin, entries_end);
+    while (!scan.AtEnd())
+    {
+        LogBinaryEntry type;
+        std::uint32_t size;
+        if (!scan.Read(type) || type == LogBinaryEntry::kEnd ||
+            !scan.Read(size) ||
+            static_cast<std::size_t>(entries_end - scan.Current()) < size)
+        {
+            break;
+        }
+
+        Reader payload(scan.Current(), scan.Current() + size);
+        scan = Reader(scan.Current() + size, entries_end);
+
+        if (type == LogBinaryEntry::kDescriptor)
+        {
+            std::uint32_t id;
+            std::uint8_t level;
+            Descriptor descriptor;
+
+            if (!payload.Read(id) || !payload.Read(level) ||
+                !payload.Read(descriptor.line) ||
+                !payload.ReadString(descriptor.format) ||
+                !payload.ReadString(descriptor.source))
+            {
+                return false;
+            }
+
+            descriptor.level = static_cast<LogLevel>(level);
+            descriptors[id] = descriptor;
+        }
+    }
+
+    std::string line;
+    std::vector<Argument> arguments;
+    std::vector<LogField> fields;
+
+    line = "---------------- log started at ";
+    line += FormatTime(start_time, m_timestamp_precision);
+    line += " ----------------\r\n";
+    callback(line);
+
+    Reader reader(entries_begin, entries_end);
+    while (!reader.AtEnd())
+    {
+        LogBinaryEntry type;
+        std::uint32_t size;
+        if (!reader.Read(type) || type == LogBinaryEntry::kEnd ||
+            !reader.Read(size) ||
+            static_cast<std::size_t>(entries_end - reader.Current()) < size)
+        {
+            // truncated or unwritten tail, e.g. the process died while
+            // writing
+            break;
+        }
+
+        Reader payload(reader.Current(), reader.Current() + size);
+        reader = Reader(reader.Current() + size, entries_end);
+
+        line.clear();
+        auto out = std::back_inserter(line);
+
+        switch (type)
+        {
+        case LogBinaryEntry::kRecord:
+        {
+            std::uint32_t id;
+            std::int64_t ticks;
+            std::uint64_t thread;
+            std::uint8_t count;
+
+            if (!payload.Read(id) || !payload.Read(ticks) ||
+                !payload.Read(thread) || !payload.Read(count))
+            {
+                return false;
+            }
+
+            const auto descriptor = descriptors.find(id);
+            if (descriptor == descriptors.end())
+            {
+                return false;
+            }
+
+            arguments.resize(count);
+            for (auto& argument : arguments)
+            {
+                if (!ReadArgument(payload, argument))
+                {
+                    return false;
+                }
+            }
+
+            fields.clear();
+            if (!payload.AtEnd() && !ReadFields(payload, fields))
+            {
+                return false;
+            }
+
+            std::format_to(out, "[{}][{}][{}] ",
+                           FormatTicks(ticks),
+                           LogLevelToString(descriptor->second.level),
+                           FormatThread(thread));
+            FormatMessage(line, descriptor->second.format, arguments);
+            AppendLogFieldsText(line, fields);
+            FinishLine(line, descriptor->second.source,
+                       descriptor->second.line);
+            callback(line);
+            break;
+        }
+        case LogBinaryEntry::kMessage:
+        {
+            std::uint8_t level;
+            std::int64_t ticks;
+            std::uint64_t thread;
+            std::int32_t line_number;
+            std::string_view source;
+            std::string_view message;
+
+            if (!payload.Read(level) || !payload.Read(ticks) ||
+                !payload.Read(thread) || !payload.Read(line_number) ||
+                !payload.ReadString(source) || !payload.ReadString(message))
+            {
+                return false;
+            }
+
+            std::format_to(out, "[{}][{}][{}] {}",
+                           FormatTicks(ticks),
+                           LogLevelToString(static_cast<LogLevel>(level)),
+                           FormatThread(thread), message);
+            FinishLine(line, source, line_number);
+            callback(line);
+            break;
+        }
+        case LogBinaryEntry::kStructured:
+        {
+            std::uint8_t level;
+            std::int64_t ticks;
+            std::uint64_t thread;
+            std::int32_t line_number;
+            std::string_view source;
+            std::string_view message;
+
+            fields.clear();
+            if (!payload.Read(level) || !payload.Read(ticks) ||
+                !payload.Read(thread) || !payload.Read(line_number) ||
+                !payload.ReadString(source) || !payload.ReadString(message) ||
+                !ReadFields(payload, fields))
+            {
+                return false;
+            }
+
+            std::format_to(out, "[{}][{}][{}] {}",
+                           FormatTicks(ticks),
+                           LogLevelToString(static_cast<LogLevel>(level)),
+                           FormatThread(thread), message);
+            AppendLogFieldsText(line, fields);
+            FinishLine(line, source, line_number);
+            callback(line);
+            break;
+        }
+        case LogBinaryEntry::kClose:
+        {
+            std::int64_t ticks;
+            if (!payload.Read(ticks))
+            {
+                return false;
+            }
+
+            std::format_to(out,
+                           "---------------- log closed at {} ----------------\r\n",
+                           FormatTicks(ticks));
+            callback(line);
+            break;
+        }
+        case LogBinaryEntry::kThreadName:
+        {
+            std::uint64_t thread;
+            std::string_view name;
+            if (!payload.Read(thread) || !payload.ReadString(name))
+            {
+                return false;
+            }
+
+            m_thread_names[thread] = name;
+            break;
+        }
+        case LogBinaryEntry::kCalibration:
+        {
+            if (!payload.Read(m_tick_base) || !payload.Read(m_time_base) ||
+                !payload.Read(m_nanoseconds_per_tick))
+            {
+                return false;
+            }
+            break;
+        }
+        default:
+            // descriptors were handled above, unknown entries are skipped
+            break;
+        }
+    }
+
+    return true;
+}
+
+}
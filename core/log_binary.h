@@ -0,0 +1,214 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOOHAHA_CORE_LOG_BINARY_H_
+#define HOOHAHA_CORE_LOG_BINARY_H_
+
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+namespace core
+{
+
+// Binary log stream layout, all values are stored in native byte order:
+//
+//   header  : "HHBINLOG", u32 version, u8 timestamp precision,
+//             i64 start time in nanoseconds since epoch,
+//             u64 tick base, i64 nanoseconds since epoch at the tick base,
+//             f64 nanoseconds per tick
+//   entries : u8 entry type, u32 payload size, payload
+//
+// Entry times are raw clock ticks (see clock.h), converted with the
+// calibration from the header or the kCalibration entry before them.
+// Version 1 headers end after the start time, their entry times are
+// nanoseconds since epoch and still decode.
+//
+// A kDescriptor entry is written the first time a call site is hit and
+// carries everything that is constant for it. A kRecord entry only holds the
+// descriptor id, the raw timestamp, the thread and the raw argument values.
+// Messages that have no call site (printf style API) are written preformatted
+// as kMessage entries, structured records as kStructured entries. Threads
+// are numbered like in text logs, a kThreadName entry names one. Decoders
+// skip entry types they do not know and stop at a zero entry type.
+
+constexpr char kLogBinaryMagic[8] = { 'H', 'H', 'B', 'I', 'N', 'L', 'O', 'G' };
+constexpr std::uint32_t kLogBinaryVersion = 2;
+constexpr std::size_t kLogBinaryEntryHeaderSize = 5;
+
+enum class LogBinaryEntry : std::uint8_t
+{
+    // never written, the unwritten NUL filled tail of a preallocated file
+    // (see MappedLogWriter) ends the stream
+    kEnd = 0,
+    // u32 id, u8 level, i32 line, u32 + format, u32 + source
+    kDescriptor = 1,
+    // u32 id, i64 ticks, u64 thread, u8 count, count * argument, optionally
+    // followed by fields like kStructured has them, e.g. the suppressed count
+    // of a rate limited call site
+    kRecord = 2,
+    // u8 level, i64 ticks, u64 thread, i32 line, u32 + source, u32 + message
+    kMessage = 3,
+    // i64 ticks
+    kClose = 4,
+    // u8 level, i64 ticks, u64 thread, i32 line, u32 + source, u32 + message,
+    // u8 count, count * (u32 + name, argument), see Log::WriteFields
+    kStructured = 5,
+    // u64 tick base, i64 nanoseconds since epoch at the tick base,
+    // f64 nanoseconds per tick, replaces the calibration of the header for
+    // the entries that follow (see RecalibrateClock)
+    kCalibration = 6,
+    // u64 thread, u32 + name, written before the first entry of a named
+    // thread and whenever the name changes
+    kThreadName = 7
+};
+
+// Every argument is a type tag followed by its raw value
+enum class LogArgumentType : std::uint8_t
+{
+    kBool = 1,
+    kChar,
+    kInt64,
+    kUInt64,
+    kFloat,
+    kDouble,
+    kPointer,
+    // u32 length + bytes
+    kString,
+    // three floats, only used by structured record fields
+    kVector3
+};
+
+template <class T>
+inline void AppendLogBinaryValue(std::string& buffer, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+inline void AppendLogBinaryString(std::string& buffer, std::string_view value)
+{
+    AppendLogBinaryValue(buffer, static_cast<std::uint32_t>(value.size()));
+    buffer.append(value.data(), value.size());
+}
+
+template <class T>
+inline void EncodeLogArgument(std::string& buffer, const T& value)
+{
+    using Type = std::remove_cvref_t<T>;
+
+    if constexpr (std::is_same_v<Type, bool>)
+    {
+        AppendLogBinaryValue(buffer, LogArgumentType::kBool);
+        AppendLogBinaryValue(buffer, static_cast<std::uint8_t>(value));
+    }
+    else if constexpr (std::is_same_v<Type, char>)
+    {
+        AppendLogBinaryValue(buffer, LogArgumentType::kChar);
+        AppendLogBinaryValue(buffer, value);
+    }
+    else if constexpr (std::is_integral_v<Type> && std::is_signed_v<Type>)
+    {
+        AppendLogBinaryValue(buffer, LogArgumentType::kInt64);
+        AppendLogBinaryValue(buffer, static_cast<std::int64_t>(value));
+    }
+    else if constexpr (std::is_integral_v<Type>)
+    {
+        AppendLogBinaryValue(buffer, LogArgumentType::kUInt64);
+        AppendLogBinaryValue(buffer, static_cast<std::uint64_t>(value));
+    }
+    else if constexpr (std::is_same_v<Type, float>)
+    {
+        AppendLogBinaryValue(buffer, LogArgumentType::kFloat);
+        AppendLogBinaryValue(buffer, value);
+    }
+    else if constexpr (std::is_floating_point_v<Type>)
+    {
+        AppendLogBinaryValue(buffer, LogArgumentType::kDouble);
+        AppendLogBinaryValue(buffer, static_cast<double>(value));
+    }
+    else if constexpr (std::is_convertible_v<const Type&, std::string_view>)
+    {
+        AppendLogBinaryValue(buffer, LogArgumentType::kString);
+        if constexpr (std::is_pointer_v<Type>)
+        {
+            // like LogField, a null C string is logged as an empty one
+            AppendLogBinaryString(buffer, std::string_view(value ? value : ""));
+        }
+        else
+        {
+            AppendLogBinaryString(buffer, std::string_view(value));
+        }
+    }
+    else if constexpr (std::is_pointer_v<Type> || std::is_null_pointer_v<Type>)
+    {
+        AppendLogBinaryValue(buffer, LogArgumentType::kPointer);
+        AppendLogBinaryValue(buffer, reinterpret_cast<std::uint64_t>(
+                                         static_cast<const void*>(value)));
+    }
+    else
+    {
+        // types with a custom std::formatter are formatted right away
+        AppendLogBinaryValue(buffer, LogArgumentType::kString);
+        AppendLogBinaryString(buffer, std::format("{}", value));
+    }
+}
+
+// Turns a binary log stream back into the text layout Log writes in text
+// mode. Every decoded line, including the trailing "\r\n", is passed to the
+// callback.
+class LogBinaryDecoder final
+{
+public:
+    using LineCallback = std::function<void(std::string_view line)>;
+
+    LogBinaryDecoder();
+    LogBinaryDecoder(const LogBinaryDecoder&) = delete;
+    LogBinaryDecoder(LogBinaryDecoder&&) = delete;
+
+    // Returns false when the data is not a binary log or an entry is
+    // corrupted. A stream truncated in the middle of an entry is decoded up
+    // to the last complete entry.
+    bool Decode(std::string_view data, const LineCallback& callback);
+
+    LogBinaryDecoder& operator=(const LogBinaryDecoder&) = delete;
+    LogBinaryDecoder& operator=(LogBinaryDecoder&&) = delete;
+
+private:
+    std::string_view FormatTicks(std::int64_t ticks) const;
+    // "0003 render" like CurrentThreadTag
+    std::string_view FormatThread(std::uint64_t thread);
+
+private:
+    std::uint8_t   m_timestamp_precision;
+    std::uint64_t  m_tick_base;
+    std::int64_t   m_time_base;
+    double         m_nanoseconds_per_tick;
+
+    std::unordered_map<std::uint64_t, std::string> m_thread_names;
+    std::string    m_thread_tag;
+};
+
+}
+
+#endif // HOOHAHA_CORE_LOG_BINARY_H_
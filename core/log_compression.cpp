@@ -0,0 +1,420 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "log_compression.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace core
+{
+
+namespace
+{
+
+const std::size_t kMinMatch = 4;
+// the block always ends with literals, and no match starts this close to
+// the end, which lets the codec read 4 bytes at a time without checks
+const std::size_t kLastLiterals = 5;
+const std::size_t kMatchStartLimit = 12;
+const std::size_t kMaxOffset = 65535;
+const unsigned int kHashBits = 14;
+
+inline std::uint32_t Read32(const char* data)
+{
+    std::uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline std::uint32_t HashSequence(std::uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+inline void AppendLength(std::string& output, std::size_t length)
+{
+    while (length >= 255)
+    {
+        output += static_cast<char>(255);
+        length -= 255;
+    }
+    output += static_cast<char>(length);
+}
+
+// token, literals and, unless it is the last sequence, the match
+void AppendSequence(std::string& output, std::string_view literals,
+                    std::size_t offset, std::size_t match_length)
+{
+    const auto token_position = output.size();
+    output += '\0';
+
+    auto token = static_cast<unsigned int>(
+                     std::min<std::size_t>(literals.size(), 15)) << 4;
+    if (literals.size() >= 15)
+    {
+        AppendLength(output, literals.size() - 15);
+    }
+    output += literals;
+
+    if (match_length > 0)
+    {
+        output += static_cast<char>(offset & 0xff);
+        output += static_cast<char>(offset >> 8);
+
+        const auto length = match_length - kMinMatch;
+        token |= static_cast<unsigned int>(std::min<std::size_t>(length, 15));
+        if (length >= 15)
+        {
+            AppendLength(output, length - 15);
+        }
+    }
+
+    output[token_position] = static_cast<char>(token);
+}
+
+// reads a length continued in 255 steps after a nibble of 15
+inline bool ReadLength(std::string_view input, std::size_t& position,
+                       std::size_t& length)
+{
+    std::uint8_t byte;
+    do
+    {
+        if (position == input.size())
+        {
+            return false;
+        }
+        byte = static_cast<std::uint8_t>(input[position++]);
+        length += byte;
+    } while (byte == 255);
+
+    return true;
+}
+
+std::uint32_t Checksum(std::string_view data)
+{
+    std::uint32_t hash = 2166136261u;
+    for (const auto c : data)
+    {
+        hash = (hash ^ static_cast<std::uint8_t>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+template <class T>
+inline void AppendValue(std::string& output, T value)
+{
+    output.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} // namespace
+
+void CompressLogBlock(std::string_view input, std::string& output,
+                      std::vector<std::uint32_t>& hash_table)
+{
+    hash_table.assign(std::size_t{ 1 } << kHashBits, 0);
+
+    const char* const data = input.data();
+    const auto size = input.size();
+    std::size_t anchor = 0;
+
+    if (size > kMatchStartLimit)
+    {
+        const auto match_start_end = size - kMatchStartLimit;
+        const auto match_end = size - kLastLiterals;
+        std::size_t position = 0;
+
+        while (position < match_start_end)
+        {
+            const auto sequence = Read32(data + position);
+            auto& slot = hash_table[HashSequence(sequence)];
+            const std::size_t candidate = slot;
+            slot = static_cast<std::uint32_t>(position);
+
+            if (candidate >= position || position - candidate > kMaxOffset ||
+                Read32(data + candidate) != sequence)
+            {
+                // skip faster through data that does not compress
+                position += 1 + ((position - anchor) >> 6);
+                continue;
+            }
+
+            auto length = kMinMatch;
+            while (position + length < match_end &&
+                   data[candidate + length] == data[position + length])
+            {
+                length++;
+            }
+
+            AppendSequence(output, input.substr(anchor, position - anchor),
+                           position - candidate, length);
+
+            position += length;
+            anchor = position;
+        }
+    }
+
+    AppendSequence(output, input.substr(anchor), 0, 0);
+}
+
+bool DecompressLogBlock(std::string_view input, std::size_t size,
+                        std::string& output)
+{
+    const auto begin = output.size();
+    output.resize(begin + size);
+
+    char* const block = output.data() + begin;
+    std::size_t written = 0;
+    std::size_t position = 0;
+
+    while (position < input.size())
+    {
+        const auto token = static_cast<std::uint8_t>(input[position++]);
+
+        std::size_t literals = token >> 4;
+        if (literals == 15 && !ReadLength(input, position, literals))
+        {
+            break;
+        }
+
+        if (literals > input.size() - position || literals > size - written)
+        {
+            break;
+        }
+
+        std::memcpy(block + written, input.data() + position, literals);
+        position += literals;
+        written += literals;
+
+        if (position == input.size())
+        {
+            // the last sequence has no match
+            output.resize(begin + written);
+            return written == size;
+        }
+
+        if (input.size() - position < 2)
+        {
+            break;
+        }
+
+        const auto low = static_cast<std::uint8_t>(input[position]);
+        const auto high = static_cast<std::uint8_t>(input[position + 1]);
+        const std::size_t offset = low | (static_cast<std::size_t>(high) << 8);
+        position += 2;
+
+        std::size_t length = token & 15;
+        if (length == 15 && !ReadLength(input, position, length))
+        {
+            break;
+        }
+        length += kMinMatch;
+
+        if (offset == 0 || offset > written || length > size - written)
+        {
+            break;
+        }
+
+        // the match may overlap the bytes it produces, copy byte by byte
+        const char* source = block + written - offset;
+        for (std::size_t i = 0; i < length; i++)
+        {
+            block[written + i] = source[i];
+        }
+        written += length;
+    }
+
+    output.resize(begin);
+    return false;
+}
+
+bool IsCompressedLog(std::string_view data)
+{
+    return data.size() >= sizeof(kLogFrameMagic) &&
+           std::memcmp(data.data(), kLogFrameMagic, sizeof(kLogFrameMagic)) == 0;
+}
+
+std::size_t DecodeLogFrames(
+    std::string_view data,
+    const std::function<void(std::string_view block)>& callback)
+{
+    std::string block;
+    std::size_t position = 0;
+
+    while (data.size() - position >= kLogFrameHeaderSize &&
+           IsCompressedLog(data.substr(position)))
+    {
+        std::uint32_t size;
+        std::uint32_t stored_size;
+        std::uint32_t checksum;
+        std::memcpy(&size, data.data() + position + 4, sizeof(size));
+        std::memcpy(&stored_size, data.data() + position + 8,
+                    sizeof(stored_size));
+        std::memcpy(&checksum, data.data() + position + 12, sizeof(checksum));
+
+        const bool raw = (stored_size & kLogFrameStored) != 0;
+        stored_size &= ~kLogFrameStored;
+
+        if (data.size() - position - kLogFrameHeaderSize < stored_size)
+        {
+            // the process died while writing this frame
+            break;
+        }
+
+        const auto stored =
+            data.substr(position + kLogFrameHeaderSize, stored_size);
+
+        block.clear();
+        if (raw)
+        {
+            block = stored;
+        }
+        else if (!DecompressLogBlock(stored, size, block))
+        {
+            break;
+        }
+
+        if (block.size() != size || Checksum(block) != checksum)
+        {
+            break;
+        }
+
+        callback(block);
+        position += kLogFrameHeaderSize + stored_size;
+    }
+
+    return position;
+}
+
+CompressedLogWriter::CompressedLogWriter(const LogCompressionSettings& settings,
+                                         std::unique_ptr<LogWriter> writer)
+    : m_settings(settings)
+    , m_writer(std::move(writer))
+{
+    m_settings.block_size = std::clamp<std::size_t>(m_settings.block_size,
+                                                    1024, kLogFrameStored - 1);
+}
+
+CompressedLogWriter::~CompressedLogWriter()
+{
+    Close();
+}
+
+bool CompressedLogWriter::Open(std::string_view path)
+{
+    Close();
+
+    m_block.clear();
+    m_block.reserve(m_settings.block_size);
+
+    return m_writer->Open(path);
+}
+
+void CompressedLogWriter::Close()
+{
+    WriteFrame();
+    m_writer->Close();
+}
+
+bool CompressedLogWriter::Write(std::string_view data)
+{
+    bool result = true;
+
+    if (!m_block.empty() && m_block.size() + data.size() > m_settings.block_size)
+    {
+        result = WriteFrame();
+    }
+
+    if (m_block.empty())
+    {
+        m_block_started = std::chrono::steady_clock::now();
+    }
+
+    m_block += data;
+
+    if (m_block.size() >= m_settings.block_size)
+    {
+        result = WriteFrame() && result;
+    }
+
+    return result;
+}
+
+void CompressedLogWriter::Flush()
+{
+    WriteFrame();
+    m_writer->Flush();
+}
+
+void CompressedLogWriter::EndBatch()
+{
+    if (!m_block.empty() &&
+        std::chrono::steady_clock::now() - m_block_started >=
+            m_settings.flush_interval)
+    {
+        WriteFrame();
+    }
+
+    m_writer->EndBatch();
+}
+
+void CompressedLogWriter::AddPreamble(std::string_view data)
+{
+    std::string frame;
+    EncodeFrame(data, frame);
+    m_writer->AddPreamble(frame);
+}
+
+bool CompressedLogWriter::WriteFrame()
+{
+    if (m_block.empty())
+    {
+        return true;
+    }
+
+    EncodeFrame(m_block, m_frame);
+    m_block.clear();
+
+    // one write per frame, so a rolling writer never splits one
+    return m_writer->Write(m_frame);
+}
+
+void CompressedLogWriter::EncodeFrame(std::string_view block,
+                                      std::string& frame)
+{
+    frame.assign(kLogFrameMagic, sizeof(kLogFrameMagic));
+    AppendValue(frame, static_cast<std::uint32_t>(block.size()));
+    AppendValue(frame, std::uint32_t{ 0 });
+    AppendValue(frame, Checksum(block));
+
+    CompressLogBlock(block, frame, m_hash_table);
+
+    auto stored_size =
+        static_cast<std::uint32_t>(frame.size() - kLogFrameHeaderSize);
+    if (stored_size >= block.size())
+    {
+        // not worth it, keep the bytes as they are
+        frame.resize(kLogFrameHeaderSize);
+        frame += block;
+        stored_size = static_cast<std::uint32_t>(block.size()) |
+                      kLogFrameStored;
+    }
+    std::memcpy(&frame[8], &stored_size, sizeof(stored_size));
+}
+
+}
@@ -0,0 +1,124 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOOHAHA_CORE_LOG_COMPRESSION_H_
+#define HOOHAHA_CORE_LOG_COMPRESSION_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "log_writer.h"
+
+namespace core
+{
+
+// Compressed log stream layout, a sequence of self contained frames, all
+// values in native byte order:
+//
+//   frame : u32 magic "HHLZ", u32 size, u32 stored size, u32 checksum,
+//           stored bytes
+//
+// The stored bytes are an LZ4 style block (see CompressLogBlock) that
+// decompresses to size bytes, or the raw bytes when the top bit of the
+// stored size is set. The checksum is FNV-1a over the decompressed bytes.
+// Frames never reference each other, a file cut short by a crash decodes
+// up to its last complete frame.
+
+constexpr char kLogFrameMagic[4] = { 'H', 'H', 'L', 'Z' };
+constexpr std::size_t kLogFrameHeaderSize = 16;
+constexpr std::uint32_t kLogFrameStored = 0x80000000;
+
+struct LogCompressionSettings
+{
+    bool                       enabled = false;
+    // uncompressed bytes per frame, larger frames compress better
+    std::size_t                block_size = 256 * 1024;
+    // a partial frame is written at least this often
+    std::chrono::milliseconds  flush_interval = std::chrono::milliseconds(1000);
+};
+
+// LZ4 style block codec: sequences of literals followed by a match of at
+// least 4 bytes up to 64KB back. The hash table is scratch space reused
+// between calls. Compressed bytes are appended to output.
+void CompressLogBlock(std::string_view input, std::string& output,
+                      std::vector<std::uint32_t>& hash_table);
+
+// Appends exactly size decompressed bytes to output, returns false for a
+// corrupted block
+bool DecompressLogBlock(std::string_view input, std::size_t size,
+                        std::string& output);
+
+bool IsCompressedLog(std::string_view data);
+
+// Passes the decompressed bytes of every frame to the callback. Stops at
+// the end of the data or at the first truncated or corrupted frame, and
+// returns how many bytes were decoded.
+std::size_t DecodeLogFrames(
+    std::string_view data,
+    const std::function<void(std::string_view block)>& callback);
+
+// Compresses what another writer would write into frames. Records are never
+// split between frames: a frame is written when the next record would not
+// fit into block_size, on Flush (Log flushes records at kError and above)
+// and from EndBatch once flush_interval has passed. The preamble is passed
+// on in frames of its own.
+class CompressedLogWriter final : public LogWriter
+{
+public:
+    CompressedLogWriter(const LogCompressionSettings& settings,
+                        std::unique_ptr<LogWriter> writer);
+    CompressedLogWriter(const CompressedLogWriter&) = delete;
+    CompressedLogWriter(CompressedLogWriter&&) = delete;
+    ~CompressedLogWriter() override;
+
+    bool Open(std::string_view path) override;
+    void Close() override;
+
+    bool Write(std::string_view data) override;
+    void Flush() override;
+    void EndBatch() override;
+
+    void AddPreamble(std::string_view data) override;
+
+    CompressedLogWriter& operator=(const CompressedLogWriter&) = delete;
+    CompressedLogWriter& operator=(CompressedLogWriter&&) = delete;
+
+private:
+    bool WriteFrame();
+    void EncodeFrame(std::string_view block, std::string& frame);
+
+private:
+    LogCompressionSettings      m_settings;
+    std::unique_ptr<LogWriter>  m_writer;
+
+    std::string                 m_block;
+    std::chrono::steady_clock::time_point m_block_started;
+
+    std::string                 m_frame;
+    std::vector<std::uint32_t>  m_hash_table;
+};
+
+}
+
+#endif // HOOHAHA_CORE_LOG_COMPRESSION_H_
@@ -0,0 +1,220 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "log_fields.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+#include "log_binary.h"
+
+namespace core
+{
+
+namespace
+{
+
+template <class T>
+void AppendNumber(std::string& output, T value)
+{
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    output.append(buffer, result.ptr);
+}
+
+template <class T>
+void AppendJsonNumber(std::string& output, T value)
+{
+    if (!std::isfinite(value))
+    {
+        output += "null";
+        return;
+    }
+
+    AppendNumber(output, value);
+}
+
+} // namespace
+
+void AppendLogJsonString(std::string& output, std::string_view value)
+{
+    static const char kHexDigits[] = "0123456789abcdef";
+
+    output += '"';
+
+    for (const char c : value)
+    {
+        switch (c)
+        {
+        case '"':
+            output += "\\\"";
+            break;
+        case '\\':
+            output += "\\\\";
+            break;
+        case '\n':
+            output += "\\n";
+            break;
+        case '\r':
+            output += "\\r";
+            break;
+        case '\t':
+            output += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                output += "\\u00";
+                output += kHexDigits[c >> 4];
+                output += kHexDigits[c & 0xf];
+            }
+            else
+            {
+                output += c;
+            }
+            break;
+        }
+    }
+
+    output += '"';
+}
+
+void AppendLogFieldsText(std::string& output,
+                         std::span<const LogField> fields)
+{
+    for (const auto& field : fields)
+    {
+        output += ' ';
+        output += field.GetName();
+        output += '=';
+
+        switch (field.GetType())
+        {
+        case LogFieldType::kBool:
+            output += field.GetBool() ? "true" : "false";
+            break;
+        case LogFieldType::kInt64:
+            AppendNumber(output, field.GetInt());
+            break;
+        case LogFieldType::kUInt64:
+            AppendNumber(output, field.GetUInt());
+            break;
+        case LogFieldType::kDouble:
+            AppendNumber(output, field.GetDouble());
+            break;
+        case LogFieldType::kString:
+            AppendLogJsonString(output, field.GetString());
+            break;
+        case LogFieldType::kVector3:
+            output += '(';
+            AppendNumber(output, field.GetVector()[0]);
+            output += ',';
+            AppendNumber(output, field.GetVector()[1]);
+            output += ',';
+            AppendNumber(output, field.GetVector()[2]);
+            output += ')';
+            break;
+        }
+    }
+}
+
+void AppendLogFieldsJson(std::string& output,
+                         std::span<const LogField> fields)
+{
+    bool first = true;
+
+    for (const auto& field : fields)
+    {
+        if (!first)
+        {
+            output += ',';
+        }
+        first = false;
+
+        AppendLogJsonString(output, field.GetName());
+        output += ':';
+
+        switch (field.GetType())
+        {
+        case LogFieldType::kBool:
+            output += field.GetBool() ? "true" : "false";
+            break;
+        case LogFieldType::kInt64:
+            AppendNumber(output, field.GetInt());
+            break;
+        case LogFieldType::kUInt64:
+            AppendNumber(output, field.GetUInt());
+            break;
+        case LogFieldType::kDouble:
+            AppendJsonNumber(output, field.GetDouble());
+            break;
+        case LogFieldType::kString:
+            AppendLogJsonString(output, field.GetString());
+            break;
+        case LogFieldType::kVector3:
+            output += '[';
+            AppendJsonNumber(output, field.GetVector()[0]);
+            output += ',';
+            AppendJsonNumber(output, field.GetVector()[1]);
+            output += ',';
+            AppendJsonNumber(output, field.GetVector()[2]);
+            output += ']';
+            break;
+        }
+    }
+}
+
+void EncodeLogFields(std::string& output, std::span<const LogField> fields)
+{
+    // the count is a single byte, the rest is cut off
+    fields = fields.first(std::min<std::size_t>(fields.size(), 255));
+    AppendLogBinaryValue(output, static_cast<std::uint8_t>(fields.size()));
+
+    for (const auto& field : fields)
+    {
+        AppendLogBinaryString(output, field.GetName());
+
+        switch (field.GetType())
+        {
+        case LogFieldType::kBool:
+            EncodeLogArgument(output, field.GetBool());
+            break;
+        case LogFieldType::kInt64:
+            EncodeLogArgument(output, field.GetInt());
+            break;
+        case LogFieldType::kUInt64:
+            EncodeLogArgument(output, field.GetUInt());
+            break;
+        case LogFieldType::kDouble:
+            EncodeLogArgument(output, field.GetDouble());
+            break;
+        case LogFieldType::kString:
+            EncodeLogArgument(output, field.GetString());
+            break;
+        case LogFieldType::kVector3:
+            AppendLogBinaryValue(output, LogArgumentType::kVector3);
+            AppendLogBinaryValue(output, field.GetVector()[0]);
+            AppendLogBinaryValue(output, field.GetVector()[1]);
+            AppendLogBinaryValue(output, field.GetVector()[2]);
+            break;
+        }
+    }
+}
+
+}
@@ -0,0 +1,187 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOOHAHA_CORE_LOG_FIELDS_H_
+#define HOOHAHA_CORE_LOG_FIELDS_H_
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "mathlib.h"
+
+namespace core
+{
+
+enum class LogFieldType : std::uint8_t
+{
+    kBool,
+    kInt64,
+    kUInt64,
+    kDouble,
+    kString,
+    kVector3
+};
+
+// Named, typed value of a structured record, see Log::WriteFields. A field
+// only holds views, names and strings have to outlive the call, which they
+// do when the fields are built in its argument list.
+class LogField final
+{
+public:
+    constexpr LogField(std::string_view name, bool value)
+        : m_name(name)
+        , m_type(LogFieldType::kBool)
+        , m_uint_value(value ? 1 : 0)
+    {
+    }
+
+    template <class T>
+        requires(std::is_integral_v<T> && std::is_signed_v<T>)
+    constexpr LogField(std::string_view name, T value)
+        : m_name(name)
+        , m_type(LogFieldType::kInt64)
+        , m_int_value(value)
+    {
+    }
+
+    template <class T>
+        requires(std::is_integral_v<T> && std::is_unsigned_v<T> &&
+                 !std::is_same_v<T, bool>)
+    constexpr LogField(std::string_view name, T value)
+        : m_name(name)
+        , m_type(LogFieldType::kUInt64)
+        , m_uint_value(value)
+    {
+    }
+
+    template <class T>
+        requires std::is_floating_point_v<T>
+    constexpr LogField(std::string_view name, T value)
+        : m_name(name)
+        , m_type(LogFieldType::kDouble)
+        , m_double_value(static_cast<double>(value))
+    {
+    }
+
+    constexpr LogField(std::string_view name, std::string_view value)
+        : m_name(name)
+        , m_type(LogFieldType::kString)
+        , m_uint_value(0)
+        , m_string_value(value)
+    {
+    }
+
+    constexpr LogField(std::string_view name, const char* value)
+        : LogField(name, std::string_view(value ? value : ""))
+    {
+    }
+
+    LogField(std::string_view name, const std::string& value)
+        : LogField(name, std::string_view(value))
+    {
+    }
+
+    LogField(std::string_view name, const Vector3d& value)
+        : m_name(name)
+        , m_type(LogFieldType::kVector3)
+        , m_vector_value{ value.X(), value.Y(), value.Z() }
+    {
+    }
+
+    std::string_view GetName() const
+    {
+        return m_name;
+    }
+
+    LogFieldType GetType() const
+    {
+        return m_type;
+    }
+
+    bool GetBool() const
+    {
+        return m_uint_value != 0;
+    }
+
+    std::int64_t GetInt() const
+    {
+        return m_int_value;
+    }
+
+    std::uint64_t GetUInt() const
+    {
+        return m_uint_value;
+    }
+
+    double GetDouble() const
+    {
+        return m_double_value;
+    }
+
+    std::string_view GetString() const
+    {
+        return m_string_value;
+    }
+
+    const float* GetVector() const
+    {
+        return m_vector_value;
+    }
+
+private:
+    std::string_view  m_name;
+    LogFieldType      m_type;
+
+    union
+    {
+        std::int64_t   m_int_value;
+        std::uint64_t  m_uint_value;
+        double         m_double_value;
+        float          m_vector_value[3];
+    };
+
+    std::string_view  m_string_value;
+};
+
+// The encoders append to a buffer that is reused between records and never
+// build temporary strings, so a record costs no allocation once the buffer
+// has grown to fit it.
+
+// " name=value" for every field. Strings are quoted and escaped like JSON
+// strings, vectors are written as (x,y,z).
+void AppendLogFieldsText(std::string& output,
+                         std::span<const LogField> fields);
+
+// "name":value for every field, separated by commas. Vectors are [x,y,z],
+// non finite numbers null.
+void AppendLogFieldsJson(std::string& output,
+                         std::span<const LogField> fields);
+
+// u8 count, then every field as u32 + name and a LogArgumentType tagged
+// value, see log_binary.h
+void EncodeLogFields(std::string& output, std::span<const LogField> fields);
+
+// Quoted and escaped JSON string
+void AppendLogJsonString(std::string& output, std::string_view value);
+
+}
+
+#endif // HOOHAHA_CORE_LOG_FIELDS_H_
@@ -0,0 +1,519 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "log_flight_recorder.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace core
+{
+
+// Records are stored back to back as the text followed by its u32 length,
+// so the newest record can always be found from the write position and the
+// ring is read backwards from there.
+struct LogFlightRecorderRing
+{
+    explicit LogFlightRecorderRing(std::size_t ring_size)
+        : buffer(new char[ring_size])
+        , size(ring_size)
+        , position(0)
+        , in_use(true)
+    {
+    }
+
+    std::unique_ptr<char[]>     buffer;
+    const std::size_t           size;
+    // total number of bytes written, only the owning thread writes
+    std::atomic<std::uint64_t>  position;
+    // false once the owning thread has exited and the ring can be reused
+    std::atomic<bool>           in_use;
+};
+
+namespace
+{
+
+const std::size_t kMinRingSize = 4 * 1024;
+
+using RecordLength = std::uint32_t;
+
+// The ring the current thread records into, released when the thread exits
+struct ThreadRing
+{
+    ~ThreadRing()
+    {
+        if (ring)
+        {
+            ring->in_use.store(false, std::memory_order_release);
+        }
+    }
+
+    std::uint64_t                           recorder_id = 0;
+    std::shared_ptr<LogFlightRecorderRing>  ring;
+};
+
+thread_local ThreadRing t_thread_ring;
+
+std::atomic<std::uint64_t> g_last_recorder_id(0);
+
+void (*g_crash_callback)() = nullptr;
+std::atomic<bool> g_crash_handled(false);
+
+void CopyToRing(LogFlightRecorderRing& ring, std::uint64_t position,
+                const void* data, std::size_t size)
+{
+    const auto offset = static_cast<std::size_t>(position % ring.size);
+    const auto first = std::min(size, ring.size - offset);
+
+    std::memcpy(&ring.buffer[offset], data, first);
+    std::memcpy(&ring.buffer[0], static_cast<const char*>(data) + first,
+                size - first);
+}
+
+void CopyFromRing(const LogFlightRecorderRing& ring, std::uint64_t position,
+                  void* data, std::size_t size)
+{
+    const auto offset = static_cast<std::size_t>(position % ring.size);
+    const auto first = std::min(size, ring.size - offset);
+
+    std::memcpy(data, &ring.buffer[offset], first);
+    std::memcpy(static_cast<char*>(data) + first, &ring.buffer[0],
+                size - first);
+}
+
+// "[timestamp]" at the beginning of a text record
+std::string_view GetRecordTimestamp(std::string_view record)
+{
+    return record.substr(0, record.find(']'));
+}
+
+void HandleCrash()
+{
+    if (g_crash_callback && !g_crash_handled.exchange(true))
+    {
+        g_crash_callback();
+    }
+}
+
+void CrashSignalHandler(int signal)
+{
+    HandleCrash();
+
+    // the default action has been restored, raising it again terminates the
+    // process the way it would have without us
+    std::signal(signal, SIG_DFL);
+    std::raise(signal);
+}
+
+#ifdef _WIN32
+
+LONG WINAPI UnhandledExceptionHandler(EXCEPTION_POINTERS*)
+{
+    HandleCrash();
+    return EXCEPTION_CONTINUE_SEARCH;
+}
+
+#endif // _WIN32
+
+} // namespace
+
+LogFlightRecorder::LogFlightRecorder(std::size_t ring_size)
+    : m_id(++g_last_recorder_id)
+    , m_ring_size(std::max(ring_size, kMinRingSize))
+    , m_crash_rings()
+    , m_crash_ring_count(0)
+    , m_crash_buffer_size(0)
+#ifdef _WIN32
+    , m_crash_file(INVALID_HANDLE_VALUE)
+#else
+    , m_crash_file(-1)
+#endif
+{
+}
+
+LogFlightRecorder::~LogFlightRecorder()
+{
+    CloseCrashDump();
+}
+
+void LogFlightRecorder::SetRingSize(std::size_t ring_size)
+{
+    m_ring_size.store(std::max(ring_size, kMinRingSize),
+                      std::memory_order_relaxed);
+}
+
+void LogFlightRecorder::Record(std::string_view text)
+{
+    auto& ring = GetThreadRing();
+
+    // a record larger than the ring keeps its beginning
+    const auto length = static_cast<RecordLength>(
+        std::min(text.size(), ring.size - sizeof(RecordLength)));
+
+    const auto position = ring.position.load(std::memory_order_relaxed);
+    CopyToRing(ring, position, text.data(), length);
+    CopyToRing(ring, position + length, &length, sizeof(length));
+
+    ring.position.store(position + length + sizeof(length),
+                        std::memory_order_release);
+}
+
+void LogFlightRecorder::Collect(std::string& output) const
+{
+    std::vector<std::shared_ptr<LogFlightRecorderRing>> rings;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        rings = m_rings;
+    }
+
+    std::string snapshot;
+    // offset and size of every record in the snapshot
+    std::vector<std::pair<std::size_t, std::size_t>> records;
+
+    for (const auto& ring : rings)
+    {
+        const auto end = ring->position.load(std::memory_order_acquire);
+        const auto begin = end - std::min<std::uint64_t>(end, ring->size);
+        const auto base = snapshot.size();
+
+        snapshot.resize(base + static_cast<std::size_t>(end - begin));
+        CopyFromRing(*ring, begin, &snapshot[base],
+                     static_cast<std::size_t>(end - begin));
+
+        // whatever the owner wrote during the copy overwrote the oldest bytes
+        const auto written = ring->position.load(std::memory_order_acquire);
+        const auto valid = std::max<std::uint64_t>(
+            begin, written > ring->size ? written - ring->size : 0);
+
+        const auto first_record = records.size();
+        auto position = end;
+
+        while (position >= valid + sizeof(RecordLength))
+        {
+            RecordLength length;
+            position -= sizeof(RecordLength);
+            std::memcpy(&length, &snapshot[base + (position - begin)],
+                        sizeof(length));
+
+            if (length > position - valid)
+            {
+                break;
+            }
+
+            position -= length;
+            records.emplace_back(
+                base + static_cast<std::size_t>(position - begin), length);
+        }
+
+        std::reverse(records.begin() + first_record, records.end());
+    }
+
+    std::vector<std::string_view> texts;
+    texts.reserve(records.size());
+
+    for (const auto& [offset, size] : records)
+    {
+        texts.emplace_back(snapshot.data() + offset, size);
+    }
+
+    // the timestamps are fixed width, so they sort as strings
+    std::stable_sort(texts.begin(), texts.end(),
+        [](std::string_view left, std::string_view right)
+        {
+            return GetRecordTimestamp(left) < GetRecordTimestamp(right);
+        });
+
+    for (const auto text : texts)
+    {
+        output += text;
+    }
+}
+
+bool LogFlightRecorder::PrepareCrashDump(std::string_view path)
+{
+    CloseCrashDump();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // rings keep their size until their thread records again, so the
+    // buffer fits the largest one there is
+    auto buffer_size = m_ring_size.load(std::memory_order_relaxed);
+    for (const auto& ring : m_rings)
+    {
+        buffer_size = std::max(buffer_size, ring->size);
+    }
+
+    if (buffer_size > m_crash_buffer_size)
+    {
+        m_crash_buffer.reset(new char[buffer_size]);
+        m_crash_buffer_size = buffer_size;
+    }
+
+    PublishCrashRings();
+    m_retired_rings.clear();
+
+#ifdef _WIN32
+    if (path.empty())
+    {
+        HANDLE file = INVALID_HANDLE_VALUE;
+        if (DuplicateHandle(GetCurrentProcess(), GetStdHandle(STD_ERROR_HANDLE),
+                            GetCurrentProcess(), &file, 0, FALSE,
+                            DUPLICATE_SAME_ACCESS))
+        {
+            m_crash_file = file;
+        }
+    }
+    else
+    {
+        m_crash_file = CreateFileA(std::string(path).c_str(), FILE_APPEND_DATA,
+                                   FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                   OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                                   nullptr);
+    }
+
+    return m_crash_file != INVALID_HANDLE_VALUE;
+#else
+    if (path.empty())
+    {
+        m_crash_file = fcntl(STDERR_FILENO, F_DUPFD_CLOEXEC, 0);
+    }
+    else
+    {
+        m_crash_file = open(std::string(path).c_str(),
+                            O_WRONLY | O_APPEND | O_CLOEXEC);
+    }
+
+    return m_crash_file >= 0;
+#endif
+}
+
+void LogFlightRecorder::CloseCrashDump()
+{
+#ifdef _WIN32
+    if (m_crash_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_crash_file);
+        m_crash_file = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_crash_file >= 0)
+    {
+        close(m_crash_file);
+        m_crash_file = -1;
+    }
+#endif
+}
+
+void LogFlightRecorder::WriteCrashDump(std::string_view header,
+                                       std::string_view footer) const
+{
+    if (!m_crash_buffer)
+    {
+        return;
+    }
+
+    WriteCrashData(header.data(), header.size());
+
+    const auto ring_count = std::min(
+        m_crash_ring_count.load(std::memory_order_acquire), kMaxCrashRings);
+
+    for (std::size_t index = 0; index < ring_count; ++index)
+    {
+        const auto* ring = m_crash_rings[index].load(std::memory_order_acquire);
+        if (!ring)
+        {
+            continue;
+        }
+
+        const auto capacity = std::min(ring->size, m_crash_buffer_size);
+        const auto end = ring->position.load(std::memory_order_acquire);
+        const auto begin = end - std::min<std::uint64_t>(end, capacity);
+        auto* buffer = m_crash_buffer.get();
+
+        CopyFromRing(*ring, begin, buffer,
+                     static_cast<std::size_t>(end - begin));
+
+        const auto written = ring->position.load(std::memory_order_acquire);
+        const auto valid = std::max<std::uint64_t>(
+            begin, written > ring->size ? written - ring->size : 0);
+
+        // the texts are moved towards the end of the buffer over the
+        // lengths that follow them, newest first, so the records of the ring
+        // end up in one contiguous block
+        auto position = end;
+        auto output = static_cast<std::size_t>(end - begin);
+
+        while (position >= valid + sizeof(RecordLength))
+        {
+            RecordLength length;
+            position -= sizeof(RecordLength);
+            std::memcpy(&length, &buffer[position - begin], sizeof(length));
+
+            if (length > position - valid)
+            {
+                break;
+            }
+
+            position -= length;
+            output -= length;
+            std::memmove(&buffer[output], &buffer[position - begin], length);
+        }
+
+        WriteCrashData(&buffer[output],
+                       static_cast<std::size_t>(end - begin) - output);
+    }
+
+    WriteCrashData(footer.data(), footer.size());
+}
+
+LogFlightRecorderRing& LogFlightRecorder::GetThreadRing()
+{
+    auto& thread_ring = t_thread_ring;
+    const auto ring_size = m_ring_size.load(std::memory_order_relaxed);
+
+    if (thread_ring.recorder_id == m_id && thread_ring.ring->size == ring_size)
+    {
+        return *thread_ring.ring;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (thread_ring.ring)
+    {
+        thread_ring.ring->in_use.store(false, std::memory_order_release);
+        thread_ring.ring.reset();
+    }
+
+    // Rings of exited threads are reused, the ones left with an old size
+    // are dropped after the crash dump has stopped looking at them. A crash
+    // handler may have loaded one already, so they are only freed by the
+    // next PrepareCrashDump.
+    m_crash_ring_count.store(0, std::memory_order_release);
+    const auto retired = std::stable_partition(m_rings.begin(), m_rings.end(),
+        [ring_size](const std::shared_ptr<LogFlightRecorderRing>& ring)
+        {
+            return ring->size == ring_size ||
+                   ring->in_use.load(std::memory_order_acquire);
+        });
+    std::move(retired, m_rings.end(), std::back_inserter(m_retired_rings));
+    m_rings.erase(retired, m_rings.end());
+
+    for (const auto& ring : m_rings)
+    {
+        if (!ring->in_use.load(std::memory_order_acquire))
+        {
+            ring->in_use.store(true, std::memory_order_relaxed);
+            thread_ring.ring = ring;
+            break;
+        }
+    }
+
+    if (!thread_ring.ring)
+    {
+        thread_ring.ring = std::make_shared<LogFlightRecorderRing>(ring_size);
+        m_rings.push_back(thread_ring.ring);
+    }
+
+    PublishCrashRings();
+
+    thread_ring.recorder_id = m_id;
+    return *thread_ring.ring;
+}
+
+void LogFlightRecorder::PublishCrashRings()
+{
+    const auto ring_count = std::min(m_rings.size(), kMaxCrashRings);
+
+    for (std::size_t index = 0; index < ring_count; ++index)
+    {
+        m_crash_rings[index].store(m_rings[index].get(),
+                                   std::memory_order_relaxed);
+    }
+
+    m_crash_ring_count.store(ring_count, std::memory_order_release);
+}
+
+void LogFlightRecorder::WriteCrashData(const char* data,
+                                       std::size_t size) const
+{
+    while (size > 0)
+    {
+#ifdef _WIN32
+        DWORD written = 0;
+        if (!WriteFile(m_crash_file, data, static_cast<DWORD>(size), &written,
+                       nullptr) || written == 0)
+        {
+            return;
+        }
+#else
+        const auto written = write(m_crash_file, data, size);
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (written <= 0)
+        {
+            return;
+        }
+#endif
+
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+void InstallLogCrashHandler(void (*callback)())
+{
+    g_crash_callback = callback;
+
+#ifdef _WIN32
+    SetUnhandledExceptionFilter(UnhandledExceptionHandler);
+    std::signal(SIGABRT, CrashSignalHandler);
+#else
+    struct sigaction action = {};
+    action.sa_handler = CrashSignalHandler;
+    action.sa_flags = SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+
+    for (const int signal : { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT })
+    {
+        sigaction(signal, &action, nullptr);
+    }
+#endif
+}
+
+}
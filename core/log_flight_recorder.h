@@ -0,0 +1,124 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOOHAHA_CORE_LOG_FLIGHT_RECORDER_H_
+#define HOOHAHA_CORE_LOG_FLIGHT_RECORDER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace core
+{
+
+struct LogFlightRecorderSettings
+{
+    // keep the recent records of every thread in memory, at all levels
+    bool         enabled = false;
+    // ring size of every thread in bytes
+    std::size_t  ring_size = 256 * 1024;
+    // dump the rings when the process crashes, to the log file when it is a
+    // plain uncompressed stdio file and to stderr otherwise
+    bool         crash_handler = true;
+};
+
+struct LogFlightRecorderRing;
+
+// Per-thread rings of the most recent text records. Recording is a memcpy
+// into the calling thread's own ring, it takes no lock and does no I/O. A
+// ring is only locked once, when a thread records for the first time.
+//
+// Collect and WriteCrashDump read the rings while their threads may still be
+// writing, records that get overwritten during the copy are dropped. They
+// are meant for dumps taken on fatal errors and crashes, where a best effort
+// snapshot is all we can get anyway.
+class LogFlightRecorder final
+{
+public:
+    explicit LogFlightRecorder(std::size_t ring_size);
+    LogFlightRecorder(const LogFlightRecorder&) = delete;
+    LogFlightRecorder(LogFlightRecorder&&) = delete;
+    ~LogFlightRecorder();
+
+    // applies to the rings of threads that record afterwards
+    void SetRingSize(std::size_t ring_size);
+
+    void Record(std::string_view text);
+
+    // appends the records of all threads to output, ordered by timestamp
+    void Collect(std::string& output) const;
+
+    // Allocates the buffer WriteCrashDump copies the rings into and opens
+    // the file it writes to, the file at path or a duplicate of stderr when
+    // path is empty. Call it again after changing the ring size.
+    bool PrepareCrashDump(std::string_view path);
+    void CloseCrashDump();
+
+    // Writes the records of all threads to the file opened by
+    // PrepareCrashDump, thread by thread and oldest first. Takes no lock,
+    // allocates nothing and only calls write/WriteFile, so it can be called
+    // from a signal handler.
+    void WriteCrashDump(std::string_view header,
+                        std::string_view footer) const;
+
+    LogFlightRecorder& operator=(const LogFlightRecorder&) = delete;
+    LogFlightRecorder& operator=(LogFlightRecorder&&) = delete;
+
+private:
+    static constexpr std::size_t kMaxCrashRings = 256;
+
+    LogFlightRecorderRing& GetThreadRing();
+    void PublishCrashRings();
+    void WriteCrashData(const char* data, std::size_t size) const;
+
+private:
+    const std::uint64_t       m_id;
+    std::atomic<std::size_t>  m_ring_size;
+
+    mutable std::mutex        m_mutex;
+    std::vector<std::shared_ptr<LogFlightRecorderRing>> m_rings;
+    // rings dropped from m_rings, kept until PrepareCrashDump in case a
+    // crash dump still reads them
+    std::vector<std::shared_ptr<LogFlightRecorderRing>> m_retired_rings;
+
+    // copy of m_rings the crash dump can walk without the mutex
+    std::atomic<LogFlightRecorderRing*> m_crash_rings[kMaxCrashRings];
+    std::atomic<std::size_t>            m_crash_ring_count;
+
+    std::unique_ptr<char[]>   m_crash_buffer;
+    std::size_t               m_crash_buffer_size;
+#ifdef _WIN32
+    void*                     m_crash_file;
+#else
+    int                       m_crash_file;
+#endif
+};
+
+// Calls callback once when the process is about to die because of a fatal
+// signal (POSIX) or an unhandled structured exception (Windows), then lets
+// the default handling terminate the process.
+void InstallLogCrashHandler(void (*callback)());
+
+}
+
+#endif // HOOHAHA_CORE_LOG_FLIGHT_RECORDER_H_
@@ -0,0 +1,205 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "log_queue.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace core
+{
+
+namespace
+{
+
+// set in the enqueue position while there are overflow records
+const std::size_t kOverflowFlag =
+    std::size_t{ 1 } << (std::numeric_limits<std::size_t>::digits - 1);
+
+inline std::size_t RoundUpToPowerOfTwo(std::size_t value)
+{
+    std::size_t result = 2;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+void LogRecord::Assign(LogLevel record_level, bool record_to_file,
+                       std::string_view text)
+{
+    level = record_level;
+    to_file = record_to_file;
+    size = text.size();
+
+    if (size <= kInlineSize)
+    {
+        heap_text.reset();
+        std::memcpy(inline_text, text.data(), size);
+    }
+    else
+    {
+        heap_text = std::make_unique<char[]>(size);
+        std::memcpy(heap_text.get(), text.data(), size);
+    }
+}
+
+std::string_view LogRecord::Text() const
+{
+    return { heap_text ? heap_text.get() : inline_text, size };
+}
+
+LogQueue::LogQueue(std::size_t capacity)
+    : m_mask(RoundUpToPowerOfTwo(capacity) - 1)
+    , m_enqueue_position(0)
+    , m_dequeue_position(0)
+{
+    m_cells = std::make_unique<Cell[]>(m_mask + 1);
+
+    for (std::size_t i = 0; i <= m_mask; ++i)
+    {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        m_cells[i].record.level = LogLevel::kInfo;
+        m_cells[i].record.to_file = true;
+        m_cells[i].record.size = 0;
+    }
+}
+
+LogQueue::~LogQueue()
+{
+}
+
+std::size_t LogQueue::Capacity() const
+{
+    return m_mask + 1;
+}
+
+bool LogQueue::TryPush(LogLevel level, bool to_file, std::string_view text)
+{
+    Cell* cell;
+    std::size_t position = m_enqueue_position.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        // The writer takes the overflow after the ring, so nothing may pass
+        // the records waiting there. The flag is part of the position, a
+        // claim racing with PushOverflow fails its CAS and sees it here.
+        if ((position & kOverflowFlag) != 0)
+        {
+            return false;
+        }
+
+        cell = &m_cells[position & m_mask];
+
+        const std::size_t sequence =
+            cell->sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::intptr_t>(sequence) -
+                                static_cast<std::intptr_t>(position);
+
+        if (difference == 0)
+        {
+            if (m_enqueue_position.compare_exchange_weak(
+                    position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            // the consumer has not released this cell yet, the ring is full
+            return false;
+        }
+        else
+        {
+            position = m_enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->record.Assign(level, to_file, text);
+    cell->sequence.store(position + 1, std::memory_order_release);
+
+    return true;
+}
+
+void LogQueue::PushOverflow(LogLevel level, bool to_file,
+                            std::string_view text)
+{
+    std::unique_lock<std::mutex> lock(m_overflow_mutex);
+    m_overflow.emplace_back(level, to_file, std::string(text));
+    m_enqueue_position.fetch_or(kOverflowFlag, std::memory_order_relaxed);
+}
+
+const LogRecord* LogQueue::Peek() const
+{
+    const Cell& cell = m_cells[m_dequeue_position & m_mask];
+
+    const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    if (sequence != m_dequeue_position + 1)
+    {
+        return nullptr;
+    }
+
+    return &cell.record;
+}
+
+void LogQueue::Pop()
+{
+    Cell& cell = m_cells[m_dequeue_position & m_mask];
+
+    assert(cell.sequence.load(std::memory_order_relaxed) ==
+           m_dequeue_position + 1);
+
+    cell.sequence.store(m_dequeue_position + m_mask + 1,
+                        std::memory_order_release);
+    m_dequeue_position++;
+}
+
+bool LogQueue::IsEmpty() const
+{
+    // also false for cells that are claimed but not published yet
+    return m_enqueue_position.load(std::memory_order_acquire) ==
+           m_dequeue_position;
+}
+
+bool LogQueue::TakeOverflow(std::vector<OverflowRecord>& records)
+{
+    const std::size_t position =
+        m_enqueue_position.load(std::memory_order_acquire);
+
+    // the records claimed before the overflow started go first, Peek does
+    // not see them until their producers publish them
+    if ((position & kOverflowFlag) == 0 ||
+        (position & ~kOverflowFlag) != m_dequeue_position)
+    {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(m_overflow_mutex);
+    records.swap(m_overflow);
+    m_overflow.clear();
+    m_enqueue_position.fetch_and(~kOverflowFlag, std::memory_order_release);
+
+    return !records.empty();
+}
+
+}
@@ -0,0 +1,109 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOOHAHA_CORE_LOG_QUEUE_H_
+#define HOOHAHA_CORE_LOG_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "log.h"
+
+namespace core
+{
+
+// A single formatted log line. Short lines are stored inline in the queue
+// cell, longer ones spill into a heap block owned by the record.
+struct LogRecord
+{
+    static constexpr std::size_t kInlineSize = 464;
+
+    LogLevel                 level;
+    // false for records only wanted by the sinks
+    bool                     to_file;
+    std::size_t              size;
+    std::unique_ptr<char[]>  heap_text;
+    char                     inline_text[kInlineSize];
+
+    void Assign(LogLevel record_level, bool record_to_file,
+                std::string_view text);
+    std::string_view Text() const;
+};
+
+// Bounded multi-producer single-consumer ring buffer of log records.
+// Producers claim cells with a single CAS on the enqueue position and publish
+// them through a per-cell sequence number, so they never take a lock. The
+// only consumer is the log writer thread.
+class LogQueue final
+{
+public:
+    // level, to_file and text, see LogRecord
+    using OverflowRecord = std::tuple<LogLevel, bool, std::string>;
+
+    explicit LogQueue(std::size_t capacity);
+    LogQueue(const LogQueue&) = delete;
+    LogQueue(LogQueue&&) = delete;
+    ~LogQueue();
+
+    std::size_t Capacity() const;
+
+    // producer side, safe to call from any thread. TryPush fails while
+    // there are overflow records, so records keep their order.
+    bool TryPush(LogLevel level, bool to_file, std::string_view text);
+    void PushOverflow(LogLevel level, bool to_file, std::string_view text);
+
+    // consumer side, writer thread only
+    const LogRecord* Peek() const;
+    void Pop();
+    bool IsEmpty() const;
+    // waits with the overflow until the records claimed before it are
+    // popped, fails until then
+    bool TakeOverflow(std::vector<OverflowRecord>& records);
+
+    LogQueue& operator=(const LogQueue&) = delete;
+    LogQueue& operator=(LogQueue&&) = delete;
+
+private:
+    struct alignas(64) Cell
+    {
+        std::atomic<std::size_t>  sequence;
+        LogRecord                 record;
+    };
+
+    std::unique_ptr<Cell[]>  m_cells;
+    std::size_t              m_mask;
+
+    // the top bit is set while there are overflow records, so a producer
+    // cannot claim a cell once the first one went to the overflow
+    alignas(64) std::atomic<std::size_t>  m_enqueue_position;
+    alignas(64) std::size_t               m_dequeue_position;
+
+    // records that did not fit into the ring with the kGrow overflow policy
+    alignas(64) std::mutex                m_overflow_mutex;
+    std::vector<OverflowRecord>           m_overflow;
+};
+
+}
+
+#endif // HOOHAHA_CORE_LOG_QUEUE_H_
@@ -0,0 +1,908 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "log_reader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "mapped_file.h"
+#include "timestamp.h"
+
+namespace core
+{
+
+namespace
+{
+
+const std::size_t kIndexBlockSize = 256 * 1024;
+// blocks a query may scan ahead of the one being reported, per thread
+const std::size_t kQueryBlocksAhead = 4;
+
+constexpr char kIndexMagic[8] = { 'H', 'H', 'L', 'O', 'G', 'I', 'D', 'X' };
+constexpr std::uint32_t kIndexVersion = 2;
+
+struct LogIndexBlock
+{
+    std::uint64_t               offset;
+    std::uint64_t               size;
+    std::int64_t                first_time;
+    std::int64_t                last_time;
+    // one bit per LogLevel
+    std::uint8_t                levels;
+    std::vector<std::uint64_t>  threads;
+};
+
+inline std::uint8_t GetLevelBit(LogLevel level)
+{
+    return static_cast<std::uint8_t>(1u << static_cast<unsigned int>(level));
+}
+
+inline std::string_view GetLine(std::string_view data, std::size_t position)
+{
+    const auto end = data.find('\n', position);
+    return data.substr(position, end == std::string_view::npos
+                                     ? std::string_view::npos
+                                     : end - position + 1);
+}
+
+inline std::string_view TrimLineBreak(std::string_view text)
+{
+    while (!text.empty() && (text.back() == '\n' || text.back() == '\r'))
+    {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+// the "log started" and "log closed" lines separate records too
+inline bool IsSeparatorLine(std::string_view line)
+{
+    return line.starts_with("----------------");
+}
+
+// Reads the record starting at position, which must be a record line, up to
+// limit. Returns where the next line that is not part of it starts.
+std::size_t ReadRecord(std::string_view data, std::size_t position,
+                       std::size_t limit, LogRecordView& record)
+{
+    auto next = position + GetLine(data, position).size();
+
+    while (next < limit)
+    {
+        const auto line = GetLine(data, next);
+        LogRecordView next_record;
+        if (IsSeparatorLine(line) || ParseLogRecord(line, next_record))
+        {
+            break;
+        }
+        next += line.size();
+    }
+
+    next = std::min(next, limit);
+    record.text = TrimLineBreak(data.substr(position, next - position));
+    return next;
+}
+
+// First line at or after position that starts a record or a separator
+std::size_t FindRecordStart(std::string_view data, std::size_t position)
+{
+    if (position > 0 && position < data.size() && data[position - 1] != '\n')
+    {
+        position = data.find('\n', position);
+        if (position == std::string_view::npos)
+        {
+            return data.size();
+        }
+        position++;
+    }
+
+    while (position < data.size())
+    {
+        const auto line = GetLine(data, position);
+        LogRecordView record;
+        if (IsSeparatorLine(line) || ParseLogRecord(line, record))
+        {
+            return position;
+        }
+        position += line.size();
+    }
+
+    return data.size();
+}
+
+bool MatchesQuery(const LogRecordView& record, const LogQuery& query)
+{
+    return record.time >= query.begin_time && record.time < query.end_time &&
+           record.level <= query.level &&
+           (query.thread == 0 || record.thread == query.thread);
+}
+
+template <class T>
+inline void AppendValue(std::string& output, const T& value)
+{
+    output.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <class T>
+inline bool ReadValue(std::string_view& input, T& value)
+{
+    if (input.size() < sizeof(value))
+    {
+        return false;
+    }
+
+    std::memcpy(&value, input.data(), sizeof(value));
+    input.remove_prefix(sizeof(value));
+    return true;
+}
+
+// A file that ends in a NUL byte is preallocated and still being written
+// (MappedLogWriter, direct VectoredLogWriter). Its writer truncates it
+// later, which would fault a mapping of it with SIGBUS.
+bool IsPreallocated(const std::string& path)
+{
+    auto file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    char last = 1;
+    if (std::fseek(file, -1, SEEK_END) == 0)
+    {
+        std::fread(&last, 1, 1, file);
+    }
+
+    std::fclose(file);
+    return last == '\0';
+}
+
+// Reads a file up to its first NUL byte, a file that shrinks meanwhile
+// only ends the read early
+bool ReadWrittenPart(const std::string& path, std::string& data)
+{
+    auto file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    char buffer[64 * 1024];
+    std::size_t bytes_read;
+    while ((bytes_read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        const auto end = std::find(buffer, buffer + bytes_read, '\0');
+        data.append(buffer, end);
+
+        if (end != buffer + bytes_read)
+        {
+            break;
+        }
+    }
+
+    std::fclose(file);
+    return true;
+}
+
+} // namespace
+
+bool ParseLogRecord(std::string_view line, LogRecordView& record)
+{
+    line = TrimLineBreak(line);
+
+    if (line.size() < 2 || line[0] != '[')
+    {
+        return false;
+    }
+
+    const auto time_end = line.find("][", 1);
+    if (time_end == std::string_view::npos ||
+        !ParseTimestamp(line.substr(1, time_end - 1), record.time))
+    {
+        return false;
+    }
+
+    const auto level_begin = time_end + 2;
+    const auto level_end = line.find("][", level_begin);
+    if (level_end == std::string_view::npos)
+    {
+        return false;
+    }
+
+    auto level = line.substr(level_begin, level_end - level_begin);
+    while (!level.empty() && level.back() == ' ')
+    {
+        level.remove_suffix(1);
+    }
+    if (!LogLevelFromString(level, record.level))
+    {
+        return false;
+    }
+
+    const auto thread_begin = level_end + 2;
+    const auto thread_end = line.find(']', thread_begin);
+    if (thread_end == std::string_view::npos)
+    {
+        return false;
+    }
+
+    // "0003 render", "0003" or the number older logs printed
+    auto thread = line.substr(thread_begin, thread_end - thread_begin);
+    record.thread = 0;
+    while (!thread.empty() && thread.front() >= '0' && thread.front() <= '9')
+    {
+        record.thread = record.thread * 10 + (thread.front() - '0');
+        thread.remove_prefix(1);
+    }
+    if (!thread.empty() && thread.front() == ' ')
+    {
+        thread.remove_prefix(1);
+    }
+    record.thread_name = thread;
+
+    record.text = line;
+    return true;
+}
+
+struct LogReader::Segment
+{
+    std::string                 path;
+    std::uint64_t               file_size = 0;
+    std::int64_t                write_time = 0;
+    MappedFile                  file;
+    // a preallocated segment is read instead of mapped
+    std::string                 contents;
+    // the file up to its first NUL byte, a segment left behind by a crash
+    // still has its preallocated tail
+    std::string_view            data;
+
+    std::vector<LogIndexBlock>  blocks;
+    // thread postings, the blocks every thread has records in
+    std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> thread_blocks;
+    std::unordered_map<std::uint64_t, std::string> thread_names;
+};
+
+LogReader::LogReader(const LogReaderSettings& settings)
+    : m_settings(settings)
+{
+}
+
+LogReader::~LogReader()
+{
+    Close();
+}
+
+bool LogReader::Open(std::string_view path)
+{
+    namespace fs = std::filesystem;
+
+    Close();
+
+    const std::string log_path(path);
+    std::error_code error;
+
+    if (fs::is_regular_file(log_path, error))
+    {
+        return OpenSegment(log_path);
+    }
+
+    // rolled segments, the oldest ones may have been deleted already
+    const fs::path base(log_path);
+    const auto prefix = base.filename().string() + '.';
+    auto directory = base.parent_path();
+    if (directory.empty())
+    {
+        directory = ".";
+    }
+
+    std::vector<std::pair<std::uint64_t, std::string>> segments;
+    for (const auto& entry : fs::directory_iterator(directory, error))
+    {
+        const auto name = entry.path().filename().string();
+        if (!name.starts_with(prefix) || name.size() == prefix.size() ||
+            !std::all_of(name.begin() + prefix.size(), name.end(),
+                         [](char c) { return c >= '0' && c <= '9'; }))
+        {
+            continue;
+        }
+
+        segments.emplace_back(std::stoull(name.substr(prefix.size())),
+                              entry.path().string());
+    }
+
+    if (segments.empty())
+    {
+        return false;
+    }
+
+    std::sort(segments.begin(), segments.end());
+
+    for (const auto& segment : segments)
+    {
+        if (!OpenSegment(segment.second))
+        {
+            Close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void LogReader::Close()
+{
+    m_segments.clear();
+}
+
+std::size_t LogReader::GetSegmentCount() const
+{
+    return m_segments.size();
+}
+
+std::size_t LogReader::GetBlockCount() const
+{
+    std::size_t count = 0;
+    for (const auto& segment : m_segments)
+    {
+        count += segment->blocks.size();
+    }
+    return count;
+}
+
+bool LogReader::FindThread(std::string_view name, std::uint64_t& thread) const
+{
+    for (const auto& segment : m_segments)
+    {
+        for (const auto& [id, thread_name] : segment->thread_names)
+        {
+            if (thread_name == name)
+            {
+                thread = id;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+std::size_t LogReader::Query(const LogQuery& query,
+                             const RecordCallback& callback) const
+{
+    // blocks the index lets through, in file order
+    std::vector<std::pair<const Segment*, const LogIndexBlock*>> candidates;
+
+    const auto levels =
+        static_cast<std::uint8_t>((GetLevelBit(query.level) << 1) - 1);
+
+    const auto accepts = [&query, levels](const LogIndexBlock& block)
+    {
+        return block.last_time >= query.begin_time &&
+               block.first_time < query.end_time && (block.levels & levels) &&
+               (query.thread == 0 ||
+                std::find(block.threads.begin(), block.threads.end(),
+                          query.thread) != block.threads.end());
+    };
+
+    for (const auto& segment : m_segments)
+    {
+        if (query.thread != 0)
+        {
+            const auto postings = segment->thread_blocks.find(query.thread);
+            if (postings == segment->thread_blocks.end())
+            {
+                continue;
+            }
+
+            for (const auto index : postings->second)
+            {
+                if (accepts(segment->blocks[index]))
+                {
+                    candidates.emplace_back(segment.get(),
+                                            &segment->blocks[index]);
+                }
+            }
+        }
+        else
+        {
+            for (const auto& block : segment->blocks)
+            {
+                if (accepts(block))
+                {
+                    candidates.emplace_back(segment.get(), &block);
+                }
+            }
+        }
+    }
+
+    const std::boyer_moore_horspool_searcher searcher(query.text.begin(),
+                                                      query.text.end());
+
+    const auto scan_block = [&query, &searcher](
+        const Segment& segment, const LogIndexBlock& block,
+        std::vector<LogRecordView>& records)
+    {
+        const auto data = segment.data;
+        const auto begin = static_cast<std::size_t>(block.offset);
+        const auto end = static_cast<std::size_t>(block.offset + block.size);
+
+        if (query.text.empty())
+        {
+            auto position = begin;
+            while (position < end)
+            {
+                LogRecordView record;
+                const auto line = GetLine(data, position);
+                if (!ParseLogRecord(line, record))
+                {
+                    position += line.size();
+                    continue;
+                }
+
+                position = ReadRecord(data, position, end, record);
+                if (MatchesQuery(record, query))
+                {
+                    records.push_back(record);
+                }
+            }
+            return;
+        }
+
+        // jump from match to match and only parse the records they are in
+        auto position = begin;
+        while (position < end)
+        {
+            const auto match = std::search(data.begin() + position,
+                                           data.begin() + end, searcher);
+            if (match == data.begin() + end)
+            {
+                break;
+            }
+
+            auto record_begin = data.rfind('\n', match - data.begin());
+            record_begin = record_begin == std::string_view::npos ||
+                                   record_begin < begin
+                               ? begin
+                               : record_begin + 1;
+
+            LogRecordView record;
+            while (!ParseLogRecord(GetLine(data, record_begin), record) &&
+                   record_begin > begin)
+            {
+                // a continuation line, the record starts further up
+                const auto previous =
+                    record_begin >= begin + 2
+                        ? data.rfind('\n', record_begin - 2)
+                        : std::string_view::npos;
+                record_begin = previous == std::string_view::npos ||
+                                       previous < begin
+                                   ? begin
+                                   : previous + 1;
+            }
+
+            if (!ParseLogRecord(GetLine(data, record_begin), record))
+            {
+                // text before the first record, e.g. the log header, goes
+                // on with the line after the match
+                const auto line_end = data.find(
+                    '\n', static_cast<std::size_t>(match - data.begin()));
+                position = line_end == std::string_view::npos
+                               ? end
+                               : std::min(end, line_end + 1);
+                continue;
+            }
+
+            position = ReadRecord(data, record_begin, end, record);
+            if (MatchesQuery(record, query) &&
+                record.text.find(query.text) != std::string_view::npos)
+            {
+                records.push_back(record);
+            }
+        }
+    };
+
+    struct BlockResult
+    {
+        std::vector<LogRecordView>  records;
+        bool                        done = false;
+    };
+
+    std::vector<BlockResult> results(candidates.size());
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::size_t next = 0;
+    std::size_t reported = 0;
+
+    const auto thread_count =
+        std::min<std::size_t>(GetThreadCount(), candidates.size());
+    const auto window = thread_count * kQueryBlocksAhead;
+
+    const auto worker = [&]()
+    {
+        for (;;)
+        {
+            std::size_t index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [&]()
+                    {
+                        return next == candidates.size() ||
+                               next < reported + window;
+                    });
+
+                if (next == candidates.size())
+                {
+                    return;
+                }
+                index = next++;
+            }
+
+            std::vector<LogRecordView> records;
+            scan_block(*candidates[index].first, *candidates[index].second,
+                       records);
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                results[index].records = std::move(records);
+                results[index].done = true;
+            }
+            condition.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < thread_count; i++)
+    {
+        threads.emplace_back(worker);
+    }
+
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < candidates.size(); i++)
+    {
+        std::vector<LogRecordView> records;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&]() { return results[i].done; });
+
+            records = std::move(results[i].records);
+            reported = i + 1;
+        }
+        condition.notify_all();
+
+        for (const auto& record : records)
+        {
+            callback(record);
+        }
+        count += records.size();
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    return count;
+}
+
+bool LogReader::OpenSegment(const std::string& path)
+{
+    namespace fs = std::filesystem;
+
+    auto segment = std::make_unique<Segment>();
+    segment->path = path;
+
+    std::error_code error;
+    segment->file_size = fs::file_size(path, error);
+    segment->write_time = static_cast<std::int64_t>(
+        fs::last_write_time(path, error).time_since_epoch().count());
+
+    if (error)
+    {
+        return false;
+    }
+
+    if (IsPreallocated(path))
+    {
+        if (!ReadWrittenPart(path, segment->contents))
+        {
+            return false;
+        }
+        segment->data = segment->contents;
+    }
+    else
+    {
+        if (!segment->file.Open(path))
+        {
+            return false;
+        }
+        segment->data = segment->file.GetData();
+        segment->data = segment->data.substr(0, segment->data.find('\0'));
+    }
+
+    if (!m_settings.use_index_cache || m_settings.rebuild_index ||
+        !LoadIndex(*segment))
+    {
+        BuildIndex(*segment);
+
+        if (m_settings.use_index_cache)
+        {
+            SaveIndex(*segment);
+        }
+    }
+
+    for (std::uint32_t i = 0; i < segment->blocks.size(); i++)
+    {
+        for (const auto thread : segment->blocks[i].threads)
+        {
+            segment->thread_blocks[thread].push_back(i);
+        }
+    }
+
+    m_segments.push_back(std::move(segment));
+    return true;
+}
+
+void LogReader::BuildIndex(Segment& segment) const
+{
+    const auto data = segment.data;
+
+    // every thread indexes a range that starts at a record
+    const auto range_count = std::max<std::size_t>(
+        1, std::min<std::size_t>(GetThreadCount(),
+                                 data.size() / kIndexBlockSize));
+
+    std::vector<std::size_t> bounds(range_count + 1, data.size());
+    bounds[0] = 0;
+    for (std::size_t i = 1; i < range_count; i++)
+    {
+        const auto position = data.size() / range_count * i;
+        bounds[i] = std::max(bounds[i - 1], FindRecordStart(data, position));
+    }
+
+    struct RangeIndex
+    {
+        std::vector<LogIndexBlock>                      blocks;
+        std::unordered_map<std::uint64_t, std::string>  thread_names;
+    };
+
+    std::vector<RangeIndex> ranges(range_count);
+
+    const auto index_range = [&data, &bounds, &ranges](std::size_t range)
+    {
+        const auto end = bounds[range + 1];
+        auto position = bounds[range];
+        auto& index = ranges[range];
+
+        while (position < end)
+        {
+            LogIndexBlock block = {};
+            block.offset = position;
+            block.first_time = std::numeric_limits<std::int64_t>::max();
+            block.last_time = std::numeric_limits<std::int64_t>::min();
+
+            const auto target = std::min(end, position + kIndexBlockSize);
+            while (position < end && position < target)
+            {
+                LogRecordView record;
+                const auto line = GetLine(data, position);
+                if (!ParseLogRecord(line, record))
+                {
+                    position += line.size();
+                    continue;
+                }
+
+                position = ReadRecord(data, position, end, record);
+
+                block.first_time = std::min(block.first_time, record.time);
+                block.last_time = std::max(block.last_time, record.time);
+                block.levels |= GetLevelBit(record.level);
+
+                if (std::find(block.threads.begin(), block.threads.end(),
+                              record.thread) == block.threads.end())
+                {
+                    block.threads.push_back(record.thread);
+
+                    if (!record.thread_name.empty())
+                    {
+                        index.thread_names[record.thread] =
+                            record.thread_name;
+                    }
+                }
+            }
+
+            block.size = position - block.offset;
+            index.blocks.push_back(std::move(block));
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t range = 1; range < range_count; range++)
+    {
+        threads.emplace_back(index_range, range);
+    }
+    index_range(0);
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    segment.blocks.clear();
+    segment.thread_names.clear();
+
+    for (auto& range : ranges)
+    {
+        for (auto& block : range.blocks)
+        {
+            segment.blocks.push_back(std::move(block));
+        }
+        segment.thread_names.merge(range.thread_names);
+    }
+}
+
+bool LogReader::LoadIndex(Segment& segment) const
+{
+    auto file = std::fopen((segment.path + ".idx").c_str(), "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    std::string data;
+    char buffer[64 * 1024];
+    std::size_t bytes_read;
+    while ((bytes_read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        data.append(buffer, bytes_read);
+    }
+    std::fclose(file);
+
+    std::string_view input = data;
+    char magic[sizeof(kIndexMagic)];
+    std::uint32_t version;
+    std::uint64_t file_size;
+    std::int64_t write_time;
+    std::uint64_t data_size;
+    std::uint64_t block_count;
+
+    if (!ReadValue(input, magic) ||
+        std::memcmp(magic, kIndexMagic, sizeof(magic)) != 0 ||
+        !ReadValue(input, version) || version != kIndexVersion ||
+        !ReadValue(input, file_size) || file_size != segment.file_size ||
+        !ReadValue(input, write_time) || write_time != segment.write_time ||
+        !ReadValue(input, data_size) || data_size != segment.data.size() ||
+        !ReadValue(input, block_count))
+    {
+        // another format or the log has changed since
+        return false;
+    }
+
+    std::vector<LogIndexBlock> blocks;
+    for (std::uint64_t i = 0; i < block_count; i++)
+    {
+        LogIndexBlock block;
+        std::uint32_t thread_count;
+
+        if (!ReadValue(input, block.offset) || !ReadValue(input, block.size) ||
+            !ReadValue(input, block.first_time) ||
+            !ReadValue(input, block.last_time) ||
+            !ReadValue(input, block.levels) || !ReadValue(input, thread_count) ||
+            input.size() / sizeof(std::uint64_t) < thread_count ||
+            block.offset + block.size > segment.data.size())
+        {
+            return false;
+        }
+
+        block.threads.resize(thread_count);
+        for (auto& thread : block.threads)
+        {
+            ReadValue(input, thread);
+        }
+
+        blocks.push_back(std::move(block));
+    }
+
+    std::unordered_map<std::uint64_t, std::string> thread_names;
+    std::uint64_t name_count;
+    if (!ReadValue(input, name_count))
+    {
+        return false;
+    }
+
+    for (std::uint64_t i = 0; i < name_count; i++)
+    {
+        std::uint64_t thread;
+        std::uint32_t length;
+        if (!ReadValue(input, thread) || !ReadValue(input, length) ||
+            input.size() < length)
+        {
+            return false;
+        }
+
+        thread_names[thread] = input.substr(0, length);
+        input.remove_prefix(length);
+    }
+
+    segment.blocks = std::move(blocks);
+    segment.thread_names = std::move(thread_names);
+    return true;
+}
+
+void LogReader::SaveIndex(const Segment& segment) const
+{
+    std::string data(kIndexMagic, sizeof(kIndexMagic));
+    AppendValue(data, kIndexVersion);
+    AppendValue(data, segment.file_size);
+    AppendValue(data, segment.write_time);
+    // a preallocated segment keeps its size and may keep its write time
+    AppendValue(data, static_cast<std::uint64_t>(segment.data.size()));
+    AppendValue(data, static_cast<std::uint64_t>(segment.blocks.size()));
+
+    for (const auto& block : segment.blocks)
+    {
+        AppendValue(data, block.offset);
+        AppendValue(data, block.size);
+        AppendValue(data, block.first_time);
+        AppendValue(data, block.last_time);
+        AppendValue(data, block.levels);
+        AppendValue(data, static_cast<std::uint32_t>(block.threads.size()));
+        for (const auto thread : block.threads)
+        {
+            AppendValue(data, thread);
+        }
+    }
+
+    AppendValue(data, static_cast<std::uint64_t>(segment.thread_names.size()));
+    for (const auto& [thread, name] : segment.thread_names)
+    {
+        AppendValue(data, thread);
+        AppendValue(data, static_cast<std::uint32_t>(name.size()));
+        data += name;
+    }
+
+    // the index is only a cache, a read only directory just means
+    // indexing again next time
+    auto file = std::fopen((segment.path + ".idx").c_str(), "wb");
+    if (file != nullptr)
+    {
+        std::fwrite(data.data(), 1, data.size(), file);
+        std::fclose(file);
+    }
+}
+
+unsigned int LogReader::GetThreadCount() const
+{
+    if (m_settings.threads > 0)
+    {
+        return m_settings.threads;
+    }
+
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+}
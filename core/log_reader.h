@@ -0,0 +1,132 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOOHAHA_CORE_LOG_READER_H_
+#define HOOHAHA_CORE_LOG_READER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "log.h"
+
+namespace core
+{
+
+// One record of a text log: "[time][LEVEL][thread] message : file(line)".
+// Lines that follow a record and do not start one belong to it.
+struct LogRecordView
+{
+    // nanoseconds since the epoch
+    std::int64_t      time;
+    LogLevel          level;
+    // the numeric part of the thread tag, e.g. 3 for "0003 render"
+    std::uint64_t     thread;
+    std::string_view  thread_name;
+    // the whole record without the final line break
+    std::string_view  text;
+};
+
+// Parses the record prefix of a single line
+bool ParseLogRecord(std::string_view line, LogRecordView& record);
+
+struct LogQuery
+{
+    // nanoseconds since the epoch, begin inclusive, end exclusive
+    std::int64_t   begin_time = std::numeric_limits<std::int64_t>::min();
+    std::int64_t   end_time = std::numeric_limits<std::int64_t>::max();
+    // records at this level and the more severe ones
+    LogLevel       level = LogLevel::kTrace;
+    // zero matches every thread
+    std::uint64_t  thread = 0;
+    // substring of the record, empty matches every record
+    std::string    text;
+};
+
+struct LogReaderSettings
+{
+    // threads for indexing and queries, zero uses one per core
+    unsigned int  threads = 0;
+    // load the index from <segment>.idx and save it there after building it
+    bool          use_index_cache = true;
+    // ignore a cached index, the new one is still saved
+    bool          rebuild_index = false;
+};
+
+// Queries text logs without reading all of them. Every file is memory
+// mapped and split into blocks of about 256KB, which are indexed by time
+// range, levels and threads in parallel on the first open. The index is
+// cached next to the file and reused as long as the file's size, write
+// time and written length are unchanged. Queries only scan the blocks the
+// index lets through, spread over several threads.
+//
+// A preallocated file that is still being written is read rather than
+// mapped, its writer truncates it later. A log truncated by anything else
+// while it is open faults the mapping (SIGBUS on POSIX).
+class LogReader final
+{
+public:
+    using RecordCallback = std::function<void(const LogRecordView& record)>;
+
+    explicit LogReader(const LogReaderSettings& settings = {});
+    LogReader(const LogReader&) = delete;
+    LogReader(LogReader&&) = delete;
+    ~LogReader();
+
+    // Opens a log file, or when there is no file at path the segments
+    // <path>.0, <path>.1 and so on that MappedLogWriter rolls, in order
+    bool Open(std::string_view path);
+    void Close();
+
+    std::size_t GetSegmentCount() const;
+    std::size_t GetBlockCount() const;
+
+    // Thread id of a thread name seen in the log, false if there is none
+    bool FindThread(std::string_view name, std::uint64_t& thread) const;
+
+    // Calls back with every matching record in file order from the calling
+    // thread, returns the number of matches
+    std::size_t Query(const LogQuery& query,
+                      const RecordCallback& callback) const;
+
+    LogReader& operator=(const LogReader&) = delete;
+    LogReader& operator=(LogReader&&) = delete;
+
+private:
+    struct Segment;
+
+    bool OpenSegment(const std::string& path);
+    bool LoadIndex(Segment& segment) const;
+    void BuildIndex(Segment& segment) const;
+    void SaveIndex(const Segment& segment) const;
+
+    unsigned int GetThreadCount() const;
+
+private:
+    LogReaderSettings                      m_settings;
+    std::vector<std::unique_ptr<Segment>>  m_segments;
+};
+
+}
+
+#endif // HOOHAHA_CORE_LOG_READER_H_
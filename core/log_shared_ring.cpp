@@ -0,0 +1,567 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "log_shared_ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace core
+{
+
+// Start of the shared memory object, the ring data follows it. Positions
+// are byte counts that only grow, the writer owns write_position and the
+// reader owns read_position.
+struct SharedRingLogHeader
+{
+    char                        magic[8];
+    std::uint32_t               version;
+    std::uint32_t               header_size;
+    std::uint64_t               capacity;
+
+    alignas(64) std::atomic<std::uint64_t> write_position;
+    std::atomic<std::uint64_t>  dropped_records;
+    // process id of the writer that has the ring open, zero for none
+    std::atomic<std::uint64_t>  writer_process;
+
+    alignas(64) std::atomic<std::uint64_t> read_position;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "the ring positions are shared between processes");
+
+namespace
+{
+
+constexpr char kSharedRingMagic[8] = { 'H', 'H', 'S', 'H', 'R', 'I', 'N', 'G' };
+constexpr std::uint32_t kSharedRingVersion = 1;
+
+std::size_t RoundUpToPowerOfTwo(std::size_t value)
+{
+    std::size_t result = 4096;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+bool IsValidRing(const SharedRingLogHeader* header, std::size_t mapping_size)
+{
+    if (std::memcmp(header->magic, kSharedRingMagic,
+                    sizeof(kSharedRingMagic)) != 0)
+    {
+        return false;
+    }
+
+    // the magic is written last, see InitializeRing
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return header->version == kSharedRingVersion &&
+           header->header_size == sizeof(SharedRingLogHeader) &&
+           mapping_size >= sizeof(SharedRingLogHeader) &&
+           header->capacity == mapping_size - sizeof(SharedRingLogHeader);
+}
+
+void InitializeRing(SharedRingLogHeader* header, std::size_t capacity)
+{
+    header->version = kSharedRingVersion;
+    header->header_size = sizeof(SharedRingLogHeader);
+    header->capacity = capacity;
+    header->write_position.store(0, std::memory_order_relaxed);
+    header->dropped_records.store(0, std::memory_order_relaxed);
+    header->writer_process.store(0, std::memory_order_relaxed);
+    header->read_position.store(0, std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, kSharedRingMagic, sizeof(kSharedRingMagic));
+}
+
+#ifdef _WIN32
+
+std::uint64_t GetCurrentProcessNumber()
+{
+    return GetCurrentProcessId();
+}
+
+bool IsProcessRunning(std::uint64_t process)
+{
+    const auto handle = OpenProcess(SYNCHRONIZE, FALSE,
+                                    static_cast<DWORD>(process));
+    if (handle == nullptr)
+    {
+        return false;
+    }
+
+    const bool running = WaitForSingleObject(handle, 0) == WAIT_TIMEOUT;
+    CloseHandle(handle);
+    return running;
+}
+
+std::string GetObjectName(std::string_view name)
+{
+    if (!name.empty() && name.front() == '/')
+    {
+        name.remove_prefix(1);
+    }
+    return "Local\\" + std::string(name);
+}
+
+#else
+
+std::uint64_t GetCurrentProcessNumber()
+{
+    return static_cast<std::uint64_t>(getpid());
+}
+
+bool IsProcessRunning(std::uint64_t process)
+{
+    return kill(static_cast<pid_t>(process), 0) == 0 || errno == EPERM;
+}
+
+std::string GetObjectName(std::string_view name)
+{
+    if (!name.empty() && name.front() == '/')
+    {
+        return std::string(name);
+    }
+    return '/' + std::string(name);
+}
+
+// Maps a shared memory object of the given size, or of its current size
+// when size is zero
+void* MapObject(int descriptor, std::size_t& size)
+{
+    if (size == 0)
+    {
+        struct stat status;
+        if (fstat(descriptor, &status) != 0 || status.st_size <= 0)
+        {
+            return nullptr;
+        }
+        size = static_cast<std::size_t>(status.st_size);
+    }
+
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                         descriptor, 0);
+    return address == MAP_FAILED ? nullptr : address;
+}
+
+#endif
+
+} // namespace
+
+SharedRingLogWriter::SharedRingLogWriter(const SharedRingLogSettings& settings)
+    : m_settings(settings)
+    , m_header(nullptr)
+    , m_data(nullptr)
+    , m_mapping_size(0)
+#ifdef _WIN32
+    , m_mapping_handle(nullptr)
+#endif
+{
+    m_settings.capacity = RoundUpToPowerOfTwo(m_settings.capacity);
+}
+
+SharedRingLogWriter::~SharedRingLogWriter()
+{
+    Close();
+}
+
+bool SharedRingLogWriter::Write(std::string_view data)
+{
+    if (m_header == nullptr)
+    {
+        return false;
+    }
+
+    const auto capacity = m_settings.capacity;
+    const auto write = m_header->write_position.load(std::memory_order_relaxed);
+    const auto read = m_header->read_position.load(std::memory_order_acquire);
+
+    if (data.size() > capacity - (write - read))
+    {
+        m_header->dropped_records.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const auto offset = static_cast<std::size_t>(write & (capacity - 1));
+    const auto first = std::min(data.size(), capacity - offset);
+
+    std::memcpy(m_data + offset, data.data(), first);
+    std::memcpy(m_data, data.data() + first, data.size() - first);
+
+    // the reader only looks at bytes published here, never at half a record
+    m_header->write_position.store(write + data.size(),
+                                   std::memory_order_release);
+    return true;
+}
+
+void SharedRingLogWriter::Flush()
+{
+}
+
+SharedRingLogReader::SharedRingLogReader()
+    : m_header(nullptr)
+    , m_data(nullptr)
+    , m_mapping_size(0)
+#ifdef _WIN32
+    , m_mapping_handle(nullptr)
+#endif
+{
+}
+
+SharedRingLogReader::~SharedRingLogReader()
+{
+    Close();
+}
+
+bool SharedRingLogReader::IsOpen() const
+{
+    return m_header != nullptr;
+}
+
+std::size_t SharedRingLogReader::Read(std::string& output)
+{
+    if (m_header == nullptr)
+    {
+        return 0;
+    }
+
+    const auto capacity = static_cast<std::size_t>(m_header->capacity);
+    const auto write = m_header->write_position.load(std::memory_order_acquire);
+    const auto read = m_header->read_position.load(std::memory_order_relaxed);
+
+    if (write - read > capacity)
+    {
+        // Not a position we could have left, start over from the writer's.
+        // How many records the skipped bytes held is unknown, they count as
+        // one so the collector still reports the loss.
+        m_header->dropped_records.fetch_add(1, std::memory_order_relaxed);
+        m_header->read_position.store(write, std::memory_order_release);
+        return 0;
+    }
+
+    const auto size = static_cast<std::size_t>(write - read);
+    const auto offset = static_cast<std::size_t>(read & (capacity - 1));
+    const auto first = std::min(size, capacity - offset);
+
+    output.append(m_data + offset, first);
+    output.append(m_data, size - first);
+
+    // hands the space back to the writer once the bytes are copied
+    m_header->read_position.store(write, std::memory_order_release);
+    return size;
+}
+
+bool SharedRingLogReader::IsWriterAttached() const
+{
+    if (m_header == nullptr)
+    {
+        return false;
+    }
+
+    // a writer that crashed never detached
+    const auto process = m_header->writer_process.load(std::memory_order_acquire);
+    return process != 0 && IsProcessRunning(process);
+}
+
+std::uint64_t SharedRingLogReader::GetDroppedRecordCount() const
+{
+    return m_header != nullptr
+               ? m_header->dropped_records.load(std::memory_order_relaxed)
+               : 0;
+}
+
+#ifdef _WIN32
+
+bool SharedRingLogWriter::Open(std::string_view path)
+{
+    Close();
+
+    const auto name = GetObjectName(path);
+    const auto size = static_cast<std::uint64_t>(sizeof(SharedRingLogHeader) +
+                                                 m_settings.capacity);
+
+    m_mapping_handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr,
+                                          PAGE_READWRITE,
+                                          static_cast<DWORD>(size >> 32),
+                                          static_cast<DWORD>(size),
+                                          name.c_str());
+    if (m_mapping_handle == nullptr)
+    {
+        return false;
+    }
+
+    const bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+
+    void* address = MapViewOfFile(m_mapping_handle, FILE_MAP_ALL_ACCESS, 0, 0,
+                                  static_cast<SIZE_T>(size));
+    if (address == nullptr)
+    {
+        // a ring of another size is still held open by a collector
+        CloseHandle(m_mapping_handle);
+        m_mapping_handle = nullptr;
+        return false;
+    }
+
+    m_header = static_cast<SharedRingLogHeader*>(address);
+    m_data = reinterpret_cast<char*>(m_header + 1);
+    m_mapping_size = static_cast<std::size_t>(size);
+
+    if (!existed || !IsValidRing(m_header, m_mapping_size))
+    {
+        InitializeRing(m_header, m_settings.capacity);
+    }
+
+    m_header->writer_process.store(GetCurrentProcessNumber(),
+                                   std::memory_order_release);
+    return true;
+}
+
+void SharedRingLogWriter::Close()
+{
+    if (m_header != nullptr)
+    {
+        m_header->writer_process.store(0, std::memory_order_release);
+
+        UnmapViewOfFile(m_header);
+        CloseHandle(m_mapping_handle);
+
+        m_header = nullptr;
+        m_data = nullptr;
+        m_mapping_size = 0;
+        m_mapping_handle = nullptr;
+    }
+}
+
+bool SharedRingLogReader::Open(std::string_view name)
+{
+    Close();
+
+    m_mapping_handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE,
+                                        GetObjectName(name).c_str());
+    if (m_mapping_handle == nullptr)
+    {
+        return false;
+    }
+
+    void* address = MapViewOfFile(m_mapping_handle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION information;
+    if (address == nullptr ||
+        VirtualQuery(address, &information, sizeof(information)) == 0)
+    {
+        if (address != nullptr)
+        {
+            UnmapViewOfFile(address);
+        }
+        CloseHandle(m_mapping_handle);
+        m_mapping_handle = nullptr;
+        return false;
+    }
+
+    // the view is rounded up to whole pages, the header has the real size
+    auto header = static_cast<SharedRingLogHeader*>(address);
+    const auto size = sizeof(SharedRingLogHeader) +
+                      static_cast<std::size_t>(header->capacity);
+    if (size > information.RegionSize || !IsValidRing(header, size))
+    {
+        UnmapViewOfFile(address);
+        CloseHandle(m_mapping_handle);
+        m_mapping_handle = nullptr;
+        return false;
+    }
+
+    m_header = header;
+    m_data = reinterpret_cast<const char*>(m_header + 1);
+    m_mapping_size = size;
+    return true;
+}
+
+void SharedRingLogReader::Close()
+{
+    if (m_header != nullptr)
+    {
+        UnmapViewOfFile(m_header);
+        CloseHandle(m_mapping_handle);
+
+        m_header = nullptr;
+        m_data = nullptr;
+        m_mapping_size = 0;
+        m_mapping_handle = nullptr;
+    }
+}
+
+void SharedRingLogReader::Remove(std::string_view)
+{
+    // the mapping goes away with its last handle
+}
+
+#else
+
+bool SharedRingLogWriter::Open(std::string_view path)
+{
+    Close();
+
+    const auto name = GetObjectName(path);
+    const auto size = sizeof(SharedRingLogHeader) + m_settings.capacity;
+
+    // keep an existing ring of the same size, it may hold records the
+    // collector has not read yet
+    int descriptor = shm_open(name.c_str(), O_RDWR, 0600);
+    if (descriptor >= 0)
+    {
+        std::size_t existing_size = 0;
+        void* address = MapObject(descriptor, existing_size);
+
+        if (address != nullptr && existing_size == size &&
+            IsValidRing(static_cast<SharedRingLogHeader*>(address), size))
+        {
+            m_header = static_cast<SharedRingLogHeader*>(address);
+        }
+        else
+        {
+            if (address != nullptr)
+            {
+                munmap(address, existing_size);
+            }
+
+            // a collector attached to the old one keeps its mapping
+            shm_unlink(name.c_str());
+        }
+
+        close(descriptor);
+    }
+
+    if (m_header == nullptr)
+    {
+        descriptor = shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (descriptor < 0)
+        {
+            return false;
+        }
+
+        std::size_t mapped_size = size;
+        void* address = ftruncate(descriptor, static_cast<off_t>(size)) == 0
+                            ? MapObject(descriptor, mapped_size)
+                            : nullptr;
+        close(descriptor);
+
+        if (address == nullptr)
+        {
+            shm_unlink(name.c_str());
+            return false;
+        }
+
+        m_header = static_cast<SharedRingLogHeader*>(address);
+        InitializeRing(m_header, m_settings.capacity);
+    }
+
+    m_data = reinterpret_cast<char*>(m_header + 1);
+    m_mapping_size = size;
+
+    m_header->writer_process.store(GetCurrentProcessNumber(),
+                                   std::memory_order_release);
+    return true;
+}
+
+void SharedRingLogWriter::Close()
+{
+    if (m_header != nullptr)
+    {
+        // the object stays for the collector to drain
+        m_header->writer_process.store(0, std::memory_order_release);
+
+        munmap(m_header, m_mapping_size);
+
+        m_header = nullptr;
+        m_data = nullptr;
+        m_mapping_size = 0;
+    }
+}
+
+bool SharedRingLogReader::Open(std::string_view name)
+{
+    Close();
+
+    const int descriptor = shm_open(GetObjectName(name).c_str(), O_RDWR, 0600);
+    if (descriptor < 0)
+    {
+        return false;
+    }
+
+    std::size_t size = 0;
+    void* address = MapObject(descriptor, size);
+    close(descriptor);
+
+    if (address == nullptr)
+    {
+        return false;
+    }
+
+    if (size < sizeof(SharedRingLogHeader) ||
+        !IsValidRing(static_cast<SharedRingLogHeader*>(address), size))
+    {
+        munmap(address, size);
+        return false;
+    }
+
+    m_header = static_cast<SharedRingLogHeader*>(address);
+    m_data = reinterpret_cast<const char*>(m_header + 1);
+    m_mapping_size = size;
+    return true;
+}
+
+void SharedRingLogReader::Close()
+{
+    if (m_header != nullptr)
+    {
+        munmap(m_header, m_mapping_size);
+
+        m_header = nullptr;
+        m_data = nullptr;
+        m_mapping_size = 0;
+    }
+}
+
+void SharedRingLogReader::Remove(std::string_view name)
+{
+    shm_unlink(GetObjectName(name).c_str());
+}
+
+#endif // _WIN32
+
+}
@@ -0,0 +1,122 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOOHAHA_CORE_LOG_SHARED_RING_H_
+#define HOOHAHA_CORE_LOG_SHARED_RING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "log_writer.h"
+
+namespace core
+{
+
+struct SharedRingLogHeader;
+
+struct SharedRingLogSettings
+{
+    // bytes of log data the ring holds, rounded up to a power of two
+    std::size_t  capacity = 16 * 1024 * 1024;
+};
+
+// Writes the log stream into a named shared memory ring instead of a file,
+// for a collector process (SharedRingLogReader, tools/log_collector) to
+// store. Appending a record is a memcpy and an atomic store, no system
+// call, and whatever the process wrote survives it crashing.
+//
+// The log path is the name of the shared memory object, e.g.
+// "/hoohaha-server". An existing ring of the same capacity is attached to
+// and appended to, so records a collector has not read yet are kept over a
+// restart. When the collector falls behind and a record does not fit, the
+// record is dropped and counted in the ring.
+class SharedRingLogWriter final : public LogWriter
+{
+public:
+    explicit SharedRingLogWriter(const SharedRingLogSettings& settings);
+    SharedRingLogWriter(const SharedRingLogWriter&) = delete;
+    SharedRingLogWriter(SharedRingLogWriter&&) = delete;
+    ~SharedRingLogWriter() override;
+
+    bool Open(std::string_view path) override;
+    void Close() override;
+
+    bool Write(std::string_view data) override;
+    // nothing to do, the collector sees a record as soon as it is written
+    void Flush() override;
+
+    SharedRingLogWriter& operator=(const SharedRingLogWriter&) = delete;
+    SharedRingLogWriter& operator=(SharedRingLogWriter&&) = delete;
+
+private:
+    SharedRingLogSettings  m_settings;
+
+    SharedRingLogHeader*   m_header;
+    char*                  m_data;
+    std::size_t            m_mapping_size;
+#ifdef _WIN32
+    void*                  m_mapping_handle;
+#endif
+};
+
+// Reads what a SharedRingLogWriter of another process writes. There is one
+// reader per ring, it only ever sees whole records.
+class SharedRingLogReader final
+{
+public:
+    SharedRingLogReader();
+    SharedRingLogReader(const SharedRingLogReader&) = delete;
+    SharedRingLogReader(SharedRingLogReader&&) = delete;
+    ~SharedRingLogReader();
+
+    // attaches to a ring that a writer has created
+    bool Open(std::string_view name);
+    void Close();
+    bool IsOpen() const;
+
+    // Appends everything written since the last call to output and returns
+    // the number of bytes
+    std::size_t Read(std::string& output);
+
+    // whether a writer has the ring open right now, a writer process that
+    // died without closing it does not count
+    bool IsWriterAttached() const;
+    // records dropped because the ring was full, since the ring was created,
+    // plus one for every stretch of data Read had to skip
+    std::uint64_t GetDroppedRecordCount() const;
+
+    // Removes the name, mappings that are open stay valid
+    static void Remove(std::string_view name);
+
+    SharedRingLogReader& operator=(const SharedRingLogReader&) = delete;
+    SharedRingLogReader& operator=(SharedRingLogReader&&) = delete;
+
+private:
+    SharedRingLogHeader*  m_header;
+    const char*           m_data;
+    std::size_t           m_mapping_size;
+#ifdef _WIN32
+    void*                 m_mapping_handle;
+#endif
+};
+
+}
+
+#endif // HOOHAHA_CORE_LOG_SHARED_RING_H_
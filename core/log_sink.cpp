@@ -0,0 +1,168 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "log_sink.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace core
+{
+
+LogSink::LogSink(LogLevel level)
+    : m_level(level)
+{
+}
+
+LogSink::~LogSink()
+{
+}
+
+LogLevel LogSink::GetLevel() const
+{
+    return m_level;
+}
+
+bool LogSink::Accepts(LogLevel level) const
+{
+    return level <= m_level;
+}
+
+void LogSink::Flush()
+{
+}
+
+FileLogSink::FileLogSink(LogLevel level, std::string_view path)
+    : FileLogSink(level, path, std::make_unique<StdioLogWriter>())
+{
+}
+
+FileLogSink::FileLogSink(LogLevel level, std::string_view path,
+                         std::unique_ptr<LogWriter> writer)
+    : LogSink(level)
+    , m_writer(std::move(writer))
+    , m_open(false)
+{
+    m_open = m_writer && m_writer->Open(path);
+}
+
+FileLogSink::~FileLogSink()
+{
+    if (m_open)
+    {
+        m_writer->Close();
+    }
+}
+
+bool FileLogSink::IsOpen() const
+{
+    return m_open;
+}
+
+void FileLogSink::Write(LogLevel level, std::string_view text)
+{
+    if (m_open)
+    {
+        m_writer->Write(text);
+
+        if (level <= LogLevel::kError)
+        {
+            m_writer->Flush();
+        }
+    }
+}
+
+void FileLogSink::Flush()
+{
+    if (m_open)
+    {
+        m_writer->EndBatch();
+    }
+}
+
+StdoutLogSink::StdoutLogSink(LogLevel level)
+    : LogSink(level)
+{
+}
+
+void StdoutLogSink::Write(LogLevel, std::string_view text)
+{
+    std::fwrite(text.data(), 1, text.size(), stdout);
+}
+
+void StdoutLogSink::Flush()
+{
+    std::fflush(stdout);
+}
+
+RingLogSink::RingLogSink(LogLevel level, std::size_t capacity)
+    : LogSink(level)
+    , m_records(capacity > 0 ? capacity : 1)
+    , m_record_count(0)
+{
+}
+
+void RingLogSink::Write(LogLevel, std::string_view text)
+{
+    while (!text.empty() && (text.back() == '\n' || text.back() == '\r'))
+    {
+        text.remove_suffix(1);
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // assign reuses the capacity of the overwritten record
+    m_records[m_record_count % m_records.size()].assign(text);
+    m_record_count++;
+}
+
+void RingLogSink::GetRecords(std::vector<std::string>& records) const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    const auto capacity = m_records.size();
+    const auto count = std::min<std::uint64_t>(m_record_count, capacity);
+
+    records.clear();
+    records.reserve(count);
+
+    for (auto index = m_record_count - count; index < m_record_count; ++index)
+    {
+        records.push_back(m_records[index % capacity]);
+    }
+}
+
+std::uint64_t RingLogSink::GetRecordCount() const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_record_count;
+}
+
+void RingLogSink::Clear()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (auto& record : m_records)
+    {
+        record.clear();
+    }
+
+    m_record_count = 0;
+}
+
+}
@@ -0,0 +1,117 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOOHAHA_CORE_LOG_SINK_H_
+#define HOOHAHA_CORE_LOG_SINK_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "log.h"
+#include "log_writer.h"
+
+namespace core
+{
+
+// Additional destination for log records, see Log::AddSink. A record is
+// formatted once and the same text is handed to every sink whose level
+// accepts it. Write and Flush are only ever called by one thread at a time:
+// the logging thread under the log mutex in sync mode, or the writer thread
+// in async mode.
+//
+// Sinks receive text or JSON lines, in binary mode (LogFormat::kBinary) the
+// records go to the log file only.
+class LogSink
+{
+public:
+    explicit LogSink(LogLevel level);
+    LogSink(const LogSink&) = delete;
+    LogSink(LogSink&&) = delete;
+    virtual ~LogSink();
+
+    LogLevel GetLevel() const;
+    bool Accepts(LogLevel level) const;
+
+    // text is a complete record including the trailing "\r\n"
+    virtual void Write(LogLevel level, std::string_view text) = 0;
+    virtual void Flush();
+
+    LogSink& operator=(const LogSink&) = delete;
+    LogSink& operator=(LogSink&&) = delete;
+
+private:
+    const LogLevel  m_level;
+};
+
+// Writes records to a file of its own through a LogWriter
+class FileLogSink final : public LogSink
+{
+public:
+    FileLogSink(LogLevel level, std::string_view path);
+    FileLogSink(LogLevel level, std::string_view path,
+                std::unique_ptr<LogWriter> writer);
+    ~FileLogSink() override;
+
+    bool IsOpen() const;
+
+    void Write(LogLevel level, std::string_view text) override;
+    void Flush() override;
+
+private:
+    std::unique_ptr<LogWriter>  m_writer;
+    bool                        m_open;
+};
+
+class StdoutLogSink final : public LogSink
+{
+public:
+    explicit StdoutLogSink(LogLevel level);
+
+    void Write(LogLevel level, std::string_view text) override;
+    void Flush() override;
+};
+
+// Keeps the last records in memory, e.g. for a debug console. Records are
+// stored without the trailing "\r\n" and can be read from any thread.
+class RingLogSink final : public LogSink
+{
+public:
+    RingLogSink(LogLevel level, std::size_t capacity);
+
+    void Write(LogLevel level, std::string_view text) override;
+
+    // copies the stored records to records, oldest first
+    void GetRecords(std::vector<std::string>& records) const;
+    // number of records written since creation, including overwritten ones
+    std::uint64_t GetRecordCount() const;
+
+    void Clear();
+
+private:
+    mutable std::mutex        m_mutex;
+    std::vector<std::string>  m_records;
+    std::uint64_t             m_record_count;
+};
+
+}
+
+#endif // HOOHAHA_CORE_LOG_SINK_H_
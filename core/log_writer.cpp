@@ -0,0 +1,822 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "log_writer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <new>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace core
+{
+
+namespace
+{
+
+std::size_t GetMappingGranularity()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+#else
+    return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+const std::size_t kStdioBufferSize = 64 * 1024;
+
+// offset, size and memory alignment of direct writes, a multiple of the
+// logical block size of any device we write logs to
+const std::size_t kDirectWriteAlignment = 4096;
+// chunks handed to one writev call
+const int kMaxWriteChunks = 64;
+
+inline std::size_t AlignUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+LogWriter::~LogWriter()
+{
+}
+
+void LogWriter::EndBatch()
+{
+    Flush();
+}
+
+void LogWriter::AddPreamble(std::string_view data)
+{
+    // a single file has it at its start already
+    static_cast<void>(data);
+}
+
+StdioLogWriter::StdioLogWriter()
+    : m_file(nullptr)
+{
+}
+
+StdioLogWriter::~StdioLogWriter()
+{
+    Close();
+}
+
+bool StdioLogWriter::Open(std::string_view path)
+{
+    Close();
+
+    m_file = std::fopen(std::string(path).c_str(), "wb");
+    if (m_file == nullptr)
+    {
+        return false;
+    }
+
+    // the async writer flushes once per batch, let a batch fit in the buffer
+    std::setvbuf(m_file, nullptr, _IOFBF, kStdioBufferSize);
+    return true;
+}
+
+void StdioLogWriter::Close()
+{
+    if (m_file)
+    {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+bool StdioLogWriter::Write(std::string_view data)
+{
+    return std::fwrite(data.data(), 1, data.size(), m_file) == data.size();
+}
+
+void StdioLogWriter::Flush()
+{
+    std::fflush(m_file);
+}
+
+MappedLogWriter::MappedLogWriter(const MappedLogSettings& settings)
+    : m_settings(settings)
+    , m_granularity(GetMappingGranularity())
+    , m_segment_index(0)
+    , m_segment_written(0)
+    , m_window(nullptr)
+    , m_window_offset(0)
+    , m_window_size(0)
+#ifdef _WIN32
+    , m_file_handle(INVALID_HANDLE_VALUE)
+    , m_mapping_handle(nullptr)
+#else
+    , m_file_descriptor(-1)
+#endif
+{
+    m_settings.window_size =
+        AlignUp(std::max<std::size_t>(m_settings.window_size, 1), m_granularity);
+    m_settings.segment_size =
+        AlignUp(std::max<std::size_t>(m_settings.segment_size, 1), m_granularity);
+    m_settings.window_size =
+        std::min(m_settings.window_size, m_settings.segment_size);
+}
+
+MappedLogWriter::~MappedLogWriter()
+{
+    Close();
+}
+
+bool MappedLogWriter::Open(std::string_view path)
+{
+    Close();
+
+    m_path = path;
+    m_segment_index = 0;
+    m_preamble.clear();
+
+    // a reader would take the segments left over from a longer run for
+    // part of this one
+    RemoveSegments();
+
+    return OpenSegment();
+}
+
+void MappedLogWriter::Close()
+{
+    CloseSegment();
+}
+
+bool MappedLogWriter::Write(std::string_view data)
+{
+    if (m_window == nullptr || (ShouldRoll(data.size()) && !Roll()))
+    {
+        return false;
+    }
+
+    return Append(data);
+}
+
+void MappedLogWriter::Flush()
+{
+    // nothing to do, the mapped pages already belong to the page cache
+}
+
+void MappedLogWriter::AddPreamble(std::string_view data)
+{
+    m_preamble += data;
+}
+
+bool MappedLogWriter::ShouldRoll(std::size_t size) const
+{
+    if (m_segment_written == 0)
+    {
+        return false;
+    }
+
+    // keep records in one piece unless a record is larger than a segment
+    if (m_segment_written + size > m_settings.segment_size)
+    {
+        return true;
+    }
+
+    return m_settings.roll_interval.count() > 0 &&
+           std::chrono::steady_clock::now() - m_segment_opened >=
+               m_settings.roll_interval;
+}
+
+bool MappedLogWriter::Roll()
+{
+    CloseSegment();
+
+    m_segment_index++;
+
+    if (m_settings.max_segments > 0 &&
+        m_segment_index >= m_settings.max_segments)
+    {
+        const auto expired = m_segment_index - m_settings.max_segments;
+        std::remove(GetSegmentPath(expired).c_str());
+    }
+
+    if (!OpenSegment())
+    {
+        return false;
+    }
+
+    // a preamble that does not fit would roll again and again
+    return m_preamble.size() >= m_settings.segment_size || Append(m_preamble);
+}
+
+bool MappedLogWriter::Append(std::string_view data)
+{
+    while (!data.empty())
+    {
+        // only a record larger than a whole segment gets here with a full one
+        if (m_segment_written == m_settings.segment_size && !Roll())
+        {
+            return false;
+        }
+
+        if (m_segment_written >= m_window_offset + m_window_size &&
+            !MapWindow(m_segment_written))
+        {
+            return false;
+        }
+
+        const std::size_t window_position = m_segment_written - m_window_offset;
+        const std::size_t chunk =
+            std::min(data.size(), m_window_size - window_position);
+
+        std::memcpy(m_window + window_position, data.data(), chunk);
+
+        m_segment_written += chunk;
+        data.remove_prefix(chunk);
+    }
+
+    return true;
+}
+
+std::string MappedLogWriter::GetSegmentPath(std::uint64_t index) const
+{
+    return m_path + '.' + std::to_string(index);
+}
+
+void MappedLogWriter::RemoveSegments() const
+{
+    namespace fs = std::filesystem;
+
+    // the same names LogReader::Open looks for, and their index files
+    const fs::path base(m_path);
+    const auto prefix = base.filename().string() + '.';
+    auto directory = base.parent_path();
+    if (directory.empty())
+    {
+        directory = ".";
+    }
+
+    std::error_code error;
+    std::vector<fs::path> segments;
+    for (const auto& entry : fs::directory_iterator(directory, error))
+    {
+        const auto file_name = entry.path().filename().string();
+        std::string_view name = file_name;
+        if (name.ends_with(".idx"))
+        {
+            name.remove_suffix(4);
+        }
+
+        if (name.starts_with(prefix) && name.size() > prefix.size() &&
+            std::all_of(name.begin() + prefix.size(), name.end(),
+                        [](char c) { return c >= '0' && c <= '9'; }))
+        {
+            segments.push_back(entry.path());
+        }
+    }
+
+    for (const auto& segment : segments)
+    {
+        fs::remove(segment, error);
+    }
+}
+
+VectoredLogWriter::VectoredLogWriter(const VectoredLogSettings& settings)
+    : m_settings(settings)
+    , m_alignment(kDirectWriteAlignment)
+    , m_direct(false)
+    , m_pending(0)
+    , m_written(0)
+    , m_file_offset(0)
+#ifdef _WIN32
+    , m_file_handle(INVALID_HANDLE_VALUE)
+#else
+    , m_file_descriptor(-1)
+#endif
+{
+    m_settings.chunk_size =
+        AlignUp(std::max<std::size_t>(m_settings.chunk_size, 1), m_alignment);
+    m_settings.flush_size = std::max<std::size_t>(m_settings.flush_size, 1);
+}
+
+VectoredLogWriter::~VectoredLogWriter()
+{
+    Close();
+
+    for (auto chunk : m_chunks)
+    {
+        ::operator delete(chunk, std::align_val_t(m_alignment));
+    }
+}
+
+bool VectoredLogWriter::Write(std::string_view data)
+{
+#ifdef _WIN32
+    if (m_file_handle == INVALID_HANDLE_VALUE)
+#else
+    if (m_file_descriptor < 0)
+#endif
+    {
+        return false;
+    }
+
+    if (m_pending == m_written)
+    {
+        m_pending_since = std::chrono::steady_clock::now();
+    }
+
+    const auto chunk_size = m_settings.chunk_size;
+
+    while (!data.empty())
+    {
+        const auto chunk_index = m_pending / chunk_size;
+        const auto chunk_offset = m_pending % chunk_size;
+
+        if (chunk_index == m_chunks.size())
+        {
+            m_chunks.push_back(static_cast<char*>(
+                ::operator new(chunk_size, std::align_val_t(m_alignment))));
+        }
+
+        const auto length = std::min(data.size(), chunk_size - chunk_offset);
+        std::memcpy(m_chunks[chunk_index] + chunk_offset, data.data(), length);
+
+        m_pending += length;
+        data.remove_prefix(length);
+    }
+
+    if (m_pending - m_written >= m_settings.flush_size)
+    {
+        return WritePending();
+    }
+
+    return true;
+}
+
+void VectoredLogWriter::Flush()
+{
+    WritePending();
+}
+
+void VectoredLogWriter::EndBatch()
+{
+    if (m_pending > m_written &&
+        std::chrono::steady_clock::now() - m_pending_since >=
+            m_settings.flush_interval)
+    {
+        WritePending();
+    }
+}
+
+bool VectoredLogWriter::WritePending()
+{
+    if (m_pending == m_written)
+    {
+        return true;
+    }
+
+    const auto size = m_pending;
+    bool result;
+
+    if (m_direct)
+    {
+        // pad the last block, chunks hold a whole number of blocks so the
+        // padding never crosses into the next one. The padding stays in the
+        // file until the next write covers it, Close truncates it away.
+        const auto padded = AlignUp(size, m_alignment);
+        const auto chunk_size = m_settings.chunk_size;
+        if (padded != size)
+        {
+            std::memset(m_chunks[size / chunk_size] + size % chunk_size, 0,
+                        padded - size);
+        }
+
+        result = WriteChunks(padded);
+
+        // the partial block moves to the front and is written again with
+        // the records that complete it
+        const auto tail = size % m_alignment;
+        const auto complete = size - tail;
+        if (tail > 0 && complete > 0)
+        {
+            std::memmove(m_chunks[0],
+                         m_chunks[complete / chunk_size] + complete % chunk_size,
+                         tail);
+        }
+
+        m_file_offset += complete;
+        m_pending = tail;
+        m_written = tail;
+    }
+    else
+    {
+        result = WriteChunks(size);
+
+        m_file_offset += size;
+        m_pending = 0;
+        m_written = 0;
+    }
+
+    // failed records are dropped rather than piling up in memory
+    return result;
+}
+
+#ifdef _WIN32
+
+bool VectoredLogWriter::Open(std::string_view path)
+{
+    Close();
+
+    const std::string file_path(path);
+    const DWORD flags = FILE_ATTRIBUTE_NORMAL;
+
+    m_direct = false;
+    if (m_settings.direct)
+    {
+        m_file_handle = CreateFileA(file_path.c_str(), GENERIC_WRITE,
+                                    FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                                    flags | FILE_FLAG_NO_BUFFERING, nullptr);
+        m_direct = m_file_handle != INVALID_HANDLE_VALUE;
+    }
+
+    if (m_file_handle == INVALID_HANDLE_VALUE)
+    {
+        m_file_handle = CreateFileA(file_path.c_str(), GENERIC_WRITE,
+                                    FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                                    flags, nullptr);
+        if (m_file_handle == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+    }
+
+    m_pending = 0;
+    m_written = 0;
+    m_file_offset = 0;
+    return true;
+}
+
+void VectoredLogWriter::Close()
+{
+    if (m_file_handle != INVALID_HANDLE_VALUE)
+    {
+        WritePending();
+
+        if (m_direct && m_pending > 0)
+        {
+            Truncate(m_file_offset + m_pending);
+        }
+
+        CloseHandle(m_file_handle);
+        m_file_handle = INVALID_HANDLE_VALUE;
+    }
+}
+
+bool VectoredLogWriter::WriteChunks(std::size_t size)
+{
+    // there is no gathering write for buffered files, the chunks are at
+    // least submitted back to back
+    const auto chunk_size = m_settings.chunk_size;
+
+    for (std::size_t position = 0; position < size; position += chunk_size)
+    {
+        const auto length = std::min(chunk_size, size - position);
+        const auto offset = m_file_offset + position;
+
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+        DWORD written;
+        if (!WriteFile(m_file_handle, m_chunks[position / chunk_size],
+                       static_cast<DWORD>(length), &written, &overlapped) ||
+            written != length)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool VectoredLogWriter::Truncate(std::uint64_t size)
+{
+    LARGE_INTEGER end;
+    end.QuadPart = static_cast<LONGLONG>(size);
+    return SetFilePointerEx(m_file_handle, end, nullptr, FILE_BEGIN) &&
+           SetEndOfFile(m_file_handle);
+}
+
+bool MappedLogWriter::OpenSegment()
+{
+    const auto path = GetSegmentPath(m_segment_index);
+
+    m_file_handle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                                FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file_handle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    // creating the mapping with the full segment size allocates the file
+    const auto size = static_cast<std::uint64_t>(m_settings.segment_size);
+    m_mapping_handle = CreateFileMappingA(m_file_handle, nullptr,
+                                          PAGE_READWRITE,
+                                          static_cast<DWORD>(size >> 32),
+                                          static_cast<DWORD>(size),
+                                          nullptr);
+    if (m_mapping_handle == nullptr)
+    {
+        CloseHandle(m_file_handle);
+        m_file_handle = INVALID_HANDLE_VALUE;
+        return false;
+    }
+
+    m_segment_written = 0;
+    m_segment_opened = std::chrono::steady_clock::now();
+
+    if (!MapWindow(0))
+    {
+        CloseSegment();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedLogWriter::CloseSegment()
+{
+    UnmapWindow();
+
+    if (m_mapping_handle != nullptr)
+    {
+        CloseHandle(m_mapping_handle);
+        m_mapping_handle = nullptr;
+    }
+
+    if (m_file_handle != INVALID_HANDLE_VALUE)
+    {
+        // give back the preallocated space we did not use
+        LARGE_INTEGER end;
+        end.QuadPart = static_cast<LONGLONG>(m_segment_written);
+        SetFilePointerEx(m_file_handle, end, nullptr, FILE_BEGIN);
+        SetEndOfFile(m_file_handle);
+
+        CloseHandle(m_file_handle);
+        m_file_handle = INVALID_HANDLE_VALUE;
+    }
+}
+
+bool MappedLogWriter::MapWindow(std::size_t offset)
+{
+    UnmapWindow();
+
+    const auto aligned = offset / m_granularity * m_granularity;
+    const auto size = std::min(m_settings.window_size,
+                               m_settings.segment_size - aligned);
+    const auto aligned_offset = static_cast<std::uint64_t>(aligned);
+
+    m_window = static_cast<char*>(MapViewOfFile(
+        m_mapping_handle, FILE_MAP_WRITE,
+        static_cast<DWORD>(aligned_offset >> 32),
+        static_cast<DWORD>(aligned_offset), size));
+    if (m_window == nullptr)
+    {
+        return false;
+    }
+
+    m_window_offset = aligned;
+    m_window_size = size;
+    return true;
+}
+
+void MappedLogWriter::UnmapWindow()
+{
+    if (m_window != nullptr)
+    {
+        UnmapViewOfFile(m_window);
+        m_window = nullptr;
+        m_window_offset = 0;
+        m_window_size = 0;
+    }
+}
+
+#else
+
+bool VectoredLogWriter::Open(std::string_view path)
+{
+    Close();
+
+    const std::string file_path(path);
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+
+    m_direct = false;
+#ifdef O_DIRECT
+    if (m_settings.direct)
+    {
+        m_file_descriptor = open(file_path.c_str(), flags | O_DIRECT, 0644);
+        m_direct = m_file_descriptor >= 0;
+    }
+#endif
+
+    if (m_file_descriptor < 0)
+    {
+        m_file_descriptor = open(file_path.c_str(), flags, 0644);
+        if (m_file_descriptor < 0)
+        {
+            return false;
+        }
+    }
+
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+    if (m_settings.direct)
+    {
+        // closest thing there is, no alignment rules to follow
+        fcntl(m_file_descriptor, F_NOCACHE, 1);
+    }
+#endif
+
+    m_pending = 0;
+    m_written = 0;
+    m_file_offset = 0;
+    return true;
+}
+
+void VectoredLogWriter::Close()
+{
+    if (m_file_descriptor >= 0)
+    {
+        WritePending();
+
+        if (m_direct && m_pending > 0)
+        {
+            Truncate(m_file_offset + m_pending);
+        }
+
+        close(m_file_descriptor);
+        m_file_descriptor = -1;
+    }
+}
+
+bool VectoredLogWriter::WriteChunks(std::size_t size)
+{
+    const auto chunk_size = m_settings.chunk_size;
+    std::size_t done = 0;
+
+    while (done < size)
+    {
+        iovec vectors[kMaxWriteChunks];
+        int count = 0;
+
+        for (auto position = done; position < size && count < kMaxWriteChunks;
+             count++)
+        {
+            const auto chunk_offset = position % chunk_size;
+            const auto length =
+                std::min(chunk_size - chunk_offset, size - position);
+
+            vectors[count].iov_base = m_chunks[position / chunk_size] +
+                                      chunk_offset;
+            vectors[count].iov_len = length;
+            position += length;
+        }
+
+        const auto written = pwritev(m_file_descriptor, vectors, count,
+                                     static_cast<off_t>(m_file_offset + done));
+        if (written <= 0)
+        {
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        done += static_cast<std::size_t>(written);
+    }
+
+    return true;
+}
+
+bool VectoredLogWriter::Truncate(std::uint64_t size)
+{
+    return ftruncate(m_file_descriptor, static_cast<off_t>(size)) == 0;
+}
+
+bool MappedLogWriter::OpenSegment()
+{
+    const auto path = GetSegmentPath(m_segment_index);
+
+    m_file_descriptor = open(path.c_str(),
+                             O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_file_descriptor < 0)
+    {
+        return false;
+    }
+
+    // reserve the blocks now so appending never has to touch the metadata
+    const auto size = static_cast<off_t>(m_settings.segment_size);
+    if (posix_fallocate(m_file_descriptor, 0, size) != 0 &&
+        ftruncate(m_file_descriptor, size) != 0)
+    {
+        close(m_file_descriptor);
+        m_file_descriptor = -1;
+        return false;
+    }
+
+    m_segment_written = 0;
+    m_segment_opened = std::chrono::steady_clock::now();
+
+    if (!MapWindow(0))
+    {
+        CloseSegment();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedLogWriter::CloseSegment()
+{
+    UnmapWindow();
+
+    if (m_file_descriptor >= 0)
+    {
+        // give back the preallocated space we did not use
+        if (ftruncate(m_file_descriptor,
+                      static_cast<off_t>(m_segment_written)) != 0)
+        {
+            // nothing to do about it here, the segment just keeps its
+            // zero filled tail
+        }
+
+        close(m_file_descriptor);
+        m_file_descriptor = -1;
+    }
+}
+
+bool MappedLogWriter::MapWindow(std::size_t offset)
+{
+    UnmapWindow();
+
+    const auto aligned = offset / m_granularity * m_granularity;
+    const auto size = std::min(m_settings.window_size,
+                               m_settings.segment_size - aligned);
+
+    void* window = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                        m_file_descriptor, static_cast<off_t>(aligned));
+    if (window == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_window = static_cast<char*>(window);
+    m_window_offset = aligned;
+    m_window_size = size;
+    return true;
+}
+
+void MappedLogWriter::UnmapWindow()
+{
+    if (m_window != nullptr)
+    {
+        munmap(m_window, m_window_size);
+        m_window = nullptr;
+        m_window_offset = 0;
+        m_window_size = 0;
+    }
+}
+
+#endif // _WIN32
+
+}
@@ -0,0 +1,235 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOOHAHA_CORE_LOG_WRITER_H_
+#define HOOHAHA_CORE_LOG_WRITER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace core
+{
+
+// Where the bytes produced by Log end up. A writer is only ever used by one
+// thread at a time: the logging thread under the log mutex in sync mode, or
+// the writer thread in async mode.
+class LogWriter
+{
+public:
+    virtual ~LogWriter();
+
+    virtual bool Open(std::string_view path) = 0;
+    virtual void Close() = 0;
+
+    virtual bool Write(std::string_view data) = 0;
+    // pushes everything written so far to the file
+    virtual void Flush() = 0;
+
+    // Called after every record in sync mode, after every batch in async
+    // mode and periodically while the async writer is idle. Writers with a
+    // batching policy of their own decide here whether to write, by default
+    // it flushes.
+    virtual void EndBatch();
+
+    // Appends to the data every file opened from now on starts with, the
+    // header and descriptors of a binary log. Only writers that split the
+    // log into several files keep it.
+    virtual void AddPreamble(std::string_view data);
+};
+
+// Plain fopen/fwrite/fflush file
+class StdioLogWriter final : public LogWriter
+{
+public:
+    StdioLogWriter();
+    StdioLogWriter(const StdioLogWriter&) = delete;
+    StdioLogWriter(StdioLogWriter&&) = delete;
+    ~StdioLogWriter() override;
+
+    bool Open(std::string_view path) override;
+    void Close() override;
+
+    bool Write(std::string_view data) override;
+    void Flush() override;
+
+    StdioLogWriter& operator=(const StdioLogWriter&) = delete;
+    StdioLogWriter& operator=(StdioLogWriter&&) = delete;
+
+private:
+    FILE*  m_file;
+};
+
+struct MappedLogSettings
+{
+    // every segment is preallocated to this size up front
+    std::size_t           segment_size = 64 * 1024 * 1024;
+    // how much of a segment is mapped at once
+    std::size_t           window_size = 4 * 1024 * 1024;
+    // start a new segment after this much time, zero disables it
+    std::chrono::seconds  roll_interval = std::chrono::seconds(0);
+    // oldest segments are deleted beyond this count, zero keeps all of them
+    std::size_t           max_segments = 0;
+};
+
+// Writes into fixed size, preallocated segments through a memory mapped
+// window, so appending a record is a memcpy with no file size or metadata
+// update. Segments are named <path>.0, <path>.1 and so on. When a segment is
+// closed the file is truncated to the bytes actually written.
+//
+// Written pages belong to the kernel right away, so a crash of the process
+// loses nothing that a flushed stdio file would have kept. The segment is
+// not truncated then and keeps its NUL filled tail, readers stop at the
+// first NUL byte.
+//
+// Every segment starts with the preamble (see AddPreamble), so the segments
+// of a binary log (LogFormat::kBinary) decode on their own and deleting the
+// oldest ones loses no descriptors.
+class MappedLogWriter final : public LogWriter
+{
+public:
+    explicit MappedLogWriter(const MappedLogSettings& settings);
+    MappedLogWriter(const MappedLogWriter&) = delete;
+    MappedLogWriter(MappedLogWriter&&) = delete;
+    ~MappedLogWriter() override;
+
+    bool Open(std::string_view path) override;
+    void Close() override;
+
+    bool Write(std::string_view data) override;
+    void Flush() override;
+
+    void AddPreamble(std::string_view data) override;
+
+    MappedLogWriter& operator=(const MappedLogWriter&) = delete;
+    MappedLogWriter& operator=(MappedLogWriter&&) = delete;
+
+private:
+    bool ShouldRoll(std::size_t size) const;
+    bool Roll();
+    bool Append(std::string_view data);
+
+    std::string GetSegmentPath(std::uint64_t index) const;
+    // deletes the segments of a previous log at the same path
+    void RemoveSegments() const;
+
+    bool OpenSegment();
+    void CloseSegment();
+    bool MapWindow(std::size_t offset);
+    void UnmapWindow();
+
+private:
+    MappedLogSettings  m_settings;
+    std::string        m_path;
+    std::size_t        m_granularity;
+    std::string        m_preamble;
+
+    std::uint64_t      m_segment_index;
+    std::size_t        m_segment_written;
+    std::chrono::steady_clock::time_point m_segment_opened;
+
+    char*              m_window;
+    std::size_t        m_window_offset;
+    std::size_t        m_window_size;
+
+#ifdef _WIN32
+    void*              m_file_handle;
+    void*              m_mapping_handle;
+#else
+    int                m_file_descriptor;
+#endif
+};
+
+struct VectoredLogSettings
+{
+    // size of every staging chunk, a chunk is one entry of the write vector
+    std::size_t                chunk_size = 64 * 1024;
+    // pending bytes that trigger a write
+    std::size_t                flush_size = 1024 * 1024;
+    // pending bytes are written at least this often
+    std::chrono::milliseconds  flush_interval = std::chrono::milliseconds(100);
+    // bypass the page cache, O_DIRECT or FILE_FLAG_NO_BUFFERING. Falls back
+    // to a normal file where the file system does not support it.
+    bool                       direct = false;
+};
+
+// Copies records into aligned staging chunks and writes all pending chunks
+// with a single writev once flush_size bytes are pending, flush_interval
+// has passed since the oldest pending record or Flush is called. Log calls
+// Flush for every record at LogLevel::kError and above.
+//
+// In direct mode only whole blocks can be written: the last partial block
+// is padded with NULs and written again together with the next records. The
+// file is truncated back to its real size on Close, a process that dies
+// before that leaves up to one block of NULs at the end of the file.
+//
+// In sync mode the interval is only checked when the next record arrives,
+// the async writer thread also checks it while idle.
+class VectoredLogWriter final : public LogWriter
+{
+public:
+    explicit VectoredLogWriter(const VectoredLogSettings& settings);
+    VectoredLogWriter(const VectoredLogWriter&) = delete;
+    VectoredLogWriter(VectoredLogWriter&&) = delete;
+    ~VectoredLogWriter() override;
+
+    bool Open(std::string_view path) override;
+    void Close() override;
+
+    bool Write(std::string_view data) override;
+    void Flush() override;
+    void EndBatch() override;
+
+    VectoredLogWriter& operator=(const VectoredLogWriter&) = delete;
+    VectoredLogWriter& operator=(VectoredLogWriter&&) = delete;
+
+private:
+    bool WritePending();
+    // writes the first size bytes of the staging chunks at m_file_offset
+    bool WriteChunks(std::size_t size);
+    bool Truncate(std::uint64_t size);
+
+private:
+    VectoredLogSettings  m_settings;
+    std::size_t          m_alignment;
+    bool                 m_direct;
+
+    std::vector<char*>   m_chunks;
+    // bytes in the staging chunks, the first m_written of them are already
+    // in the file (the kept partial block in direct mode)
+    std::size_t          m_pending;
+    std::size_t          m_written;
+    std::chrono::steady_clock::time_point m_pending_since;
+
+    // where the first staged byte goes
+    std::uint64_t        m_file_offset;
+
+#ifdef _WIN32
+    void*                m_file_handle;
+#else
+    int                  m_file_descriptor;
+#endif
+};
+
+}
+
+#endif // HOOHAHA_CORE_LOG_WRITER_H_
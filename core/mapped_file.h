@@ -0,0 +1,58 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef HOOHAHA_CORE_MAPPED_FILE_H_
+#define HOOHAHA_CORE_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace core
+{
+
+// Read only mapping of a whole file. An empty file opens fine and maps
+// nothing.
+class MappedFile final
+{
+public:
+    MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) = delete;
+    ~MappedFile();
+
+    bool Open(const std::string& path);
+    void Close();
+
+    std::string_view GetData() const;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+
+private:
+    const char*  m_data;
+    std::size_t  m_size;
+#ifdef _WIN32
+    void*        m_mapping_handle;
+#endif
+};
+
+}
+
+#endif // HOOHAHA_CORE_MAPPED_FILE_H_
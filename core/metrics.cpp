@@ -0,0 +1,626 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <format>
+#include <iterator>
+#include <unordered_map>
+
+#include "log.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace core
+{
+
+namespace
+{
+
+// how often the reporter thread looks for socket clients
+const std::chrono::milliseconds kSocketPollInterval(100);
+// how long a socket client that does not read may hold up the reporter
+const std::chrono::milliseconds kSocketSendTimeout(100);
+
+struct MetricRegistry
+{
+    std::mutex            mutex;
+    std::vector<Metric*>  metrics;
+
+    // counter values at the previous LogMetrics call, to print rates
+    std::unordered_map<const Metric*, std::uint64_t>  logged_counts;
+    std::chrono::steady_clock::time_point             logged_time;
+};
+
+MetricRegistry& GetMetricRegistry()
+{
+    static MetricRegistry registry;
+    return registry;
+}
+
+// Registered metrics ordered by name, so that the samples of one family
+// stay together. The caller holds the registry mutex.
+std::vector<const Metric*> GetSortedMetrics(const MetricRegistry& registry)
+{
+    std::vector<const Metric*> metrics(registry.metrics.begin(),
+                                       registry.metrics.end());
+    std::stable_sort(metrics.begin(), metrics.end(),
+        [](const Metric* a, const Metric* b)
+        {
+            return a->GetName() < b->GetName();
+        });
+    return metrics;
+}
+
+const char* GetMetricTypeName(MetricType type)
+{
+    switch (type)
+    {
+    case MetricType::kCounter:
+        return "counter";
+    case MetricType::kGauge:
+        return "gauge";
+    case MetricType::kHistogram:
+        return "histogram";
+    }
+    return "untyped";
+}
+
+// name{labels} with an optional extra label appended to the metric's own
+void AppendMetricSample(std::string& output, std::string_view name,
+                        std::string_view suffix, std::string_view labels,
+                        std::string_view extra_label)
+{
+    output += name;
+    output += suffix;
+
+    if (!labels.empty() || !extra_label.empty())
+    {
+        output += '{';
+        output += labels;
+        if (!labels.empty() && !extra_label.empty())
+        {
+            output += ',';
+        }
+        output += extra_label;
+        output += '}';
+    }
+
+    output += ' ';
+}
+
+void AppendPrometheusHistogram(std::string& output,
+                               const MetricHistogram& histogram)
+{
+    std::vector<std::uint64_t> counts;
+    std::uint64_t sum;
+    histogram.GetCounts(counts, sum);
+
+    const auto& bounds = histogram.GetBounds();
+    std::uint64_t cumulative = 0;
+
+    for (std::size_t i = 0; i < counts.size(); i++)
+    {
+        cumulative += counts[i];
+
+        const auto le = i < bounds.size()
+            ? std::format("le=\"{}\"", bounds[i])
+            : std::string("le=\"+Inf\"");
+        AppendMetricSample(output, histogram.GetName(), "_bucket",
+                           histogram.GetLabels(), le);
+        std::format_to(std::back_inserter(output), "{}\n", cumulative);
+    }
+
+    AppendMetricSample(output, histogram.GetName(), "_sum",
+                       histogram.GetLabels(), {});
+    std::format_to(std::back_inserter(output), "{}\n", sum);
+
+    AppendMetricSample(output, histogram.GetName(), "_count",
+                       histogram.GetLabels(), {});
+    std::format_to(std::back_inserter(output), "{}\n", cumulative);
+}
+
+std::string FormatMetricName(const Metric& metric)
+{
+    if (metric.GetLabels().empty())
+    {
+        return std::string(metric.GetName());
+    }
+
+    return std::format("{}{{{}}}", metric.GetName(), metric.GetLabels());
+}
+
+bool WriteTextFile(const std::string& path, std::string_view text)
+{
+    // write a temporary file and move it over, readers never see half of it
+    const auto temporary_path = path + ".tmp";
+
+    auto file = std::fopen(temporary_path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    const bool written =
+        std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    if (std::fclose(file) != 0 || !written)
+    {
+        std::remove(temporary_path.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    // rename does not replace an existing file on Windows
+    std::remove(path.c_str());
+#endif
+
+    return std::rename(temporary_path.c_str(), path.c_str()) == 0;
+}
+
+} // namespace
+
+Metric::Metric(MetricType type, std::string_view name, std::string_view help,
+               std::string_view labels)
+    : m_type(type)
+    , m_name(name)
+    , m_help(help)
+    , m_labels(labels)
+{
+    auto& registry = GetMetricRegistry();
+
+    std::lock_guard lock(registry.mutex);
+    registry.metrics.push_back(this);
+}
+
+Metric::~Metric()
+{
+    auto& registry = GetMetricRegistry();
+
+    std::lock_guard lock(registry.mutex);
+    std::erase(registry.metrics, this);
+    registry.logged_counts.erase(this);
+}
+
+MetricType Metric::GetType() const
+{
+    return m_type;
+}
+
+std::string_view Metric::GetName() const
+{
+    return m_name;
+}
+
+std::string_view Metric::GetHelp() const
+{
+    return m_help;
+}
+
+std::string_view Metric::GetLabels() const
+{
+    return m_labels;
+}
+
+MetricCounter::MetricCounter(std::string_view name, std::string_view help,
+                             std::string_view labels)
+    : Metric(MetricType::kCounter, name, help, labels)
+{
+}
+
+std::uint64_t MetricCounter::GetValue() const
+{
+    std::uint64_t value = 0;
+    for (const auto& shard : m_shards)
+    {
+        value += shard.value.load(std::memory_order_relaxed);
+    }
+    return value;
+}
+
+MetricGauge::MetricGauge(std::string_view name, std::string_view help,
+                         std::string_view labels)
+    : Metric(MetricType::kGauge, name, help, labels)
+    , m_value(0)
+{
+}
+
+std::int64_t MetricGauge::GetValue() const
+{
+    return m_value.load(std::memory_order_relaxed);
+}
+
+MetricHistogram::MetricHistogram(std::string_view name, std::string_view help,
+                                 std::initializer_list<std::uint64_t> bounds,
+                                 std::string_view labels)
+    : Metric(MetricType::kHistogram, name, help, labels)
+    , m_bounds(bounds)
+    , m_shard_stride((bounds.size() + 2 + 7) / 8 * 8)
+    , m_lines(new Line[kMetricShardCount * m_shard_stride / 8])
+{
+    for (std::size_t i = 0; i < kMetricShardCount * m_shard_stride; i++)
+    {
+        GetShard(0)[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+const std::vector<std::uint64_t>& MetricHistogram::GetBounds() const
+{
+    return m_bounds;
+}
+
+void MetricHistogram::GetCounts(std::vector<std::uint64_t>& counts,
+                                std::uint64_t& sum) const
+{
+    counts.assign(m_bounds.size() + 1, 0);
+    sum = 0;
+
+    for (std::size_t shard_index = 0; shard_index < kMetricShardCount;
+         shard_index++)
+    {
+        const auto shard = GetShard(shard_index);
+        for (std::size_t i = 0; i < counts.size(); i++)
+        {
+            counts[i] += shard[i].load(std::memory_order_relaxed);
+        }
+        sum += shard[counts.size()].load(std::memory_order_relaxed);
+    }
+}
+
+std::atomic<std::uint64_t>* MetricHistogram::GetShard(std::size_t shard) const
+{
+    return m_lines[0].values + shard * m_shard_stride;
+}
+
+void WriteMetricsPrometheus(std::string& output)
+{
+    auto& registry = GetMetricRegistry();
+
+    std::lock_guard lock(registry.mutex);
+
+    std::string_view family;
+    for (auto metric : GetSortedMetrics(registry))
+    {
+        if (metric->GetName() != family)
+        {
+            family = metric->GetName();
+            std::format_to(std::back_inserter(output),
+                           "# HELP {} {}\n# TYPE {} {}\n", family,
+                           metric->GetHelp(), family,
+                           GetMetricTypeName(metric->GetType()));
+        }
+
+        switch (metric->GetType())
+        {
+        case MetricType::kCounter:
+            AppendMetricSample(output, family, {}, metric->GetLabels(), {});
+            std::format_to(std::back_inserter(output), "{}\n",
+                static_cast<const MetricCounter*>(metric)->GetValue());
+            break;
+        case MetricType::kGauge:
+            AppendMetricSample(output, family, {}, metric->GetLabels(), {});
+            std::format_to(std::back_inserter(output), "{}\n",
+                static_cast<const MetricGauge*>(metric)->GetValue());
+            break;
+        case MetricType::kHistogram:
+            AppendPrometheusHistogram(output,
+                *static_cast<const MetricHistogram*>(metric));
+            break;
+        }
+    }
+}
+
+void LogMetrics()
+{
+    auto& registry = GetMetricRegistry();
+
+    std::lock_guard lock(registry.mutex);
+
+    const auto now = std::chrono::steady_clock::now();
+    const bool has_previous = !registry.logged_counts.empty();
+    const double elapsed =
+        std::chrono::duration<double>(now - registry.logged_time).count();
+    registry.logged_time = now;
+
+    for (auto metric : GetSortedMetrics(registry))
+    {
+        const auto name = FormatMetricName(*metric);
+
+        switch (metric->GetType())
+        {
+        case MetricType::kCounter:
+        {
+            const auto value =
+                static_cast<const MetricCounter*>(metric)->GetValue();
+            auto& logged = registry.logged_counts[metric];
+
+            if (has_previous && elapsed > 0.0)
+            {
+                HOOHAHA_LOG_INFO("Metric {} = {} ({:.1f}/s)", name, value,
+                                 static_cast<double>(value - logged) / elapsed);
+            }
+            else
+            {
+                HOOHAHA_LOG_INFO("Metric {} = {}", name, value);
+            }
+
+            logged = value;
+            break;
+        }
+        case MetricType::kGauge:
+            HOOHAHA_LOG_INFO("Metric {} = {}", name,
+                static_cast<const MetricGauge*>(metric)->GetValue());
+            break;
+        case MetricType::kHistogram:
+        {
+            std::vector<std::uint64_t> counts;
+            std::uint64_t sum;
+            static_cast<const MetricHistogram*>(metric)->GetCounts(counts, sum);
+
+            std::uint64_t count = 0;
+            std::string buckets;
+            for (auto bucket : counts)
+            {
+                count += bucket;
+                std::format_to(std::back_inserter(buckets), "{}{}",
+                               buckets.empty() ? "" : " ", bucket);
+            }
+
+            HOOHAHA_LOG_INFO("Metric {} count {}, mean {:.1f}, buckets {}",
+                name, count,
+                count > 0 ? static_cast<double>(sum) / count : 0.0,
+                buckets);
+            break;
+        }
+        }
+    }
+}
+
+MetricsReporter::MetricsReporter()
+    : m_stop(false)
+    , m_socket(-1)
+{
+}
+
+MetricsReporter::~MetricsReporter()
+{
+    Stop();
+}
+
+bool MetricsReporter::Start(const MetricsReporterSettings& settings)
+{
+    Stop();
+
+    m_settings = settings;
+    m_stop = false;
+
+    if (!m_settings.prometheus_socket.empty() && !OpenSocket())
+    {
+        return false;
+    }
+
+    m_thread = std::thread(&MetricsReporter::ThreadMain, this);
+    return true;
+}
+
+void MetricsReporter::Stop()
+{
+    if (!m_thread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_condition.notify_one();
+    m_thread.join();
+
+    CloseSocket();
+}
+
+void MetricsReporter::ThreadMain()
+{
+    SetCurrentThreadName("metrics");
+
+    const auto interval =
+        std::max(m_settings.interval, std::chrono::milliseconds(1));
+    auto next_report = std::chrono::steady_clock::now() + interval;
+
+    std::unique_lock lock(m_mutex);
+
+    while (!m_stop)
+    {
+        auto wake_time = next_report;
+        if (m_socket >= 0)
+        {
+            wake_time = std::min(wake_time, std::chrono::steady_clock::now() +
+                                                kSocketPollInterval);
+        }
+
+        m_condition.wait_until(lock, wake_time);
+        if (m_stop)
+        {
+            break;
+        }
+
+        lock.unlock();
+
+        ServeSocket();
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= next_report)
+        {
+            Report();
+            next_report = now + interval;
+        }
+
+        lock.lock();
+    }
+
+    lock.unlock();
+
+    // publish the final values
+    Report();
+}
+
+void MetricsReporter::Report()
+{
+    if (m_settings.log)
+    {
+        LogMetrics();
+    }
+
+    if (!m_settings.prometheus_file.empty())
+    {
+        std::string text;
+        WriteMetricsPrometheus(text);
+
+        if (!WriteTextFile(m_settings.prometheus_file, text))
+        {
+            HOOHAHA_LOG_ERROR("Unable to write metrics to {}",
+                              m_settings.prometheus_file);
+        }
+    }
+}
+
+#ifdef _WIN32
+
+bool MetricsReporter::OpenSocket()
+{
+    HOOHAHA_LOG_ERROR("Metrics socket {} is not supported on Windows",
+                      m_settings.prometheus_socket);
+    return false;
+}
+
+void MetricsReporter::CloseSocket()
+{
+}
+
+void MetricsReporter::ServeSocket()
+{
+}
+
+#else
+
+bool MetricsReporter::OpenSocket()
+{
+    const auto& path = m_settings.prometheus_socket;
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        HOOHAHA_LOG_ERROR("Metrics socket path {} is too long", path);
+        return false;
+    }
+    std::copy(path.begin(), path.end(), address.sun_path);
+
+    const int descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (descriptor < 0)
+    {
+        HOOHAHA_LOG_ERROR("Unable to create metrics socket {}", path);
+        return false;
+    }
+
+    // a stale socket file of a previous run would make bind fail
+    unlink(path.c_str());
+
+    fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+    fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+
+    if (bind(descriptor, reinterpret_cast<const sockaddr*>(&address),
+             sizeof(address)) != 0 ||
+        listen(descriptor, 8) != 0)
+    {
+        HOOHAHA_LOG_ERROR("Unable to listen on metrics socket {}", path);
+        close(descriptor);
+        return false;
+    }
+
+    m_socket = descriptor;
+    return true;
+}
+
+void MetricsReporter::CloseSocket()
+{
+    if (m_socket >= 0)
+    {
+        close(static_cast<int>(m_socket));
+        unlink(m_settings.prometheus_socket.c_str());
+        m_socket = -1;
+    }
+}
+
+void MetricsReporter::ServeSocket()
+{
+    if (m_socket < 0)
+    {
+        return;
+    }
+
+    int client;
+    while ((client = accept(static_cast<int>(m_socket), nullptr, nullptr)) >= 0)
+    {
+        // a client that stops reading would block send, and with it the
+        // reports and Stop, so it is dropped after the timeout
+        timeval timeout = {};
+        timeout.tv_usec = static_cast<suseconds_t>(
+            std::chrono::microseconds(kSocketSendTimeout).count());
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout,
+                   sizeof(timeout));
+
+        std::string text;
+        WriteMetricsPrometheus(text);
+
+#ifdef MSG_NOSIGNAL
+        const int flags = MSG_NOSIGNAL;
+#else
+        const int flags = 0;
+#endif
+
+        // the socket was accepted blocking, a client that went away or timed
+        // out just makes send fail
+        std::string_view remaining = text;
+        while (!remaining.empty())
+        {
+            const auto sent =
+                send(client, remaining.data(), remaining.size(), flags);
+            if (sent <= 0)
+            {
+                break;
+            }
+            remaining.remove_prefix(static_cast<std::size_t>(sent));
+        }
+
+        close(client);
+    }
+}
+
+#endif // _WIN32
+
+}
@@ -0,0 +1,244 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOOHAHA_CORE_METRICS_H_
+#define HOOHAHA_CORE_METRICS_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "thread_registry.h"
+
+namespace core
+{
+
+// Counters and histograms spread their updates over this many cache line
+// sized shards, picked by the thread id, and add them up when read
+constexpr std::size_t kMetricShardCount = 16;
+
+enum class MetricType
+{
+    kCounter,
+    kGauge,
+    kHistogram
+};
+
+// Base of all metrics. Metrics register themselves on construction and are
+// usually globals, e.g.
+//
+//     MetricCounter g_loads("keyvalues_loads_total", "Documents loaded");
+//
+// Several metrics can share a name when their labels differ, labels are
+// given in the Prometheus syntax: level="info"
+class Metric
+{
+public:
+    Metric(MetricType type, std::string_view name, std::string_view help,
+           std::string_view labels);
+    Metric(const Metric&) = delete;
+    Metric(Metric&&) = delete;
+    virtual ~Metric();
+
+    MetricType GetType() const;
+    std::string_view GetName() const;
+    std::string_view GetHelp() const;
+    std::string_view GetLabels() const;
+
+    Metric& operator=(const Metric&) = delete;
+    Metric& operator=(Metric&&) = delete;
+
+protected:
+    // shard of the calling thread
+    static inline std::size_t GetShardIndex();
+
+private:
+    const MetricType   m_type;
+    const std::string  m_name;
+    const std::string  m_help;
+    const std::string  m_labels;
+};
+
+// Monotonic count of events
+class MetricCounter final : public Metric
+{
+public:
+    MetricCounter(std::string_view name, std::string_view help,
+                  std::string_view labels = {});
+
+    inline void Increment(std::uint64_t value = 1);
+    std::uint64_t GetValue() const;
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<std::uint64_t>  value{ 0 };
+    };
+
+    Shard  m_shards[kMetricShardCount];
+};
+
+// Value that goes up and down, e.g. a queue length
+class MetricGauge final : public Metric
+{
+public:
+    MetricGauge(std::string_view name, std::string_view help,
+                std::string_view labels = {});
+
+    inline void Set(std::int64_t value);
+    inline void Add(std::int64_t value);
+    std::int64_t GetValue() const;
+
+private:
+    std::atomic<std::int64_t>  m_value;
+};
+
+// Distribution of values over fixed buckets, e.g. latencies in
+// microseconds. A bucket counts the values up to and including its bound,
+// values above the last bound go to an overflow bucket.
+class MetricHistogram final : public Metric
+{
+public:
+    MetricHistogram(std::string_view name, std::string_view help,
+                    std::initializer_list<std::uint64_t> bounds,
+                    std::string_view labels = {});
+
+    inline void Observe(std::uint64_t value);
+
+    const std::vector<std::uint64_t>& GetBounds() const;
+    // per bucket, not cumulative, the last one is the overflow bucket
+    void GetCounts(std::vector<std::uint64_t>& counts,
+                   std::uint64_t& sum) const;
+
+private:
+    struct alignas(64) Line
+    {
+        std::atomic<std::uint64_t>  values[8];
+    };
+
+    // every shard is the bucket counts followed by the sum, rounded up to
+    // whole cache lines
+    std::atomic<std::uint64_t>* GetShard(std::size_t shard) const;
+
+private:
+    const std::vector<std::uint64_t>  m_bounds;
+    const std::size_t                 m_shard_stride;
+    std::unique_ptr<Line[]>           m_lines;
+};
+
+// Current value of every registered metric in the Prometheus text format
+void WriteMetricsPrometheus(std::string& output);
+
+// Writes a snapshot of every registered metric through core::Log, counters
+// with their rate since the previous call
+void LogMetrics();
+
+struct MetricsReporterSettings
+{
+    // how often the snapshot is logged and the file rewritten
+    std::chrono::milliseconds  interval = std::chrono::seconds(60);
+    bool                       log = true;
+    // Prometheus text file, rewritten atomically, e.g. for the node
+    // exporter textfile collector. Empty disables it.
+    std::string                prometheus_file;
+    // UNIX socket path, every client that connects gets the Prometheus text
+    // and the connection is closed. Empty disables it, not available on
+    // Windows.
+    std::string                prometheus_socket;
+};
+
+// Background thread that publishes the metrics periodically
+class MetricsReporter final
+{
+public:
+    MetricsReporter();
+    MetricsReporter(const MetricsReporter&) = delete;
+    MetricsReporter(MetricsReporter&&) = delete;
+    ~MetricsReporter();
+
+    bool Start(const MetricsReporterSettings& settings);
+    void Stop();
+
+    MetricsReporter& operator=(const MetricsReporter&) = delete;
+    MetricsReporter& operator=(MetricsReporter&&) = delete;
+
+private:
+    void ThreadMain();
+    void Report();
+    bool OpenSocket();
+    void CloseSocket();
+    void ServeSocket();
+
+private:
+    MetricsReporterSettings  m_settings;
+
+    std::thread              m_thread;
+    std::mutex               m_mutex;
+    std::condition_variable  m_condition;
+    bool                     m_stop;
+
+    // listening socket, -1 when not used
+    std::intptr_t            m_socket;
+};
+
+inline std::size_t Metric::GetShardIndex()
+{
+    thread_local const std::size_t shard = CurrentThreadId() % kMetricShardCount;
+    return shard;
+}
+
+inline void MetricCounter::Increment(std::uint64_t value)
+{
+    m_shards[GetShardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+}
+
+inline void MetricGauge::Set(std::int64_t value)
+{
+    m_value.store(value, std::memory_order_relaxed);
+}
+
+inline void MetricGauge::Add(std::int64_t value)
+{
+    m_value.fetch_add(value, std::memory_order_relaxed);
+}
+
+inline void MetricHistogram::Observe(std::uint64_t value)
+{
+    std::size_t bucket = 0;
+    while (bucket < m_bounds.size() && value > m_bounds[bucket])
+    {
+        bucket++;
+    }
+
+    auto shard = GetShard(GetShardIndex());
+    shard[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard[m_bounds.size() + 1].fetch_add(value, std::memory_order_relaxed);
+}
+
+}
+
+#endif // HOOHAHA_CORE_METRICS_H_
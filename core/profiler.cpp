@@ -0,0 +1,294 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "profiler.h"
+
+#include <cstdio>
+#include <format>
+#include <iterator>
+#include <string>
+
+#include "log.h"
+#include "thread_registry.h"
+
+namespace core
+{
+
+Profiler profiler;
+
+struct ProfileZone
+{
+    const char*   name;
+    std::int64_t  begin;
+    std::int64_t  end;
+};
+
+// Zones of one thread in one capture. Only the owning thread writes, the
+// exporter reads the zones published through count.
+struct ProfileThreadBuffer
+{
+    ProfileThreadBuffer(std::uint32_t owner_thread_id, std::size_t capacity)
+        : thread_id(owner_thread_id)
+        , zones(new ProfileZone[capacity])
+        , zone_capacity(capacity)
+        , count(0)
+        , dropped(0)
+    {
+    }
+
+    const std::uint32_t             thread_id;
+    std::unique_ptr<ProfileZone[]>  zones;
+    const std::size_t               zone_capacity;
+    std::atomic<std::size_t>        count;
+    std::atomic<std::uint64_t>      dropped;
+};
+
+namespace
+{
+
+const std::size_t kExportBufferSize = 64 * 1024;
+
+// The buffer the current thread writes into during the current capture
+struct ThreadBuffer
+{
+    std::uint64_t                         capture = 0;
+    std::shared_ptr<ProfileThreadBuffer>  buffer;
+};
+
+thread_local ThreadBuffer t_thread_buffer;
+
+std::atomic<std::uint64_t> g_last_capture(0);
+
+void AppendJsonString(std::string& output, std::string_view value)
+{
+    output += '"';
+
+    for (const char c : value)
+    {
+        switch (c)
+        {
+        case '"':
+            output += "\\\"";
+            break;
+        case '\\':
+            output += "\\\\";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                std::format_to(std::back_inserter(output), "\\u{:04x}",
+                               static_cast<unsigned>(c));
+            }
+            else
+            {
+                output += c;
+            }
+            break;
+        }
+    }
+
+    output += '"';
+}
+
+} // namespace
+
+Profiler::Profiler()
+    : m_capturing(false)
+    , m_capture(0)
+    , m_zones_per_thread(0)
+    , m_capture_begin(0)
+    , m_capture_end(0)
+{
+}
+
+Profiler::~Profiler()
+{
+}
+
+void Profiler::Start(std::size_t zones_per_thread)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_buffers.clear();
+        m_zones_per_thread = zones_per_thread > 0 ? zones_per_thread : 1;
+        m_capture_begin = ProfileNow();
+        m_capture_end = m_capture_begin;
+
+        m_capture.store(++g_last_capture, std::memory_order_release);
+        m_capturing.store(true, std::memory_order_release);
+    }
+
+    HOOHAHA_LOG_INFO("Profiler capture started, {} zones per thread",
+                     zones_per_thread);
+}
+
+void Profiler::Stop()
+{
+    std::size_t zones = 0;
+    std::uint64_t dropped = 0;
+    std::size_t threads = 0;
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if (!m_capturing.exchange(false, std::memory_order_acq_rel))
+        {
+            return;
+        }
+
+        m_capture_end = ProfileNow();
+
+        for (const auto& buffer : m_buffers)
+        {
+            zones += buffer->count.load(std::memory_order_acquire);
+            dropped += buffer->dropped.load(std::memory_order_relaxed);
+        }
+
+        threads = m_buffers.size();
+    }
+
+    HOOHAHA_LOG_INFO("Profiler capture stopped, {} zones on {} threads, "
+                     "{} dropped", zones, threads, dropped);
+}
+
+bool Profiler::ExportChromeTrace(std::string_view path) const
+{
+    std::vector<std::shared_ptr<ProfileThreadBuffer>> buffers;
+    std::int64_t capture_begin;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        buffers = m_buffers;
+        capture_begin = m_capture_begin;
+    }
+
+    auto file = std::fopen(std::string(path).c_str(), "wb");
+    if (file == nullptr)
+    {
+        HOOHAHA_LOG_ERROR("Unable to write profiler capture to {}", path);
+        return false;
+    }
+
+    std::string output = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    auto out = std::back_inserter(output);
+    bool first = true;
+
+    const auto flush = [&output, file](bool force)
+    {
+        if (force || output.size() >= kExportBufferSize)
+        {
+            std::fwrite(output.data(), 1, output.size(), file);
+            output.clear();
+        }
+    };
+
+    for (const auto& buffer : buffers)
+    {
+        auto name = GetThreadName(buffer->thread_id);
+        if (name.empty())
+        {
+            name = std::format("thread {}", buffer->thread_id);
+        }
+
+        std::format_to(out, "{}{{\"ph\":\"M\",\"name\":\"thread_name\","
+                            "\"pid\":1,\"tid\":{},\"args\":{{\"name\":",
+                       first ? "" : ",", buffer->thread_id);
+        AppendJsonString(output, name);
+        output += "}}";
+        first = false;
+
+        const auto count = buffer->count.load(std::memory_order_acquire);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const auto& zone = buffer->zones[i];
+            const auto begin = ClockTicksToNanoseconds(zone.begin - capture_begin);
+            const auto duration = ClockTicksToNanoseconds(zone.end - zone.begin);
+
+            // microseconds with nanosecond precision
+            std::format_to(out, ",\n{{\"ph\":\"X\",\"pid\":1,\"tid\":{},"
+                                "\"ts\":{:.3f},\"dur\":{:.3f},\"name\":",
+                           buffer->thread_id, begin / 1000.0, duration / 1000.0);
+            AppendJsonString(output, zone.name);
+            output += '}';
+
+            flush(false);
+        }
+    }
+
+    output += "]}\n";
+    flush(true);
+
+    const bool result = std::ferror(file) == 0;
+    std::fclose(file);
+
+    if (!result)
+    {
+        HOOHAHA_LOG_ERROR("Unable to write profiler capture to {}", path);
+        return false;
+    }
+
+    HOOHAHA_LOG_INFO("Profiler capture written to {}", path);
+    return true;
+}
+
+void Profiler::AddZone(const char* name, std::uint64_t capture,
+                       std::int64_t begin, std::int64_t end)
+{
+    auto& buffer = GetThreadBuffer();
+
+    // a scope that began in an earlier capture would start before this one
+    if (t_thread_buffer.capture != capture)
+    {
+        return;
+    }
+
+    const auto index = buffer.count.load(std::memory_order_relaxed);
+    if (index == buffer.zone_capacity)
+    {
+        buffer.dropped.store(buffer.dropped.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_relaxed);
+        return;
+    }
+
+    buffer.zones[index] = { name, begin, end };
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+ProfileThreadBuffer& Profiler::GetThreadBuffer()
+{
+    auto& thread_buffer = t_thread_buffer;
+
+    const auto capture = m_capture.load(std::memory_order_acquire);
+    if (thread_buffer.capture == capture && thread_buffer.buffer)
+    {
+        return *thread_buffer.buffer;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    thread_buffer.buffer = std::make_shared<ProfileThreadBuffer>(
+        CurrentThreadId(), m_zones_per_thread);
+    thread_buffer.capture = m_capture.load(std::memory_order_relaxed);
+
+    m_buffers.push_back(thread_buffer.buffer);
+
+    return *thread_buffer.buffer;
+}
+
+}
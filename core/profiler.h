@@ -0,0 +1,169 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOOHAHA_CORE_PROFILER_H_
+#define HOOHAHA_CORE_PROFILER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "clock.h"
+
+namespace core
+{
+
+struct ProfileThreadBuffer;
+
+// Collects HOOHAHA_PROFILE_SCOPE zones between Start and Stop. Every thread
+// writes its zones into a buffer of its own without taking a lock, the
+// buffers are only merged when the capture is exported.
+class Profiler final
+{
+public:
+    Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler(Profiler&&) = delete;
+    ~Profiler();
+
+    // Zones beyond zones_per_thread are dropped and counted
+    void Start(std::size_t zones_per_thread = 64 * 1024);
+    void Stop();
+
+    inline bool IsCapturing() const;
+    // id of the running capture, zero when there is none
+    inline std::uint64_t GetCapture() const;
+
+    // Writes the last capture in the Chrome Trace Event format, it can be
+    // opened in Perfetto or chrome://tracing
+    bool ExportChromeTrace(std::string_view path) const;
+
+    // called by ProfileScope, zones of another capture are dropped
+    void AddZone(const char* name, std::uint64_t capture, std::int64_t begin,
+                 std::int64_t end);
+
+    Profiler& operator=(const Profiler&) = delete;
+    Profiler& operator=(Profiler&&) = delete;
+
+private:
+    ProfileThreadBuffer& GetThreadBuffer();
+
+private:
+    std::atomic<bool>           m_capturing;
+    // bumped by every Start, tells threads their buffer is stale
+    std::atomic<std::uint64_t>  m_capture;
+    std::size_t                 m_zones_per_thread;
+    std::int64_t                m_capture_begin;
+    std::int64_t                m_capture_end;
+
+    mutable std::mutex          m_mutex;
+    std::vector<std::shared_ptr<ProfileThreadBuffer>> m_buffers;
+};
+
+extern Profiler profiler;
+
+inline bool Profiler::IsCapturing() const
+{
+    return m_capturing.load(std::memory_order_relaxed);
+}
+
+inline std::uint64_t Profiler::GetCapture() const
+{
+    // Start sets the id before it sets m_capturing
+    return m_capturing.load(std::memory_order_acquire)
+               ? m_capture.load(std::memory_order_relaxed)
+               : 0;
+}
+
+// Zone timestamps, raw clock ticks converted when the capture is exported
+inline std::int64_t ProfileNow()
+{
+    return static_cast<std::int64_t>(ReadClockTicks());
+}
+
+// Measures the enclosing scope while a capture is running, see
+// HOOHAHA_PROFILE_SCOPE
+class ProfileScope final
+{
+public:
+    inline explicit ProfileScope(const char* name);
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope(ProfileScope&&) = delete;
+    inline ~ProfileScope();
+
+    ProfileScope& operator=(const ProfileScope&) = delete;
+    ProfileScope& operator=(ProfileScope&&) = delete;
+
+private:
+    const char*    m_name;
+    // the capture running on entry, zero when there was none
+    std::uint64_t  m_capture;
+    std::int64_t   m_begin;
+};
+
+inline ProfileScope::ProfileScope(const char* name)
+    : m_name(name)
+    , m_capture(profiler.GetCapture())
+    , m_begin(0)
+{
+    if (m_capture != 0)
+    {
+        m_begin = ProfileNow();
+    }
+}
+
+inline ProfileScope::~ProfileScope()
+{
+    if (m_capture != 0)
+    {
+        profiler.AddZone(m_name, m_capture, m_begin, ProfileNow());
+    }
+}
+
+}
+
+// Define it to 0 project wide to compile all zones out
+#ifndef HOOHAHA_PROFILE_ENABLED
+#define HOOHAHA_PROFILE_ENABLED 1
+#endif
+
+#define HOOHAHA_PROFILE_CONCAT_IMPL(a, b) a##b
+#define HOOHAHA_PROFILE_CONCAT(a, b) HOOHAHA_PROFILE_CONCAT_IMPL(a, b)
+
+#if HOOHAHA_PROFILE_ENABLED
+
+// Profiles the rest of the enclosing scope, name must be a string literal
+#define HOOHAHA_PROFILE_SCOPE(name)                                                \
+    core::ProfileScope HOOHAHA_PROFILE_CONCAT(hoohaha_profile_scope_, __LINE__)(   \
+        name)                                                                      \
+
+#else
+
+#define HOOHAHA_PROFILE_SCOPE(name)                                                \
+    do                                                                             \
+    {                                                                              \
+    }                                                                              \
+    while (false)                                                                  \
+
+#endif
+
+#endif // HOOHAHA_CORE_PROFILER_H_
@@ -0,0 +1,107 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "thread_registry.h"
+
+#include <atomic>
+#include <format>
+#include <mutex>
+#include <unordered_map>
+
+namespace core
+{
+
+namespace
+{
+
+struct ThreadState
+{
+    ThreadState();
+
+    std::uint32_t  id;
+    std::string    name;
+    std::string    tag;
+};
+
+struct ThreadNames
+{
+    std::mutex                                      mutex;
+    std::unordered_map<std::uint32_t, std::string> names;
+};
+
+std::atomic<std::uint32_t> g_last_thread_id(0);
+
+ThreadState::ThreadState()
+    : id(++g_last_thread_id)
+    , tag(std::format("{:04}", id))
+{
+}
+
+ThreadState& GetThreadState()
+{
+    thread_local ThreadState state;
+    return state;
+}
+
+ThreadNames& GetThreadNames()
+{
+    static ThreadNames names;
+    return names;
+}
+
+} // namespace
+
+std::uint32_t CurrentThreadId()
+{
+    return GetThreadState().id;
+}
+
+void SetCurrentThreadName(std::string_view name)
+{
+    auto& state = GetThreadState();
+
+    state.name = name;
+    state.tag = name.empty() ? std::format("{:04}", state.id)
+                             : std::format("{:04} {}", state.id, name);
+
+    auto& names = GetThreadNames();
+    std::unique_lock<std::mutex> lock(names.mutex);
+
+    names.names[state.id] = state.name;
+}
+
+std::string_view CurrentThreadName()
+{
+    return GetThreadState().name;
+}
+
+std::string GetThreadName(std::uint32_t id)
+{
+    auto& names = GetThreadNames();
+    std::unique_lock<std::mutex> lock(names.mutex);
+
+    const auto it = names.names.find(id);
+    return it != names.names.end() ? it->second : std::string();
+}
+
+std::string_view CurrentThreadTag()
+{
+    return GetThreadState().tag;
+}
+
+}
@@ -0,0 +1,47 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOOHAHA_CORE_THREAD_REGISTRY_H_
+#define HOOHAHA_CORE_THREAD_REGISTRY_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace core
+{
+
+// Compact, sequential id of the calling thread. The first thread that asks
+// gets 1, ids are never reused.
+std::uint32_t CurrentThreadId();
+
+// Names the calling thread, e.g. "render" or "worker-3". Names show up in
+// log records and profiler captures.
+void SetCurrentThreadName(std::string_view name);
+std::string_view CurrentThreadName();
+
+// Name of any thread that has ever set one, empty otherwise
+std::string GetThreadName(std::uint32_t id);
+
+// How the calling thread is printed in log records: the zero padded id
+// followed by the name, e.g. "0003 render". Built once per name change.
+std::string_view CurrentThreadTag();
+
+}
+
+#endif // HOOHAHA_CORE_THREAD_REGISTRY_H_
@@ -0,0 +1,268 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "timestamp.h"
+
+#include <cstring>
+#include <ctime>
+
+namespace core
+{
+
+namespace
+{
+
+// "2025-01-01T12:00:00." + up to six fraction digits + "+0100"
+const std::size_t kDateTimeLength = 20;
+const std::size_t kMaxFractionLength = 6;
+const std::size_t kMaxTimezoneLength = 5;
+
+struct TimestampCache
+{
+    // no second matches it, so the first call formats the date
+    long long           second = -1;
+    TimestampPrecision  precision = TimestampPrecision::kMilliseconds;
+    std::size_t         fraction_length = 0;
+    std::size_t         timezone_length = 0;
+    std::size_t         length = 0;
+    char                timezone[kMaxTimezoneLength + 1] = {};
+    char                buffer[kDateTimeLength + kMaxFractionLength +
+                               kMaxTimezoneLength + 1] = {};
+};
+
+thread_local TimestampCache t_cache;
+
+inline void LocalTime(std::time_t time, std::tm& out)
+{
+#ifdef _WIN32
+    localtime_s(&out, &time);
+#else
+    localtime_r(&time, &out);
+#endif
+}
+
+inline void WriteDigits(char* out, std::size_t count, long long value)
+{
+    for (std::size_t i = count; i > 0; --i)
+    {
+        out[i - 1] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+void RebuildCache(TimestampCache& cache, long long second,
+                  TimestampPrecision precision)
+{
+    std::tm local_time;
+    LocalTime(static_cast<std::time_t>(second), local_time);
+
+    std::strftime(cache.buffer, kDateTimeLength + 1, "%FT%T.", &local_time);
+
+    cache.timezone_length =
+        std::strftime(cache.timezone, sizeof(cache.timezone), "%z", &local_time);
+    cache.fraction_length =
+        precision == TimestampPrecision::kMicroseconds ? 6 : 3;
+
+    std::memcpy(cache.buffer + kDateTimeLength + cache.fraction_length,
+                cache.timezone, cache.timezone_length);
+
+    cache.length =
+        kDateTimeLength + cache.fraction_length + cache.timezone_length;
+    cache.buffer[cache.length] = '\0';
+    cache.second = second;
+    cache.precision = precision;
+}
+
+// Reads count digits, returns false if there are not that many
+inline bool ReadDigits(std::string_view& text, std::size_t count, int& value)
+{
+    if (text.size() < count)
+    {
+        return false;
+    }
+
+    value = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (text[i] < '0' || text[i] > '9')
+        {
+            return false;
+        }
+        value = value * 10 + (text[i] - '0');
+    }
+
+    text.remove_prefix(count);
+    return true;
+}
+
+inline bool ReadCharacter(std::string_view& text, char c)
+{
+    if (text.empty() || text.front() != c)
+    {
+        return false;
+    }
+
+    text.remove_prefix(1);
+    return true;
+}
+
+// Days since 1970-01-01 of a date in the proleptic Gregorian calendar
+long long DaysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2;
+    const long long era = (year >= 0 ? year : year - 399) / 400;
+    const long long year_of_era = year - era * 400;
+    const long long day_of_year =
+        (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const long long day_of_era =
+        year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+} // namespace
+
+std::string_view FormatTimestamp(std::chrono::system_clock::time_point time,
+                                 TimestampPrecision precision)
+{
+    using namespace std::chrono;
+
+    const auto duration = time.time_since_epoch();
+    const auto second = floor<seconds>(duration);
+    const auto microsecond = duration_cast<microseconds>(duration - second);
+
+    auto& cache = t_cache;
+    if (cache.second != second.count() || cache.precision != precision)
+    {
+        RebuildCache(cache, second.count(), precision);
+    }
+
+    const long long fraction = precision == TimestampPrecision::kMicroseconds
+        ? microsecond.count()
+        : microsecond.count() / 1000;
+
+    WriteDigits(cache.buffer + kDateTimeLength, cache.fraction_length, fraction);
+
+    return { cache.buffer, cache.length };
+}
+
+bool ParseTimestamp(std::string_view text, std::int64_t& nanoseconds)
+{
+    int year, month, day, hour = 0, minute = 0, second = 0;
+
+    if (!ReadDigits(text, 4, year) || !ReadCharacter(text, '-') ||
+        !ReadDigits(text, 2, month) || !ReadCharacter(text, '-') ||
+        !ReadDigits(text, 2, day))
+    {
+        return false;
+    }
+
+    // a date alone is its local midnight
+    if (!text.empty() &&
+        (!(ReadCharacter(text, 'T') || ReadCharacter(text, ' ')) ||
+         !ReadDigits(text, 2, hour) || !ReadCharacter(text, ':') ||
+         !ReadDigits(text, 2, minute)))
+    {
+        return false;
+    }
+
+    if (ReadCharacter(text, ':') && !ReadDigits(text, 2, second))
+    {
+        return false;
+    }
+
+    long long fraction = 0;
+    if (ReadCharacter(text, '.'))
+    {
+        int digits = 0;
+        while (!text.empty() && text.front() >= '0' && text.front() <= '9')
+        {
+            if (digits < 9)
+            {
+                fraction = fraction * 10 + (text.front() - '0');
+                digits++;
+            }
+            text.remove_prefix(1);
+        }
+
+        for (; digits < 9; digits++)
+        {
+            fraction *= 10;
+        }
+    }
+
+    long long seconds;
+
+    if (text.empty())
+    {
+        // no offset, local time
+        std::tm local_time = {};
+        local_time.tm_year = year - 1900;
+        local_time.tm_mon = month - 1;
+        local_time.tm_mday = day;
+        local_time.tm_hour = hour;
+        local_time.tm_min = minute;
+        local_time.tm_sec = second;
+        local_time.tm_isdst = -1;
+
+        const auto time = std::mktime(&local_time);
+        if (time == static_cast<std::time_t>(-1))
+        {
+            return false;
+        }
+        seconds = static_cast<long long>(time);
+    }
+    else
+    {
+        int offset = 0;
+        if (!ReadCharacter(text, 'Z'))
+        {
+            const bool negative = text.front() == '-';
+            int offset_hours, offset_minutes;
+
+            if (!(ReadCharacter(text, '+') || ReadCharacter(text, '-')) ||
+                !ReadDigits(text, 2, offset_hours))
+            {
+                return false;
+            }
+            ReadCharacter(text, ':');
+            if (!ReadDigits(text, 2, offset_minutes))
+            {
+                return false;
+            }
+
+            offset = (offset_hours * 60 + offset_minutes) * 60;
+            if (negative)
+            {
+                offset = -offset;
+            }
+        }
+
+        if (!text.empty())
+        {
+            return false;
+        }
+
+        seconds = DaysFromCivil(year, month, day) * 86400 +
+                  hour * 3600 + minute * 60 + second - offset;
+    }
+
+    nanoseconds = static_cast<std::int64_t>(seconds * 1000000000 + fraction);
+    return true;
+}
+
+}
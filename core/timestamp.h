@@ -0,0 +1,54 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef HOOHAHA_CORE_TIMESTAMP_H_
+#define HOOHAHA_CORE_TIMESTAMP_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+namespace core
+{
+
+enum class TimestampPrecision
+{
+    kMilliseconds,
+    kMicroseconds
+};
+
+// Formats the time as local ISO 8601 with a fractional part and a timezone
+// offset, e.g. 2025-01-01T12:00:00.123+0100.
+//
+// The date, time and timezone part is cached per thread and rebuilt only when
+// the second changes, any other call just patches the fraction digits. The
+// returned view points into a thread-local buffer and stays valid until the
+// next call on the same thread. Never allocates.
+std::string_view FormatTimestamp(
+    std::chrono::system_clock::time_point time,
+    TimestampPrecision precision = TimestampPrecision::kMilliseconds);
+
+// Reads a timestamp written by FormatTimestamp back as nanoseconds since
+// the epoch. The time of day, seconds, the fraction and the timezone offset
+// are optional, e.g. 2025-01-01T12:00 is local time. The offset may also be
+// Z or +01:00.
+bool ParseTimestamp(std::string_view text, std::int64_t& nanoseconds);
+
+}
+
+#endif // HOOHAHA_CORE_TIMESTAMP_H_
@@ -0,0 +1,156 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Checks core::Arena: alignment, allocations that do not overlap or leave
+// their chunk, and chunk reuse after Reset. Exits with 1 on the first
+// failure; run it under AddressSanitizer to catch writes past a chunk.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory_resource>
+#include <vector>
+
+#include "core/arena.h"
+
+namespace
+{
+
+// the smallest chunk the arena makes, so rounds cross many chunk ends
+constexpr std::size_t kArenaTestChunkSize = 4096;
+
+struct Allocation
+{
+    unsigned char*  data;
+    std::size_t     size;
+    unsigned char   pattern;
+};
+
+bool g_failed = false;
+
+void Check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        g_failed = true;
+    }
+}
+
+Allocation Allocate(core::Arena& arena, std::size_t size, std::size_t alignment,
+                    unsigned char pattern)
+{
+    auto data = static_cast<unsigned char*>(arena.allocate(size, alignment));
+    Check(reinterpret_cast<std::uintptr_t>(data) % alignment == 0, "alignment");
+
+    // every byte is written, an allocation outside its chunk shows up here
+    // under AddressSanitizer and as a broken pattern otherwise
+    std::memset(data, pattern, size);
+    return { data, size, pattern };
+}
+
+void CheckPatterns(const std::vector<Allocation>& allocations)
+{
+    for (const auto& allocation : allocations)
+    {
+        for (std::size_t i = 0; i < allocation.size; i++)
+        {
+            if (allocation.data[i] != allocation.pattern)
+            {
+                Check(false, "allocations overlap");
+                return;
+            }
+        }
+    }
+}
+
+void TestMixedAlignment(core::Arena& arena)
+{
+    const std::size_t alignments[] = { 1, 2, 4, 8, 16, alignof(std::max_align_t) };
+
+    std::vector<Allocation> allocations;
+    unsigned char pattern = 1;
+
+    for (std::size_t i = 0; i < 2000; i++)
+    {
+        const auto alignment = alignments[i % std::size(alignments)];
+        // odd byte sizes followed by aligned ones, now and then larger than
+        // a chunk
+        std::size_t size = alignment == 1 ? 1 + (i * 7) % 61 : alignment * (1 + i % 5);
+        if (i % 397 == 0)
+        {
+            size = 3 * kArenaTestChunkSize + i % 3;
+        }
+
+        allocations.push_back(Allocate(arena, size, alignment, pattern++));
+    }
+
+    CheckPatterns(allocations);
+}
+
+void TestLargeThenAligned(core::Arena& arena)
+{
+    // a source copied into its own chunk, then the nodes that follow it
+    std::vector<Allocation> allocations;
+    allocations.push_back(Allocate(arena, 300002, 1, 0x11));
+    allocations.push_back(Allocate(arena, 64, 8, 0x22));
+    allocations.push_back(Allocate(arena, 5, 1, 0x33));
+    allocations.push_back(Allocate(arena, 64, alignof(std::max_align_t), 0x44));
+
+    CheckPatterns(allocations);
+}
+
+} // namespace
+
+int main()
+{
+    core::Arena arena(kArenaTestChunkSize);
+
+    TestLargeThenAligned(arena);
+    TestMixedAlignment(arena);
+
+    // the same rounds again on recycled chunks
+    const auto capacity = arena.GetCapacity();
+    arena.Reset();
+    Check(arena.GetUsedSize() == 0, "used size after Reset");
+
+    TestLargeThenAligned(arena);
+    TestMixedAlignment(arena);
+    Check(arena.GetCapacity() == capacity, "chunks reused after Reset");
+
+    {
+        std::pmr::vector<int> values(&arena);
+        for (int i = 0; i < 10000; i++)
+        {
+            values.push_back(i);
+        }
+        Check(values[9999] == 9999, "std::pmr container");
+    }
+
+    arena.Release();
+    Check(arena.GetCapacity() == 0, "capacity after Release");
+
+    if (g_failed)
+    {
+        return 1;
+    }
+
+    std::printf("arena_test passed\n");
+    return 0;
+}
@@ -0,0 +1,227 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Compiles a KeyValues document with BinaryKeyValues::Compile, maps the
+// result with MappedKeyValues and checks that every node reads back like
+// the parsed text. Exits with 1 on the first failure.
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include "core/key_values.h"
+#include "core/key_values_binary.h"
+
+namespace
+{
+
+// every value type, escapes, comments, empty and nested sets
+constexpr std::string_view kDocument = R"(root
+{
+    // a comment
+    name = "hello world"
+    plain = abc
+    escaped = "say \"hi\""
+    count = 42
+    negative = -7
+    scale = 2.5
+    ints = 1, -2, 3, 2147483647
+    floats = 1.5, -0.25, 1e10
+    strings = a, "b c", d
+    empty
+    {
+    }
+    nested
+    {
+        deep = "x"   // trailing comment
+        deeper
+        {
+            value = 9
+            names = first, second
+        }
+    }
+    entity_1 { health = 100 origin = 1.0, 2.0, 3.0 }
+    entity_2 { health = 50 origin = -1.0, 0.0, 4.5 }
+})";
+
+bool g_failed = false;
+
+void Check(bool condition, const char* what, std::string_view key = {})
+{
+    if (!condition)
+    {
+        std::fprintf(stderr, "FAILED: %s %.*s\n", what,
+                     static_cast<int>(key.size()), key.data());
+        g_failed = true;
+    }
+}
+
+// Values of a node are read through its own "/" key, a node that holds
+// another type returns the default or an empty array.
+void CompareNodes(const core::KeyValues& text,
+                  const core::BinaryKeyValues& binary)
+{
+    const auto key = text.GetKeyView();
+    Check(binary.GetKeyView() == key, "key", key);
+    Check(binary.GetKey() == text.GetKey(), "key copy", key);
+
+    Check(binary.GetStringView("/", "(none)") ==
+              text.GetStringView("/", "(none)"),
+          "string", key);
+    Check(binary.GetString("/", "(none)") == text.GetString("/", "(none)"),
+          "string copy", key);
+    Check(binary.GetInt("/", -12345) == text.GetInt("/", -12345), "int",
+          key);
+    Check(binary.GetFloat("/", -1.5f) == text.GetFloat("/", -1.5f), "float",
+          key);
+
+    Check(binary.GetStringArray("/") == text.GetStringArray("/"),
+          "string array", key);
+    Check(binary.GetIntArray("/") == text.GetIntArray("/"), "int array",
+          key);
+    Check(binary.GetFloatArray("/") == text.GetFloatArray("/"),
+          "float array", key);
+    Check(binary.GetStringArraySize("/") == text.GetStringArraySize("/"),
+          "string array size", key);
+    Check(binary.GetIntArraySize("/") == text.GetIntArraySize("/"),
+          "int array size", key);
+    Check(binary.GetFloatArraySize("/") == text.GetFloatArraySize("/"),
+          "float array size", key);
+
+    // children are sorted by key in the binary form, the text keeps them
+    // in a hash set
+    std::size_t text_children = 0;
+    for (const auto& text_child : text)
+    {
+        text_children++;
+
+        const core::BinaryKeyValues* binary_child = nullptr;
+        for (const auto& candidate : binary)
+        {
+            if (candidate.GetKeyView() == text_child.GetKeyView())
+            {
+                binary_child = &candidate;
+                break;
+            }
+        }
+
+        Check(binary_child != nullptr, "missing child",
+              text_child.GetKeyView());
+        if (binary_child != nullptr)
+        {
+            CompareNodes(text_child, *binary_child);
+        }
+    }
+
+    std::size_t binary_children = 0;
+    for (const auto& binary_child : binary)
+    {
+        static_cast<void>(binary_child);
+        binary_children++;
+    }
+    Check(binary_children == text_children, "child count", key);
+}
+
+void ComparePaths(const core::KeyValues& text,
+                  const core::BinaryKeyValues& binary)
+{
+    static constexpr core::KeyValues::Path kValue("/nested/deeper/value");
+    static constexpr core::KeyValues::Path kOrigin("/entity_2/origin");
+    static constexpr core::KeyValues::Path kMissing("/nested/missing");
+
+    Check(binary.GetInt(kValue, 0) == 9, "path int");
+    Check(binary.GetInt(kValue, 0) == text.GetInt(kValue, 0), "path int");
+    Check(binary.GetFloatArray(kOrigin) == text.GetFloatArray(kOrigin),
+          "path float array");
+    Check(binary.GetString(kMissing, "default") == "default",
+          "missing path");
+    Check(binary.GetString("/nested/deeper/names", "") ==
+              text.GetString("/nested/deeper/names", ""),
+          "string key of an array");
+    Check(binary.GetStringArray("/nested/deeper/names") ==
+              text.GetStringArray("/nested/deeper/names"),
+          "string key path");
+    Check(binary.FindKeyValues("/entity_1") != nullptr &&
+              binary.FindKeyValues("/entity_1")->GetInt("/health", 0) == 100,
+          "FindKeyValues");
+    Check(binary.FindKeyValues("/entity_3") == nullptr,
+          "FindKeyValues of a missing key");
+}
+
+} // namespace
+
+int main()
+{
+    core::KeyValues text;
+    Check(text.LoadFromString(kDocument), "parse");
+
+    std::string compiled;
+    Check(core::BinaryKeyValues::Compile(text, compiled), "compile");
+
+    const auto path = std::filesystem::temp_directory_path() /
+                      "key_values_binary_test.kvb";
+    {
+        std::ofstream output(path, std::ios::binary);
+        output.write(compiled.data(),
+                     static_cast<std::streamsize>(compiled.size()));
+        Check(output.good(), "write the compiled file");
+    }
+
+    {
+        core::MappedKeyValues mapped;
+        Check(mapped.Open(path.string()), "open");
+        Check(mapped.Verify(), "verify");
+
+        if (const auto root = mapped.GetRoot())
+        {
+            CompareNodes(text, *root);
+            ComparePaths(text, *root);
+        }
+        else
+        {
+            Check(false, "root");
+        }
+    }
+
+    // a compiled file cut short is refused
+    {
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        output.write(compiled.data(),
+                     static_cast<std::streamsize>(compiled.size() / 2));
+    }
+
+    {
+        core::MappedKeyValues mapped;
+        Check(!mapped.Open(path.string()) || !mapped.Verify(),
+              "truncated file");
+    }
+
+    std::error_code error;
+    std::filesystem::remove(path, error);
+
+    if (g_failed)
+    {
+        return 1;
+    }
+
+    std::printf("key_values_binary_test passed\n");
+    return 0;
+}
@@ -0,0 +1,237 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Writes the same records into a text log and a binary log, decodes the
+// binary one with LogBinaryDecoder and checks that every line matches the
+// text log apart from the timestamp. Exits with 1 on the first failure.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "core/log.h"
+#include "core/log_binary.h"
+#include "core/thread_registry.h"
+
+namespace
+{
+
+bool g_failed = false;
+
+void Check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        g_failed = true;
+    }
+}
+
+// one record per argument type the binary encoder knows
+void WriteRecords()
+{
+    const std::string owned = "owned";
+    const int value = 1;
+
+    HOOHAHA_LOG_INFO("integers {} {} {} {}", 42, -7,
+                     std::numeric_limits<std::uint64_t>::max(),
+                     std::numeric_limits<std::int64_t>::min());
+    HOOHAHA_LOG_WARN("floating point {} {:.3f} {}", 1.5, 2.0f / 3.0f, 1e300);
+    HOOHAHA_LOG_ERROR("strings [{}] [{}] [{}]", "literal", owned,
+                      std::string_view("view"));
+    HOOHAHA_LOG_INFO("bool {} char {} pointer {}", true, 'c',
+                     static_cast<const void*>(&value));
+    HOOHAHA_LOG_INFO("no arguments");
+    core::log.LogMessage(__FILE__, __LINE__, core::LogLevel::kInfo,
+                         "printf style %d %s", 3, "message");
+    HOOHAHA_LOG_FIELDS(kInfo, "fields", { "id", 7 }, { "name", "player" },
+                       { "ratio", 0.5 }, { "alive", true });
+
+    std::thread worker(
+        []
+        {
+            HOOHAHA_LOG_INFO("unnamed thread");
+            core::SetCurrentThreadName("worker");
+            HOOHAHA_LOG_INFO("named thread {}", 2);
+        });
+    worker.join();
+
+    // a call site hit again only writes a record
+    for (int i = 0; i < 3; i++)
+    {
+        HOOHAHA_LOG_INFO("repeated {}", i);
+    }
+}
+
+std::string ReadFile(const std::filesystem::path& path)
+{
+    std::ifstream input(path, std::ios::binary);
+    std::stringstream data;
+    data << input.rdbuf();
+    return data.str();
+}
+
+// The record lines of a text log without their timestamps, the header and
+// the footer carry the time they were written. Threads are numbered in the
+// order they first log, a new worker thread gets a new number every run.
+std::vector<std::string> GetRecords(std::string_view text)
+{
+    std::vector<std::string> records;
+    std::vector<std::string> threads;
+
+    while (!text.empty())
+    {
+        auto end = text.find('\n');
+        if (end == std::string_view::npos)
+        {
+            end = text.size() - 1;
+        }
+
+        auto line = text.substr(0, end + 1);
+        text.remove_prefix(end + 1);
+
+        // [timestamp][level][thread name]
+        const auto timestamp_end = line.find(']');
+        const auto level_end = line.find(']', timestamp_end + 1);
+        if (!line.starts_with('[') || level_end == std::string_view::npos ||
+            line.size() < level_end + 6)
+        {
+            continue;
+        }
+
+        const auto thread = std::string(line.substr(level_end + 2, 4));
+        auto index = std::find(threads.begin(), threads.end(), thread);
+        if (index == threads.end())
+        {
+            index = threads.insert(threads.end(), thread);
+        }
+
+        auto record = std::string(
+            line.substr(timestamp_end + 1, level_end - timestamp_end + 1));
+        record += std::to_string(index - threads.begin());
+        record += line.substr(level_end + 6);
+        records.push_back(std::move(record));
+    }
+
+    return records;
+}
+
+std::string WriteLog(const std::filesystem::path& path, core::LogFormat format)
+{
+    core::LogSettings settings;
+    settings.format = format;
+
+    core::log.Initialize(path.string(), core::LogLevel::kInfo, settings);
+    Check(core::log.IsInitialized(), "initialize");
+    WriteRecords();
+    core::log.Shutdown();
+
+    return ReadFile(path);
+}
+
+} // namespace
+
+int main()
+{
+    core::SetCurrentThreadName("main");
+
+    const auto directory = std::filesystem::temp_directory_path();
+    const auto text_path = directory / "log_binary_test.log";
+    const auto binary_path = directory / "log_binary_test.hhlog";
+
+    const auto text = WriteLog(text_path, core::LogFormat::kText);
+    const auto binary = WriteLog(binary_path, core::LogFormat::kBinary);
+
+    std::string decoded;
+    core::LogBinaryDecoder decoder;
+    Check(decoder.Decode(binary,
+                         [&decoded](std::string_view line)
+                         {
+                             decoded += line;
+                         }),
+          "decode");
+
+    const auto expected = GetRecords(text);
+    const auto records = GetRecords(decoded);
+
+    Check(expected.size() == 12, "text record count");
+    Check(records.size() == expected.size(), "binary record count");
+    for (std::size_t i = 0; i < records.size() && i < expected.size(); i++)
+    {
+        if (records[i] != expected[i])
+        {
+            std::fprintf(stderr, "text   :%s", expected[i].c_str());
+            std::fprintf(stderr, "binary :%s", records[i].c_str());
+            Check(false, "record");
+        }
+    }
+
+    // std::format refuses a null C string, the binary log writes it empty
+    {
+        core::LogSettings settings;
+        settings.format = core::LogFormat::kBinary;
+        core::log.Initialize(binary_path.string(), core::LogLevel::kInfo,
+                             settings);
+        const char* null_string = nullptr;
+        HOOHAHA_LOG_INFO("null string [{}]", null_string);
+        core::log.Shutdown();
+
+        std::string null_decoded;
+        core::LogBinaryDecoder null_decoder;
+        null_decoder.Decode(ReadFile(binary_path),
+                            [&null_decoded](std::string_view line)
+                            {
+                                null_decoded += line;
+                            });
+        Check(null_decoded.find("null string []") != std::string::npos,
+              "null string");
+    }
+
+    // a stream cut in the middle of an entry decodes up to it
+    core::LogBinaryDecoder truncated_decoder;
+    std::size_t truncated_lines = 0;
+    truncated_decoder.Decode(
+        std::string_view(binary).substr(0, binary.size() / 2),
+        [&truncated_lines](std::string_view line)
+        {
+            static_cast<void>(line);
+            truncated_lines++;
+        });
+    Check(truncated_lines < records.size() + 2, "truncated stream");
+
+    std::error_code error;
+    std::filesystem::remove(text_path, error);
+    std::filesystem::remove(binary_path, error);
+
+    if (g_failed)
+    {
+        return 1;
+    }
+
+    std::printf("log_binary_test passed\n");
+    return 0;
+}
@@ -0,0 +1,297 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Round trips for the log compression: LZ4 style blocks of several kinds of
+// data, and the frames CompressedLogWriter writes, whole, cut short and
+// corrupted. Exits with 1 on the first failure; run it under
+// AddressSanitizer to catch reads past a corrupted block.
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/log_compression.h"
+
+namespace
+{
+
+bool g_failed = false;
+
+void Check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        g_failed = true;
+    }
+}
+
+// keeps what CompressedLogWriter passes on in memory
+class MemoryLogWriter final : public core::LogWriter
+{
+public:
+    MemoryLogWriter(std::string& data, std::string& preamble)
+        : m_data(data)
+        , m_preamble(preamble)
+    {
+    }
+
+    bool Open(std::string_view path) override
+    {
+        static_cast<void>(path);
+        return true;
+    }
+
+    void Close() override
+    {
+    }
+
+    bool Write(std::string_view data) override
+    {
+        m_data += data;
+        return true;
+    }
+
+    void Flush() override
+    {
+    }
+
+    void AddPreamble(std::string_view data) override
+    {
+        m_preamble += data;
+    }
+
+private:
+    std::string&  m_data;
+    std::string&  m_preamble;
+};
+
+std::uint32_t NextRandom(std::uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+std::string MakeLogText(std::size_t size)
+{
+    std::string text;
+    std::uint32_t state = 1;
+    for (int line = 0; text.size() < size; line++)
+    {
+        text += "[2025-01-01T12:00:00.000+0000][INFO ][0001] frame ";
+        text += std::to_string(line);
+        text += " took ";
+        text += std::to_string(NextRandom(state) % 1000);
+        text += " us : renderer.cpp(42)\r\n";
+    }
+    text.resize(size);
+    return text;
+}
+
+std::string MakeRandomBytes(std::size_t size)
+{
+    std::string bytes(size, '\0');
+    std::uint32_t state = 2463534242u;
+    for (auto& byte : bytes)
+    {
+        byte = static_cast<char>(NextRandom(state));
+    }
+    return bytes;
+}
+
+void CheckBlock(std::string_view input, const char* what)
+{
+    std::vector<std::uint32_t> hash_table;
+    std::string compressed;
+    core::CompressLogBlock(input, compressed, hash_table);
+
+    // decompressed bytes are appended after what is there already
+    std::string output = "prefix";
+    const bool decompressed =
+        core::DecompressLogBlock(compressed, input.size(), output);
+    Check(decompressed && output.substr(6) == input &&
+              output.starts_with("prefix"),
+          what);
+
+    // a block cut short never decodes
+    if (!compressed.empty())
+    {
+        const auto truncated =
+            std::string_view(compressed).substr(0, compressed.size() - 1);
+        output.clear();
+        Check(!core::DecompressLogBlock(truncated, input.size(), output),
+              what);
+    }
+}
+
+void TestBlocks()
+{
+    CheckBlock({}, "empty block");
+    CheckBlock("a", "one byte");
+    CheckBlock("short, no match", "short block");
+    CheckBlock(std::string(100000, 'x'), "one repeated byte");
+    CheckBlock(MakeLogText(1 << 20), "log text");
+    CheckBlock(MakeRandomBytes(65536), "random bytes");
+
+    // matches only reach 64KB back, the repeat here is further away
+    const auto random = MakeRandomBytes(70000);
+    CheckBlock(random + random, "repeat beyond the match window");
+
+    std::vector<std::uint32_t> hash_table;
+    std::string compressed;
+    const auto text = MakeLogText(1 << 16);
+    core::CompressLogBlock(text, compressed, hash_table);
+    Check(compressed.size() < text.size() / 2, "log text compresses");
+
+    // corrupted blocks must not read or write out of bounds
+    for (std::size_t i = 0; i < compressed.size(); i += 7)
+    {
+        auto corrupted = compressed;
+        corrupted[i] = static_cast<char>(corrupted[i] ^ 0x5a);
+
+        std::string output;
+        if (core::DecompressLogBlock(corrupted, text.size(), output))
+        {
+            Check(output.size() == text.size(), "corrupted block size");
+        }
+    }
+}
+
+// records of a log, some of them larger than a frame
+std::vector<std::string> MakeRecords()
+{
+    std::vector<std::string> records;
+    std::uint32_t state = 7;
+    for (int i = 0; i < 3000; i++)
+    {
+        std::string record = "record " + std::to_string(i) + " ";
+        if (i % 500 == 0)
+        {
+            record += MakeRandomBytes(10000);
+        }
+        else
+        {
+            record.append(NextRandom(state) % 200,
+                          static_cast<char>('a' + i % 26));
+        }
+        record += "\r\n";
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+std::string DecodeFrames(std::string_view data, std::size_t& decoded_size,
+                         bool& whole_records)
+{
+    std::string output;
+    whole_records = true;
+    decoded_size = core::DecodeLogFrames(
+        data,
+        [&output, &whole_records](std::string_view block)
+        {
+            whole_records = whole_records && block.ends_with("\r\n");
+            output += block;
+        });
+    return output;
+}
+
+void TestFrames()
+{
+    std::string file;
+    std::string preamble;
+
+    core::LogCompressionSettings settings;
+    settings.enabled = true;
+    settings.block_size = 4096;
+
+    core::CompressedLogWriter writer(
+        settings, std::make_unique<MemoryLogWriter>(file, preamble));
+    Check(writer.Open("memory"), "open");
+    writer.AddPreamble("preamble\r\n");
+
+    const auto records = MakeRecords();
+    std::string expected;
+    for (std::size_t i = 0; i < records.size(); i++)
+    {
+        Check(writer.Write(records[i]), "write");
+        expected += records[i];
+
+        // a partial frame
+        if (i == 1234)
+        {
+            writer.Flush();
+        }
+    }
+    writer.Close();
+
+    Check(core::IsCompressedLog(file), "frame magic");
+    Check(file.size() < expected.size(), "frames compress");
+
+    std::size_t decoded_size;
+    bool whole_records;
+    Check(DecodeFrames(file, decoded_size, whole_records) == expected,
+          "frames round trip");
+    Check(decoded_size == file.size(), "every frame decoded");
+    Check(whole_records, "records are not split between frames");
+
+    Check(DecodeFrames(preamble, decoded_size, whole_records) ==
+              "preamble\r\n",
+          "preamble frame");
+
+    // a file cut short decodes up to its last complete frame
+    const std::size_t cut_sizes[] = { file.size() - 1, file.size() / 2, 5 };
+    for (const auto size : cut_sizes)
+    {
+        const auto output =
+            DecodeFrames(std::string_view(file).substr(0, size), decoded_size,
+                         whole_records);
+        Check(decoded_size <= size && expected.starts_with(output) &&
+                  whole_records,
+              "truncated frames");
+    }
+
+    // a corrupted frame ends the stream before it
+    auto corrupted = file;
+    auto& byte = corrupted[file.size() / 2];
+    byte = static_cast<char>(byte ^ 1);
+    const auto output = DecodeFrames(corrupted, decoded_size, whole_records);
+    Check(decoded_size <= file.size() / 2 && expected.starts_with(output),
+          "corrupted frame");
+}
+
+} // namespace
+
+int main()
+{
+    TestBlocks();
+    TestFrames();
+
+    if (g_failed)
+    {
+        return 1;
+    }
+
+    std::printf("log_compression_test passed\n");
+    return 0;
+}
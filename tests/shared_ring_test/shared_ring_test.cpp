@@ -0,0 +1,346 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Runs a SharedRingLogWriter in a child process and reads its ring from
+// this one. Checks that records arrive whole and in order while the reader
+// keeps up, and that a ring nobody reads keeps the records that fit and
+// counts the rest as dropped. Exits with 1 on the first failure.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "core/log_shared_ring.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+bool g_failed = false;
+
+void Check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        g_failed = true;
+    }
+}
+
+// "record <index> <payload>\r\n", the payload length and letter follow
+// from the index so a torn record shows up
+std::string MakeRecord(int index)
+{
+    std::string record = "record " + std::to_string(index) + " ";
+    record.append(index % 97, static_cast<char>('a' + index % 26));
+    record += "\r\n";
+    return record;
+}
+
+// the writer side, run in the child process
+int WriteRecords(const char* name, std::size_t capacity, int count)
+{
+    core::SharedRingLogSettings settings;
+    settings.capacity = capacity;
+
+    core::SharedRingLogWriter writer(settings);
+    if (!writer.Open(name))
+    {
+        return 1;
+    }
+
+    for (int index = 0; index < count; index++)
+    {
+        // a full ring drops the record, the reader counts it
+        writer.Write(MakeRecord(index));
+    }
+
+    writer.Close();
+    return 0;
+}
+
+#ifdef _WIN32
+
+using Process = HANDLE;
+
+// the child is this executable again, see main
+bool StartWriter(const char* name, std::size_t capacity, int count,
+                 Process& process)
+{
+    char path[MAX_PATH];
+    GetModuleFileNameA(nullptr, path, MAX_PATH);
+
+    auto command_line = std::string("\"") + path + "\" writer " + name + " " +
+                        std::to_string(capacity) + " " + std::to_string(count);
+
+    STARTUPINFOA startup_info = {};
+    startup_info.cb = sizeof(startup_info);
+    PROCESS_INFORMATION process_info = {};
+
+    if (!CreateProcessA(nullptr, command_line.data(), nullptr, nullptr, FALSE,
+                        0, nullptr, nullptr, &startup_info, &process_info))
+    {
+        return false;
+    }
+
+    CloseHandle(process_info.hThread);
+    process = process_info.hProcess;
+    return true;
+}
+
+// false while the child runs, exit_code is set once it has exited
+bool HasExited(Process process, int& exit_code)
+{
+    DWORD code;
+    if (WaitForSingleObject(process, 0) != WAIT_OBJECT_0 ||
+        !GetExitCodeProcess(process, &code))
+    {
+        return false;
+    }
+
+    CloseHandle(process);
+    exit_code = static_cast<int>(code);
+    return true;
+}
+
+std::string GetRingName()
+{
+    return "/hoohaha-shared-ring-test-" +
+           std::to_string(GetCurrentProcessId());
+}
+
+#else
+
+using Process = pid_t;
+
+bool StartWriter(const char* name, std::size_t capacity, int count,
+                 Process& process)
+{
+    process = fork();
+    if (process == 0)
+    {
+        _exit(WriteRecords(name, capacity, count));
+    }
+
+    return process > 0;
+}
+
+bool HasExited(Process process, int& exit_code)
+{
+    int status;
+    if (waitpid(process, &status, WNOHANG) != process)
+    {
+        return false;
+    }
+
+    exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+    return true;
+}
+
+std::string GetRingName()
+{
+    return "/hoohaha-shared-ring-test-" + std::to_string(getpid());
+}
+
+#endif
+
+// Creates the ring and attaches the reader before the child writes, so
+// the ring outlives the child.
+bool CreateRing(const std::string& name, std::size_t capacity,
+                core::SharedRingLogReader& reader)
+{
+    core::SharedRingLogReader::Remove(name);
+
+    core::SharedRingLogSettings settings;
+    settings.capacity = capacity;
+
+    core::SharedRingLogWriter creator(settings);
+    const bool created = creator.Open(name) && reader.Open(name);
+    creator.Close();
+    return created;
+}
+
+// Checks the records in data, which must be whole, and returns how many
+// there were. next_index is the index the first one may have at least.
+int CheckRecords(std::string_view data, int& next_index)
+{
+    int count = 0;
+
+    while (!data.empty())
+    {
+        const auto end = data.find("\r\n");
+        if (end == std::string_view::npos)
+        {
+            Check(false, "a record was cut");
+            break;
+        }
+
+        const auto record = data.substr(0, end + 2);
+        data.remove_prefix(end + 2);
+
+        int index = -1;
+        if (std::sscanf(std::string(record).c_str(), "record %d", &index) !=
+                1 ||
+            index < next_index || record != MakeRecord(index))
+        {
+            Check(false, "record torn or out of order");
+            break;
+        }
+
+        next_index = index + 1;
+        count++;
+    }
+
+    return count;
+}
+
+void TestConcurrentReader()
+{
+    constexpr std::size_t kCapacity = 64 * 1024;
+    constexpr int kRecordCount = 20000;
+
+    const auto name = GetRingName();
+    core::SharedRingLogReader reader;
+    Process process;
+
+    if (!CreateRing(name, kCapacity, reader) ||
+        !StartWriter(name.c_str(), kCapacity, kRecordCount, process))
+    {
+        Check(false, "start the writer");
+        return;
+    }
+
+    int received = 0;
+    int next_index = 0;
+    int exit_code = 0;
+    bool exited = false;
+    std::string data;
+
+    // the last read after the child exited picks up what is left
+    for (;;)
+    {
+        const bool last_read = exited;
+
+        data.clear();
+        reader.Read(data);
+        received += CheckRecords(data, next_index);
+
+        if (last_read)
+        {
+            break;
+        }
+
+        exited = HasExited(process, exit_code);
+        if (data.empty() && !exited)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    Check(exit_code == 0, "writer exit code");
+    Check(received > 0, "records received");
+    Check(received + static_cast<int>(reader.GetDroppedRecordCount()) ==
+              kRecordCount,
+          "every record received or counted as dropped");
+
+    reader.Close();
+    core::SharedRingLogReader::Remove(name);
+}
+
+void TestFullRing()
+{
+    constexpr std::size_t kCapacity = 4096;
+    constexpr int kRecordCount = 200;
+
+    const auto name = GetRingName();
+    core::SharedRingLogReader reader;
+    Process process;
+
+    if (!CreateRing(name, kCapacity, reader) ||
+        !StartWriter(name.c_str(), kCapacity, kRecordCount, process))
+    {
+        Check(false, "start the writer");
+        return;
+    }
+
+    // nothing is read until the writer is done
+    int exit_code = 0;
+    while (!HasExited(process, exit_code))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    Check(exit_code == 0, "writer exit code");
+
+    std::string data;
+    reader.Read(data);
+    Check(data.size() <= kCapacity, "no more than the ring holds");
+
+    // the first records filled the ring, later ones only where they still
+    // fit into what was left
+    int next_index = 0;
+    const int received = CheckRecords(data, next_index);
+    const auto dropped = reader.GetDroppedRecordCount();
+    Check(data.starts_with(MakeRecord(0)), "the oldest records kept");
+    Check(dropped > 0 && received + static_cast<int>(dropped) == kRecordCount,
+          "dropped count of a full ring");
+
+    reader.Close();
+    core::SharedRingLogReader::Remove(name);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+#ifdef _WIN32
+    if (argc == 5 && std::string_view(argv[1]) == "writer")
+    {
+        return WriteRecords(argv[2], std::stoul(argv[3]), std::stoi(argv[4]));
+    }
+#else
+    static_cast<void>(argc);
+    static_cast<void>(argv);
+#endif
+
+    TestConcurrentReader();
+    TestFullRing();
+
+    if (g_failed)
+    {
+        return 1;
+    }
+
+    std::printf("shared_ring_test passed\n");
+    return 0;
+}
@@ -0,0 +1,118 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Compiles a text KeyValues file to the binary layout of
+// core/key_values_binary.h, which MappedKeyValues maps without parsing.
+//
+//     kv_compiler <input> <output>
+//
+// The output is mapped and verified once it is written.
+
+#include <cstdio>
+#include <string>
+
+#include "core/key_values.h"
+#include "core/key_values_binary.h"
+
+namespace
+{
+
+bool ReadFile(const char* path, std::string& data)
+{
+    auto file = std::fopen(path, "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    char buffer[64 * 1024];
+    std::size_t bytes_read;
+
+    while ((bytes_read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        data.append(buffer, bytes_read);
+    }
+
+    std::fclose(file);
+    return true;
+}
+
+bool WriteFile(const char* path, const std::string& data)
+{
+    auto file = std::fopen(path, "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    const bool result =
+        std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    return std::fclose(file) == 0 && result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        std::fprintf(stderr, "usage: kv_compiler <input> <output>\n");
+        return 1;
+    }
+
+    std::string source;
+    if (!ReadFile(argv[1], source))
+    {
+        std::fprintf(stderr, "Unable to read %s\n", argv[1]);
+        return 1;
+    }
+
+    const auto source_size = source.size();
+
+    core::KeyValues key_values;
+    if (!key_values.LoadFromBuffer(std::move(source)))
+    {
+        std::fprintf(stderr, "%s is not a valid KeyValues file\n", argv[1]);
+        return 1;
+    }
+
+    std::string binary;
+    if (!core::BinaryKeyValues::Compile(key_values, binary))
+    {
+        std::fprintf(stderr, "Unable to compile %s\n", argv[1]);
+        return 1;
+    }
+
+    if (!WriteFile(argv[2], binary))
+    {
+        std::fprintf(stderr, "Unable to write %s\n", argv[2]);
+        return 1;
+    }
+
+    core::MappedKeyValues mapped;
+    if (!mapped.Open(argv[2]) || !mapped.Verify())
+    {
+        std::fprintf(stderr, "%s did not verify\n", argv[2]);
+        return 1;
+    }
+
+    std::printf("%s: %zu bytes of text, %zu bytes compiled\n", argv[1],
+                source_size, binary.size());
+    return 0;
+}
@@ -0,0 +1,499 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Measures what logging costs the calling thread.
+//
+//     log_benchmark [options]
+//
+//     --threads <n,n,...>  producer thread counts, default 1,4,16,64
+//     --messages <n>       messages per producer thread, default 100000
+//     --mode <mode>        sync or async, default sync
+//     --format <format>    text or binary, default text
+//     --file <type>        stdio, mapped or vectored, default stdio
+//     --log <path>         log file written by every run, deleted after it
+//     --output <path>      where the JSON results go, default stdout
+//
+// Every scenario runs once per thread count on a freshly initialized log at
+// LogLevel::kInfo:
+//
+//     printf           Log::LogMessage without source and line
+//     printf_source    Log::LogMessage with source and line
+//     format           HOOHAHA_LOG_INFO
+//     filtered_printf  Log::LogMessage at kDebug, rejected by level
+//     filtered_format  HOOHAHA_LOG_DEBUG, rejected by level
+//
+// Latencies are measured per call with the clock ticks of clock.h, except
+// for the filtered scenarios where a call is too cheap for that: their
+// samples are the average of a batch of kFilteredBatch calls. Bytes per
+// second include the time Shutdown takes to drain an async queue.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "core/clock.h"
+#include "core/log.h"
+
+namespace
+{
+
+const int kFilteredBatch = 64;
+
+enum class Scenario
+{
+    kPrintf,
+    kPrintfSource,
+    kFormat,
+    kFilteredPrintf,
+    kFilteredFormat
+};
+
+struct ScenarioInfo
+{
+    Scenario     scenario;
+    const char*  name;
+    bool         filtered;
+};
+
+const ScenarioInfo kScenarios[] =
+{
+    { Scenario::kPrintf,         "printf",          false },
+    { Scenario::kPrintfSource,   "printf_source",   false },
+    { Scenario::kFormat,         "format",          false },
+    { Scenario::kFilteredPrintf, "filtered_printf", true },
+    { Scenario::kFilteredFormat, "filtered_format", true },
+};
+
+struct BenchmarkSettings
+{
+    std::vector<int>   thread_counts = { 1, 4, 16, 64 };
+    int                messages = 100000;
+    core::LogSettings  log;
+    std::string        log_path = "log_benchmark.log";
+};
+
+struct RunResult
+{
+    std::uint64_t  messages;
+    double         elapsed_seconds;
+    double         drain_seconds;
+    std::uint64_t  bytes;
+    std::uint64_t  dropped;
+    // nanoseconds per call
+    double         mean;
+    std::int64_t   p50;
+    std::int64_t   p99;
+    std::int64_t   p999;
+    std::int64_t   max;
+};
+
+// One message of the scenario, i only keeps the arguments from being
+// constant
+inline void LogOnce(Scenario scenario, int i)
+{
+    switch (scenario)
+    {
+    case Scenario::kPrintf:
+        core::log.LogMessage(core::LogLevel::kInfo,
+                             "benchmark message %d of %s, value %f", i,
+                             "log_benchmark", i * 0.5);
+        break;
+    case Scenario::kPrintfSource:
+        core::log.LogMessage(__FILE__, __LINE__, core::LogLevel::kInfo,
+                             "benchmark message %d of %s, value %f", i,
+                             "log_benchmark", i * 0.5);
+        break;
+    case Scenario::kFormat:
+        HOOHAHA_LOG_INFO("benchmark message {} of {}, value {}", i,
+                         "log_benchmark", i * 0.5);
+        break;
+    case Scenario::kFilteredPrintf:
+        core::log.LogMessage(core::LogLevel::kDebug,
+                             "benchmark message %d of %s, value %f", i,
+                             "log_benchmark", i * 0.5);
+        break;
+    case Scenario::kFilteredFormat:
+        HOOHAHA_LOG_DEBUG("benchmark message {} of {}, value {}", i,
+                          "log_benchmark", i * 0.5);
+        break;
+    }
+}
+
+void RunProducer(const ScenarioInfo& info, int messages,
+                 std::atomic<int>& ready, const std::atomic<bool>& start,
+                 std::vector<std::int64_t>& samples)
+{
+    samples.clear();
+    samples.reserve(messages);
+
+    ready.fetch_add(1, std::memory_order_release);
+    while (!start.load(std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+
+    if (info.filtered)
+    {
+        int i = 0;
+        for (; i + kFilteredBatch <= messages; i += kFilteredBatch)
+        {
+            const auto begin = core::ReadClockTicks();
+            for (int j = 0; j < kFilteredBatch; j++)
+            {
+                LogOnce(info.scenario, i + j);
+            }
+            const auto end = core::ReadClockTicksOrdered();
+
+            samples.push_back(static_cast<std::int64_t>(end - begin) /
+                              kFilteredBatch);
+        }
+
+        // the rest of a partial batch is not timed
+        for (; i < messages; i++)
+        {
+            LogOnce(info.scenario, i);
+        }
+        return;
+    }
+
+    for (int i = 0; i < messages; i++)
+    {
+        const auto begin = core::ReadClockTicks();
+        LogOnce(info.scenario, i);
+        const auto end = core::ReadClockTicksOrdered();
+
+        samples.push_back(static_cast<std::int64_t>(end - begin));
+    }
+}
+
+std::uint64_t GetLogSize(const std::string& path)
+{
+    namespace fs = std::filesystem;
+
+    std::error_code error;
+    if (fs::is_regular_file(path, error))
+    {
+        return fs::file_size(path, error);
+    }
+
+    // rolled segments of a mapped log
+    std::uint64_t size = 0;
+    for (int i = 0;; i++)
+    {
+        const auto segment = path + '.' + std::to_string(i);
+        if (!fs::is_regular_file(segment, error))
+        {
+            return size;
+        }
+        size += fs::file_size(segment, error);
+    }
+}
+
+void RemoveLog(const std::string& path)
+{
+    namespace fs = std::filesystem;
+
+    std::error_code error;
+    fs::remove(path, error);
+    for (int i = 0; fs::remove(path + '.' + std::to_string(i), error); i++)
+    {
+    }
+}
+
+RunResult Run(const BenchmarkSettings& settings, const ScenarioInfo& info,
+              int thread_count)
+{
+    using Clock = std::chrono::steady_clock;
+
+    RemoveLog(settings.log_path);
+    core::log.Initialize(settings.log_path, core::LogLevel::kInfo,
+                         settings.log);
+
+    std::vector<std::vector<std::int64_t>> samples(thread_count);
+    std::vector<std::thread> threads;
+    std::atomic<int> ready = 0;
+    std::atomic<bool> start = false;
+
+    for (int i = 0; i < thread_count; i++)
+    {
+        threads.emplace_back(RunProducer, std::cref(info), settings.messages,
+                             std::ref(ready), std::cref(start),
+                             std::ref(samples[i]));
+    }
+
+    while (ready.load(std::memory_order_acquire) < thread_count)
+    {
+        std::this_thread::yield();
+    }
+
+    const auto begin = Clock::now();
+    start.store(true, std::memory_order_release);
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    const auto end = Clock::now();
+    const auto dropped = core::log.GetDroppedRecordCount();
+    core::log.Shutdown();
+    const auto drained = Clock::now();
+
+    RunResult result = {};
+    result.messages = static_cast<std::uint64_t>(settings.messages) *
+                      thread_count;
+    result.elapsed_seconds = std::chrono::duration<double>(end - begin).count();
+    result.drain_seconds = std::chrono::duration<double>(drained - end).count();
+    // includes the header and footer lines, a mapped log only has its real
+    // size once closed
+    result.bytes = GetLogSize(settings.log_path);
+    result.dropped = dropped;
+
+    RemoveLog(settings.log_path);
+
+    std::vector<std::int64_t> all;
+    for (const auto& thread_samples : samples)
+    {
+        all.insert(all.end(), thread_samples.begin(), thread_samples.end());
+    }
+
+    if (all.empty())
+    {
+        return result;
+    }
+
+    double total = 0;
+    for (const auto sample : all)
+    {
+        total += static_cast<double>(sample);
+    }
+    result.mean = total / all.size() *
+                  core::GetClockCalibration().nanoseconds_per_tick;
+
+    const auto percentile = [&all](double fraction)
+    {
+        const auto index = std::min(
+            all.size() - 1, static_cast<std::size_t>(all.size() * fraction));
+        std::nth_element(all.begin(), all.begin() + index, all.end());
+        return core::ClockTicksToNanoseconds(all[index]);
+    };
+
+    result.p50 = percentile(0.5);
+    result.p99 = percentile(0.99);
+    result.p999 = percentile(0.999);
+    result.max = core::ClockTicksToNanoseconds(
+        *std::max_element(all.begin(), all.end()));
+
+    return result;
+}
+
+// Cost of the two clock reads around every measured call
+double MeasureTimerOverhead()
+{
+    const int count = 100000;
+    std::int64_t total = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        const auto begin = core::ReadClockTicks();
+        const auto end = core::ReadClockTicksOrdered();
+        total += static_cast<std::int64_t>(end - begin);
+    }
+
+    return static_cast<double>(core::ClockTicksToNanoseconds(total)) / count;
+}
+
+bool ParseThreadCounts(std::string_view text, std::vector<int>& counts)
+{
+    counts.clear();
+
+    while (!text.empty())
+    {
+        const auto comma = text.find(',');
+        const auto count =
+            std::atoi(std::string(text.substr(0, comma)).c_str());
+        if (count <= 0)
+        {
+            return false;
+        }
+
+        counts.push_back(count);
+        text.remove_prefix(comma == std::string_view::npos ? text.size()
+                                                            : comma + 1);
+    }
+
+    return !counts.empty();
+}
+
+void PrintUsage()
+{
+    std::fprintf(stderr,
+                 "usage: log_benchmark [--threads <n,n,...>] "
+                 "[--messages <n>] [--mode sync|async] "
+                 "[--format text|binary] [--file stdio|mapped|vectored] "
+                 "[--log <path>] [--output <path>]\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    BenchmarkSettings settings;
+    const char* output_path = nullptr;
+    std::string_view mode = "sync";
+    std::string_view format = "text";
+    std::string_view file_type = "stdio";
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string_view option = argv[i];
+        if (i + 1 == argc)
+        {
+            PrintUsage();
+            return 1;
+        }
+
+        const std::string_view value = argv[++i];
+        bool valid = true;
+
+        if (option == "--threads")
+        {
+            valid = ParseThreadCounts(value, settings.thread_counts);
+        }
+        else if (option == "--messages")
+        {
+            settings.messages = std::atoi(value.data());
+            valid = settings.messages > 0;
+        }
+        else if (option == "--mode")
+        {
+            mode = value;
+            valid = mode == "sync" || mode == "async";
+        }
+        else if (option == "--format")
+        {
+            format = value;
+            valid = format == "text" || format == "binary";
+        }
+        else if (option == "--file")
+        {
+            file_type = value;
+            valid = file_type == "stdio" || file_type == "mapped" ||
+                    file_type == "vectored";
+        }
+        else if (option == "--log")
+        {
+            settings.log_path = value;
+        }
+        else if (option == "--output")
+        {
+            output_path = value.data();
+        }
+        else
+        {
+            valid = false;
+        }
+
+        if (!valid)
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    settings.log.mode =
+        mode == "async" ? core::LogMode::kAsync : core::LogMode::kSync;
+    settings.log.format =
+        format == "binary" ? core::LogFormat::kBinary : core::LogFormat::kText;
+    if (file_type == "mapped")
+    {
+        settings.log.file_type = core::LogFileType::kMapped;
+    }
+    else if (file_type == "vectored")
+    {
+        settings.log.file_type = core::LogFileType::kVectored;
+    }
+
+    std::string json = std::format(
+        "{{\n"
+        "  \"settings\": {{\"mode\": \"{}\", \"format\": \"{}\", "
+        "\"file\": \"{}\", \"messages_per_thread\": {}, "
+        "\"filtered_batch\": {}, \"timer_overhead_ns\": {:.1f}, "
+        "\"hardware_threads\": {}}},\n"
+        "  \"results\": [",
+        mode, format, file_type, settings.messages, kFilteredBatch,
+        MeasureTimerOverhead(), std::thread::hardware_concurrency());
+
+    bool first = true;
+    for (const auto& info : kScenarios)
+    {
+        for (const auto thread_count : settings.thread_counts)
+        {
+            std::fprintf(stderr, "%s, %d threads\n", info.name, thread_count);
+
+            const auto result = Run(settings, info, thread_count);
+            const auto total_seconds =
+                result.elapsed_seconds + result.drain_seconds;
+
+            json += std::format(
+                "{}\n    {{\"scenario\": \"{}\", \"threads\": {}, "
+                "\"messages\": {}, \"elapsed_seconds\": {:.6f}, "
+                "\"drain_seconds\": {:.6f}, \"messages_per_second\": {:.0f}, "
+                "\"bytes\": {}, \"bytes_per_second\": {:.0f}, "
+                "\"dropped\": {}, \"latency_ns\": {{\"mean\": {:.1f}, "
+                "\"p50\": {}, \"p99\": {}, \"p99_9\": {}, \"max\": {}}}}}",
+                first ? "" : ",", info.name, thread_count, result.messages,
+                result.elapsed_seconds, result.drain_seconds,
+                result.messages / result.elapsed_seconds, result.bytes,
+                total_seconds > 0 ? result.bytes / total_seconds : 0.0,
+                result.dropped, result.mean, result.p50, result.p99,
+                result.p999, result.max);
+            first = false;
+        }
+    }
+
+    json += "\n  ]\n}\n";
+
+    auto output = stdout;
+    if (output_path != nullptr)
+    {
+        output = std::fopen(output_path, "wb");
+        if (output == nullptr)
+        {
+            std::fprintf(stderr, "Unable to open %s\n", output_path);
+            return 1;
+        }
+    }
+
+    std::fwrite(json.data(), 1, json.size(), output);
+
+    if (output != stdout)
+    {
+        std::fclose(output);
+    }
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Drains the shared memory ring of a log written with
+// LogFileType::kSharedRing into a file.
+//
+//     log_collector [--compress] [--exit-when-detached] <ring> <output>
+//
+// --compress writes compressed frames, see log_cat. With
+// --exit-when-detached the collector stops once it has seen a writer or
+// records, the ring is empty and no writer is attached any more, e.g. to
+// drain what a crashed process left behind. Otherwise it runs until
+// interrupted and waits for the writer to come back. What is left in the
+// ring is always drained before exiting.
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "core/log_compression.h"
+#include "core/log_shared_ring.h"
+#include "core/log_writer.h"
+
+namespace
+{
+
+const auto kIdleSleep = std::chrono::milliseconds(1);
+const auto kReopenInterval = std::chrono::seconds(1);
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void OnSignal(int)
+{
+    g_stop = 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    bool compress = false;
+    bool exit_when_detached = false;
+    const char* ring = nullptr;
+    const char* output_path = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--compress") == 0)
+        {
+            compress = true;
+        }
+        else if (std::strcmp(argv[i], "--exit-when-detached") == 0)
+        {
+            exit_when_detached = true;
+        }
+        else if (ring == nullptr)
+        {
+            ring = argv[i];
+        }
+        else if (output_path == nullptr)
+        {
+            output_path = argv[i];
+        }
+        else
+        {
+            ring = nullptr;
+            break;
+        }
+    }
+
+    if (ring == nullptr || output_path == nullptr)
+    {
+        std::fprintf(stderr, "usage: log_collector [--compress] "
+                             "[--exit-when-detached] <ring> <output>\n");
+        return 1;
+    }
+
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+
+    std::unique_ptr<core::LogWriter> writer =
+        std::make_unique<core::StdioLogWriter>();
+    if (compress)
+    {
+        core::LogCompressionSettings settings;
+        settings.enabled = true;
+        writer = std::make_unique<core::CompressedLogWriter>(settings,
+                                                             std::move(writer));
+    }
+
+    if (!writer->Open(output_path))
+    {
+        std::fprintf(stderr, "Unable to open %s\n", output_path);
+        return 1;
+    }
+
+    core::SharedRingLogReader reader;
+    while (!g_stop && !reader.Open(ring))
+    {
+        std::this_thread::sleep_for(kReopenInterval);
+    }
+
+    std::string buffer;
+    std::uint64_t dropped = reader.GetDroppedRecordCount();
+    bool writer_seen = false;
+    auto last_reopen = std::chrono::steady_clock::now();
+
+    while (!g_stop)
+    {
+        buffer.clear();
+        if (reader.Read(buffer) > 0)
+        {
+            writer_seen = true;
+            writer->Write(buffer);
+            writer->EndBatch();
+            continue;
+        }
+
+        const auto ring_dropped = reader.GetDroppedRecordCount();
+        if (ring_dropped != dropped)
+        {
+            std::fprintf(stderr, "%llu records lost in the ring\n",
+                         static_cast<unsigned long long>(ring_dropped -
+                                                         dropped));
+            dropped = ring_dropped;
+        }
+
+        if (reader.IsWriterAttached())
+        {
+            writer_seen = true;
+        }
+        else
+        {
+            if (exit_when_detached && writer_seen)
+            {
+                break;
+            }
+
+            // a restarted writer may have replaced the ring with a new one
+            const auto now = std::chrono::steady_clock::now();
+            if (now - last_reopen >= kReopenInterval)
+            {
+                last_reopen = now;
+                if (reader.Open(ring))
+                {
+                    dropped = reader.GetDroppedRecordCount();
+                }
+            }
+        }
+
+        writer->EndBatch();
+        std::this_thread::sleep_for(kIdleSleep);
+    }
+
+    buffer.clear();
+    reader.Read(buffer);
+    writer->Write(buffer);
+    writer->Close();
+
+    return 0;
+}
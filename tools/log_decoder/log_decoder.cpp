@@ -0,0 +1,113 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Converts a binary log written with LogFormat::kBinary to the text layout.
+//
+//     log_decoder <input> [output]
+//
+// The text goes to stdout when no output file is given. Compressed binary
+// logs (LogSettings::compression) are decompressed first.
+
+#include <cstdio>
+#include <string>
+
+#include "core/log_binary.h"
+#include "core/log_compression.h"
+
+namespace
+{
+
+bool ReadFile(const char* path, std::string& data)
+{
+    auto file = std::fopen(path, "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    char buffer[64 * 1024];
+    std::size_t bytes_read;
+
+    while ((bytes_read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        data.append(buffer, bytes_read);
+    }
+
+    std::fclose(file);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::fprintf(stderr, "usage: log_decoder <input> [output]\n");
+        return 1;
+    }
+
+    std::string data;
+    if (!ReadFile(argv[1], data))
+    {
+        std::fprintf(stderr, "Unable to read %s\n", argv[1]);
+        return 1;
+    }
+
+    if (core::IsCompressedLog(data))
+    {
+        std::string decompressed;
+        core::DecodeLogFrames(data,
+            [&decompressed](std::string_view block)
+            {
+                decompressed += block;
+            });
+        data = std::move(decompressed);
+    }
+
+    auto output = stdout;
+    if (argc == 3)
+    {
+        output = std::fopen(argv[2], "wb");
+        if (output == nullptr)
+        {
+            std::fprintf(stderr, "Unable to open %s\n", argv[2]);
+            return 1;
+        }
+    }
+
+    core::LogBinaryDecoder decoder;
+    const bool result = decoder.Decode(data,
+        [output](std::string_view line)
+        {
+            std::fwrite(line.data(), 1, line.size(), output);
+        });
+
+    if (output != stdout)
+    {
+        std::fclose(output);
+    }
+
+    if (!result)
+    {
+        std::fprintf(stderr, "%s is not a valid binary log\n", argv[1]);
+        return 1;
+    }
+
+    return 0;
+}
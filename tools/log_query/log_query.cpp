@@ -0,0 +1,167 @@
+/*
+    Hoohaha Game Engine
+    Copyright (C) 2025 codingdude@gmail.com
+
+    This program is free software : you can redistribute it and /or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Prints the records of a text log that match a query, using the block
+// index of LogReader.
+//
+//     log_query [options] <log>
+//
+//     --from <time>    records at or after time, e.g. 2026-10-17T01:06:38
+//     --to <time>      records before time
+//     --level <level>  records at level and the more severe ones
+//     --thread <id>    records of one thread, by number or name
+//     --text <text>    records that contain text
+//     --threads <n>    threads for indexing and scanning
+//     --count          only print the number of matches
+//     --reindex        ignore the cached index and build it again
+//
+// Times without an offset are local times. When <log> does not exist its
+// rolled segments <log>.0, <log>.1 and so on are queried.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "core/log_reader.h"
+#include "core/timestamp.h"
+
+namespace
+{
+
+void PrintUsage()
+{
+    std::fprintf(stderr,
+                 "usage: log_query [--from <time>] [--to <time>] "
+                 "[--level <level>] [--thread <id|name>] [--text <text>] "
+                 "[--threads <n>] [--count] [--reindex] <log>\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    core::LogQuery query;
+    core::LogReaderSettings settings;
+    const char* thread = nullptr;
+    const char* path = nullptr;
+    bool count_only = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string_view option = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (option == "--from" && has_value)
+        {
+            if (!core::ParseTimestamp(argv[++i], query.begin_time))
+            {
+                std::fprintf(stderr, "Invalid time %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (option == "--to" && has_value)
+        {
+            if (!core::ParseTimestamp(argv[++i], query.end_time))
+            {
+                std::fprintf(stderr, "Invalid time %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (option == "--level" && has_value)
+        {
+            if (!core::LogLevelFromString(argv[++i], query.level))
+            {
+                std::fprintf(stderr, "Invalid level %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (option == "--thread" && has_value)
+        {
+            thread = argv[++i];
+        }
+        else if (option == "--text" && has_value)
+        {
+            query.text = argv[++i];
+        }
+        else if (option == "--threads" && has_value)
+        {
+            settings.threads =
+                static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (option == "--count")
+        {
+            count_only = true;
+        }
+        else if (option == "--reindex")
+        {
+            settings.rebuild_index = true;
+        }
+        else if (path == nullptr && !option.starts_with("--"))
+        {
+            path = argv[i];
+        }
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (path == nullptr)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    core::LogReader reader(settings);
+    if (!reader.Open(path))
+    {
+        std::fprintf(stderr, "Unable to open %s\n", path);
+        return 1;
+    }
+
+    if (thread != nullptr)
+    {
+        char* end = nullptr;
+        query.thread = std::strtoull(thread, &end, 10);
+
+        if (*end != '\0' && !reader.FindThread(thread, query.thread))
+        {
+            std::fprintf(stderr, "No thread named %s in %s\n", thread, path);
+            return 1;
+        }
+    }
+
+    const auto count = reader.Query(query,
+        [count_only](const core::LogRecordView& record)
+        {
+            if (!count_only)
+            {
+                std::fwrite(record.text.data(), 1, record.text.size(), stdout);
+                std::fputc('\n', stdout);
+            }
+        });
+
+    if (count_only)
+    {
+        std::printf("%zu\n", count);
+    }
+
+    return 0;
+}